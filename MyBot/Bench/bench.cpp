@@ -0,0 +1,90 @@
+#include "bench.h"
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define TRBDR_BENCH_RDTSC
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#else
+		#include <x86intrin.h>
+	#endif
+#endif
+
+//---BENCHMARKS---//
+
+namespace trbdrBench {
+	struct benchmark {
+		const char* name;
+		const char* description;
+		benchFunction run;
+	};
+
+	// Function-local, so it exists before any bench file's static initializer registers into it
+	static std::vector<benchmark>& benchmarks() {
+		static std::vector<benchmark> list;
+		return list;
+	}
+
+	bool registerBenchmark(const char* name, const char* description, benchFunction run) {
+		benchmarks().push_back({ name, description, run });
+		return true;
+	}
+
+	uint64_t cycleCount() {
+#ifdef TRBDR_BENCH_RDTSC
+		return __rdtsc();
+#else
+		return 0;
+#endif
+	}
+
+	bool hasCycleCount() {
+#ifdef TRBDR_BENCH_RDTSC
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	static volatile uint64_t kept = 0;
+
+	void keep(const void* data, size_t bytes) {
+		const uint8_t* in = (const uint8_t*)data;
+		uint64_t sum = kept;
+		for (size_t i = 0; i < bytes; i++) { sum = (sum * 31) + in[i]; }
+		kept = sum;
+	}
+}
+
+// Runs every benchmark, or just the ones named on the command line. "--list" shows what there is.
+// Build Release for numbers worth comparing.
+int main(int argc, char* argv[]) {
+	using namespace trbdrBench;
+
+	std::vector<std::string> wanted(argv + 1, argv + argc);
+	if (wanted.size() == 1 && wanted[0] == "--list") {
+		for (const benchmark& bench : benchmarks()) { std::cout << bench.name << " - " << bench.description << "\n"; }
+		return 0;
+	}
+
+	int ran = 0;
+	for (const benchmark& bench : benchmarks()) {
+		bool selected = wanted.empty();
+		for (const std::string& name : wanted) { selected = selected || (name == bench.name); }
+		if (!selected) { continue; }
+
+		std::cout << "### " << bench.name << ": " << bench.description << "\n";
+		bench.run();
+		std::cout << std::endl;
+		ran++;
+	}
+	if (ran == 0) {
+		std::cout << "No benchmark by that name. Run with --list to see them." << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+//---BENCHMARKS---//
+
+namespace trbdrBench {
+	// A benchmark prints its own results, since each one measures something different.
+	using benchFunction = void (*)();
+
+	// Adds a benchmark to the list main() runs. Returns true, so a bench file can register itself
+	// from a static initializer: static const bool registered = registerBenchmark(...);
+	bool registerBenchmark(const char* name, const char* description, benchFunction run);
+
+	// CPU timestamp counter on x86/x64, for cycle counts. Always 0 elsewhere, where only times are reported.
+	uint64_t cycleCount();
+	bool hasCycleCount();
+
+	// Folds "bytes" of a result into a value the optimiser has to keep, so it can't throw away the work that made it.
+	void keep(const void* data, size_t bytes);
+
+	// Cost of one call to "body", the best of "repeats" runs of "iterations" calls each.
+	struct timing {
+		double ns = 0.0;
+		double cycles = 0.0;									// 0 without a cycle counter
+	};
+	template <typename F>
+	timing timePerCall(F&& body, size_t iterations, int repeats = 5) {
+		timing best;
+		for (int r = 0; r < repeats; r++) {
+			auto started = std::chrono::steady_clock::now();
+			uint64_t startCycles = cycleCount();
+			for (size_t i = 0; i < iterations; i++) { body(); }
+			uint64_t cycles = cycleCount() - startCycles;
+			double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+			if (r == 0 || ns / iterations < best.ns) {
+				best.ns = ns / iterations;
+				best.cycles = (double)cycles / iterations;
+			}
+		}
+		return best;
+	}
+}
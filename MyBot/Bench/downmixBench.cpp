@@ -0,0 +1,84 @@
+#include "bench.h"
+#include "pcmKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+//---DOWNMIX BENCHMARK---//
+
+// Downmixing one mixer block of quad, 5.1 and 7.1 to stereo PCM: the dispatched kernels against a plain matrix loop
+// with the same ITU-R BS.775 gains, which is what a straightforward version of the stage would cost. The loop also
+// doubles as the reference the kernels' output is checked against.
+namespace trbdrBench {
+	using namespace trbdrAudio;
+
+	static constexpr size_t blockFrames = 1024;
+	static constexpr size_t blocksPerRun = 20000;
+	static constexpr float centreGain = 0.70710678f;
+
+	// Left and right gains per channel, in FMOD's speaker order, as the kernels apply them
+	struct layout {
+		const char* name;
+		int channels;
+		float left[8];
+		float right[8];
+	};
+	static const layout layouts[] = {
+		{ "Quad", 4, { 1.0f, 0.0f, centreGain, 0.0f }, { 0.0f, 1.0f, 0.0f, centreGain } },
+		{ "5.1", 6, { 1.0f, 0.0f, centreGain, 0.0f, centreGain, 0.0f }, { 0.0f, 1.0f, centreGain, 0.0f, 0.0f, centreGain } },
+		{ "7.1", 8, { 1.0f, 0.0f, centreGain, 0.0f, centreGain, 0.0f, centreGain, 0.0f }, { 0.0f, 1.0f, centreGain, 0.0f, 0.0f, centreGain, 0.0f, centreGain } },
+	};
+
+	static int16_t referenceToPCM(float sample) {
+		sample = std::clamp(sample, -1.0f, 1.0f);
+		return (int16_t)lrintf(sample * 32767.0f);
+	}
+
+	static void referenceDownmix(const layout& matrix, const float* in, int16_t* out) {
+		for (size_t i = 0; i < blockFrames; i++) {
+			const float* frame = in + (i * matrix.channels);
+			float left = 0.0f;
+			float right = 0.0f;
+			for (int ch = 0; ch < matrix.channels; ch++) {
+				left += frame[ch] * matrix.left[ch];
+				right += frame[ch] * matrix.right[ch];
+			}
+			out[(i * 2)] = referenceToPCM(left);
+			out[(i * 2) + 1] = referenceToPCM(right);
+		}
+	}
+
+	static void runDownmix() {
+		initKernels();
+		std::cout << "Kernel set: " << kernelSetName() << "\n";
+
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> sample(-0.6f, 0.6f);		// Enough that the busier sides sometimes clip
+		std::vector<int16_t> referenceOut(blockFrames * 2);
+		std::vector<int16_t> kernelOut(blockFrames * 2);
+		for (const layout& matrix : layouts) {
+			std::vector<float> in(blockFrames * matrix.channels);
+			for (float& s : in) { s = sample(random); }
+
+			timing referenceTime = timePerCall([&] { referenceDownmix(matrix, in.data(), referenceOut.data()); }, blocksPerRun);
+			timing kernelTime = timePerCall([&] { downmixToPCMStereo(in.data(), matrix.channels, kernelOut.data(), blockFrames); }, blocksPerRun);
+			keep(referenceOut.data(), referenceOut.size() * sizeof(int16_t));
+			keep(kernelOut.data(), kernelOut.size() * sizeof(int16_t));
+
+			// Summing in a different order can tip a sample over a rounding edge, so 1 LSB is expected
+			int worst = 0;
+			for (size_t i = 0; i < kernelOut.size(); i++) { worst = std::max(worst, std::abs(referenceOut[i] - kernelOut[i])); }
+
+			std::cout << matrix.name << " to stereo PCM, per " << blockFrames << "-frame block:\n";
+			std::cout << "   Matrix loop: " << referenceTime.ns << " ns, " << referenceTime.cycles << " cycles\n";
+			std::cout << "   " << kernelSetName() << " kernel: " << kernelTime.ns << " ns, " << kernelTime.cycles << " cycles\n";
+			std::cout << "   Largest difference: " << worst << " LSB\n";
+		}
+	}
+
+	static const bool registered = registerBenchmark("downmix", "Quad, 5.1 and 7.1 to stereo, SIMD kernels vs a plain matrix loop", runDownmix);
+}
@@ -0,0 +1,75 @@
+#include "bench.h"
+#include "frameBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+//---FRAME BUFFER BENCHMARK---//
+
+// Moving mixer blocks through the capture buffer: the lock-free frame ring against the std::vector the capture
+// callback used to push_back into while the send loop erased from the front. Single threaded, since the old
+// path was a data race with two, so this is the cost of the buffering alone.
+namespace trbdrBench {
+	using namespace trbdrAudio;
+
+	static constexpr size_t blockFrames = 1024;							// A typical FMOD mixer block
+	static constexpr size_t blockSamples = blockFrames * frameChannels;
+	static constexpr size_t legacySendSamples = 5760;					// send_audio_raw_max_length / 2, what the send loop took each pass
+	static constexpr size_t blocksPerRun = 20000;
+
+	// One pass of the old path: push_back every sample, then send and erase from the front while there's enough
+	static void legacyBlock(std::vector<int16_t>& buffer, const int16_t* block, int16_t* sent, size_t backlogSamples) {
+		for (size_t i = 0; i < blockSamples; i++) { buffer.push_back(block[i]); }
+		while (buffer.size() > backlogSamples + legacySendSamples) {
+			memcpy(sent, buffer.data(), legacySendSamples * sizeof(int16_t));
+			buffer.erase(buffer.begin(), buffer.begin() + legacySendSamples);
+		}
+	}
+
+	// The same with the ring: write the block in as many pieces as the frames need, then pop whole frames
+	static void ringBlock(pcmFrameBuffer& buffer, const int16_t* block, pcmFrame& sent, size_t backlogFrames) {
+		size_t written = 0;
+		while (written < blockSamples) {
+			size_t samplesFree = 0;
+			int16_t* out = buffer.writePtr(samplesFree);
+			size_t count = std::min(samplesFree, blockSamples - written);
+			memcpy(out, block + written, count * sizeof(int16_t));
+			buffer.commitWrite(count);
+			written += count;
+		}
+		while (buffer.framesAvailable() > backlogFrames) { buffer.pop(sent); }
+	}
+
+	static void runFrameBuffer() {
+		std::vector<int16_t> block(blockSamples);
+		for (size_t i = 0; i < blockSamples; i++) { block[i] = (int16_t)((i * 37) % 65536 - 32768); }
+		std::vector<int16_t> legacySent(legacySendSamples);
+		pcmFrame ringSent;
+		double framesPerBlock = (double)blockFrames / frameSamplesPerChannel;
+
+		// Steady state, then with a second of audio waiting, which is what the old erase had to shuffle down every send
+		for (size_t backlogFrames : { (size_t)0, (size_t)50 }) {
+			std::vector<int16_t> legacy(backlogFrames * frameSampleCount);
+			pcmFrameBuffer ring(64);
+			for (size_t i = 0; i < backlogFrames; i++) {
+				size_t samplesFree = 0;
+				ring.writePtr(samplesFree);
+				ring.commitWrite(samplesFree);
+			}
+
+			timing legacyTime = timePerCall([&] { legacyBlock(legacy, block.data(), legacySent.data(), backlogFrames * frameSampleCount); }, blocksPerRun);
+			timing ringTime = timePerCall([&] { ringBlock(ring, block.data(), ringSent, backlogFrames); }, blocksPerRun);
+			keep(legacySent.data(), legacySent.size() * sizeof(int16_t));
+			keep(ringSent.samples, sizeof(ringSent.samples));
+
+			std::cout << "Backlog of " << backlogFrames << " frames, per " << blockFrames << "-frame block:\n";
+			std::cout << "   std::vector push_back/erase: " << legacyTime.ns << " ns (" << legacyTime.ns / framesPerBlock << " ns per 20ms frame)\n";
+			std::cout << "   pcmFrameBuffer:              " << ringTime.ns << " ns (" << ringTime.ns / framesPerBlock << " ns per 20ms frame)\n";
+			std::cout << "   Ring overruns: " << ring.overruns() << ", underruns: " << ring.underruns() << "\n";
+		}
+	}
+
+	static const bool registered = registerBenchmark("frameBuffer", "Capture buffer, lock-free frame ring vs the old PCM vector", runFrameBuffer);
+}
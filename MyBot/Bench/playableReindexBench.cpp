@@ -0,0 +1,98 @@
+#include "bench.h"
+#include "catalogDiff.h"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+//---PLAYABLE REINDEX BENCHMARK---//
+
+// Re-indexing /playable against a Master Strings bank of 50k strings, after a Live Update added 1000 events and
+// removed 500. The old way searched the indexed paths once per string and erased each match from a copy, so whatever
+// was left over had gone; that's run here with its loop bug fixed, since the original never finished. The new way
+// is diffCatalog over two GUID-keyed maps, as playable() calls it.
+namespace trbdrBench {
+	using namespace trbdrAudio;
+
+	static constexpr size_t stringCount = 50000;
+	static constexpr size_t addedCount = 1000;
+	static constexpr size_t removedCount = 500;
+	static const std::string masterPrefix = "event:/Master/";
+
+	static std::string benchNiceName(std::string path) {
+		return path.substr(masterPrefix.size());
+	}
+
+	static FMOD_GUID randomGUID(std::mt19937& random) {
+		FMOD_GUID id;
+		id.Data1 = random();
+		id.Data2 = (unsigned short)random();
+		id.Data3 = (unsigned short)random();
+		for (unsigned char& byte : id.Data4) { byte = (unsigned char)random(); }
+		return id;
+	}
+
+	static std::string eventPath(size_t n) {
+		return masterPrefix + "Folder" + std::to_string(n % 100) + "/Event" + std::to_string(n);
+	}
+
+	// The old loop, with "i" and "j" the right way round. Returns how many were added and removed.
+	static std::pair<size_t, size_t> legacyReindex(const std::vector<std::string>& eventPaths, const std::vector<std::string>& liveStrings) {
+		std::vector<std::string> existingEvents = eventPaths;
+		size_t added = 0;
+		for (const std::string& pathString : liveStrings) {
+			bool alreadyExistsEvent = false;
+			for (size_t j = 0; j < eventPaths.size(); j++) {
+				if (eventPaths[j] == pathString) { alreadyExistsEvent = true; break; }
+			}
+			if (alreadyExistsEvent) {
+				for (size_t k = 0; k < existingEvents.size(); k++) {
+					if (pathString == existingEvents[k]) { existingEvents.erase(existingEvents.begin() + k); }
+				}
+				continue;
+			}
+			added++;
+		}
+		return { added, existingEvents.size() };
+	}
+
+	static void runPlayableReindex() {
+		std::mt19937 random(1234);
+
+		// What's indexed: the first stringCount events
+		guidNames indexed;
+		std::vector<std::string> eventPaths;
+		std::vector<FMOD_GUID> ids;
+		for (size_t n = 0; n < stringCount; n++) {
+			ids.push_back(randomGUID(random));
+			eventPaths.push_back(eventPath(n));
+			indexed.insert({ ids.back(), benchNiceName(eventPaths.back()) });
+		}
+
+		// What the strings bank has now: removedCount of those gone, addedCount new ones, in the order FMOD hands them out
+		guidNames live;
+		std::vector<std::string> liveStrings;
+		for (size_t n = removedCount; n < stringCount + addedCount; n++) {
+			FMOD_GUID id = n < stringCount ? ids[n] : randomGUID(random);
+			live.insert({ id, eventPath(n) });
+			liveStrings.push_back(eventPath(n));
+		}
+		std::shuffle(liveStrings.begin(), liveStrings.end(), random);
+
+		std::cout << "Re-index of " << liveStrings.size() << " strings, " << addedCount << " added and " << removedCount << " removed:\n";
+
+		// Quadratic, so once is plenty
+		std::pair<size_t, size_t> legacyCounts;
+		timing legacyTime = timePerCall([&] { legacyCounts = legacyReindex(eventPaths, liveStrings); }, 1, 1);
+		std::cout << "   Per-string search and erase: " << legacyTime.ns / 1e6 << " ms (" << legacyCounts.first << " added, "
+			<< legacyCounts.second << " removed)\n";
+
+		catalogDiff diff;
+		timing diffTime = timePerCall([&] { diff = diffCatalog(indexed, live, benchNiceName); }, 1, 5);
+		std::cout << "   GUID diff: " << diffTime.ns / 1e6 << " ms (" << diff.added.size() << " added, " << diff.removed.size() << " removed)\n";
+	}
+
+	static const bool registered = registerBenchmark("playableReindex", "/playable reindex of 50k strings, GUID diff vs the old per-string search", runPlayableReindex);
+}
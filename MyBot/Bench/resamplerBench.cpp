@@ -0,0 +1,88 @@
+#include "bench.h"
+#include "pcmKernels.h"
+#include "resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+//---RESAMPLER BENCHMARK---//
+
+// Ten seconds of a 1 kHz sine through the capture resampler, from the mixer rates we've seen hosts fall back to.
+// Reports what the resampler says it cost, as /metrics and leave() would show it, and how clean the output is:
+// the sine is fitted back out of the 48 kHz result, and whatever's left over counts as noise.
+namespace trbdrBench {
+	using namespace trbdrAudio;
+
+	static constexpr double pi = 3.14159265358979323846;
+	static constexpr double toneHz = 1000.0;
+	static constexpr double toneAmplitude = 16384.0;				// About -6 dBFS
+	static constexpr int seconds = 10;
+	static constexpr size_t settleFrames = 64;						// Output skipped while the filter fills up
+
+	// Signal to noise ratio of "out" against the best-fitting 1 kHz sine, in dB
+	static double toneSNR(const std::vector<float>& out) {
+		// Least squares for a*sin + b*cos, then compare the fit's power with what it missed
+		double ss = 0.0, cc = 0.0, sc = 0.0, ys = 0.0, yc = 0.0;
+		for (size_t n = 0; n < out.size(); n++) {
+			double angle = 2.0 * pi * toneHz * (double)n / frameSampleRate;
+			double s = std::sin(angle), c = std::cos(angle);
+			ss += s * s; cc += c * c; sc += s * c;
+			ys += out[n] * s; yc += out[n] * c;
+		}
+		double det = (ss * cc) - (sc * sc);
+		double a = ((ys * cc) - (yc * sc)) / det;
+		double b = ((yc * ss) - (ys * sc)) / det;
+
+		double signal = 0.0, noise = 0.0;
+		for (size_t n = 0; n < out.size(); n++) {
+			double angle = 2.0 * pi * toneHz * (double)n / frameSampleRate;
+			double fit = (a * std::sin(angle)) + (b * std::cos(angle));
+			signal += fit * fit;
+			noise += (out[n] - fit) * (out[n] - fit);
+		}
+		return 10.0 * std::log10(signal / std::max(noise, 1e-12));
+	}
+
+	static void runResampler() {
+		initKernels();
+		std::cout << "Kernel set: " << kernelSetName() << "\n";
+
+		// 48 kHz still runs through it, so the drift correction has a ratio to steer
+		for (int inputRate : { 44100, 32000, 48000 }) {
+			polyphaseResampler resampler;
+			resampler.configure(inputRate, (int)frameSampleRate, true);
+			pcmFrameBuffer sink(8);
+
+			std::vector<int16_t> block(resamplerBlockFrames * frameChannels);
+			std::vector<float> left;
+			left.reserve((size_t)seconds * frameSampleRate);
+			pcmFrame frame;
+			size_t totalFrames = (size_t)seconds * (size_t)inputRate;
+			for (size_t done = 0; done < totalFrames; done += resamplerBlockFrames) {
+				size_t count = std::min(resamplerBlockFrames, totalFrames - done);
+				for (size_t i = 0; i < count; i++) {
+					int16_t sample = (int16_t)std::lrint(toneAmplitude * std::sin(2.0 * pi * toneHz * (double)(done + i) / inputRate));
+					block[(i * 2)] = sample;
+					block[(i * 2) + 1] = sample;
+				}
+				resampler.process(block.data(), count, sink);
+				while (sink.framesAvailable() > 0) {
+					sink.pop(frame);
+					for (size_t i = 0; i < frameSamplesPerChannel; i++) { left.push_back(frame.samples[i * 2]); }
+				}
+			}
+			std::vector<float> settled(left.begin() + std::min(settleFrames, left.size()), left.end());
+
+			resamplerStats stats = resampler.stats();
+			std::cout << inputRate << " Hz -> " << frameSampleRate << " Hz, " << seconds << " s of audio in " << stats.blocks << " blocks:\n";
+			std::cout << "   " << stats.averageBlockNs << " ns average / " << stats.maxBlockNs << " ns max per block, "
+				<< stats.cpuPercent << "% of one core\n";
+			std::cout << "   Filter latency: " << stats.latencyMs << " ms\n";
+			std::cout << "   1 kHz tone SNR: " << toneSNR(settled) << " dB\n";
+		}
+	}
+
+	static const bool registered = registerBenchmark("resampler", "Capture resampler CPU, latency and SNR from 44.1, 32 and 48 kHz", runResampler);
+}
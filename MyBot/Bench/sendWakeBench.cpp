@@ -0,0 +1,82 @@
+#include "bench.h"
+#include "frameBuffer.h"
+#include "latencyHistogram.h"
+
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+//---SEND WAKE BENCHMARK---//
+
+// How long a finished frame waits before the sending side picks it up. A producer thread publishes a frame every 20ms,
+// like the mixer, and the consumer either polls with a fixed 20ms sleep, as main()'s loop used to, or sleeps on the
+// frame buffer's signal, as the encoder thread does now. Runs in real time, so it takes a few seconds.
+namespace trbdrBench {
+	using namespace trbdrAudio;
+
+	static constexpr size_t framesPerRun = 150;
+	static constexpr std::chrono::milliseconds framePeriod{ frameLengthMs };
+
+	static int64_t nowNs() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// Publishes framesPerRun frames on a 20ms cadence
+	static void produceFrames(pcmFrameBuffer& buffer) {
+		auto deadline = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < framesPerRun; i++) {
+			deadline += framePeriod;
+			std::this_thread::sleep_until(deadline);
+			size_t samplesFree = 0;
+			int16_t* out = buffer.writePtr(samplesFree);
+			memset(out, 0, samplesFree * sizeof(int16_t));
+			buffer.commitWrite(samplesFree);
+		}
+	}
+
+	static void printWaits(const char* name, const latencyHistogram& waits) {
+		std::cout << "   " << name << ": p50 " << waits.percentile(50.0) << " us, p95 " << waits.percentile(95.0)
+			<< " us, p99 " << waits.percentile(99.0) << " us, max " << waits.max() << " us over " << waits.count() << " frames\n";
+	}
+
+	static void runSendWake() {
+		pcmFrame frame;
+		std::cout << "Publish to pickup wait, " << framesPerRun << " frames at " << frameLengthMs << "ms:\n";
+
+		// The old loop: check, send whatever's there, then sleep a fixed 20ms regardless
+		{
+			pcmFrameBuffer buffer(16);
+			latencyHistogram waits;
+			std::thread producer(produceFrames, std::ref(buffer));
+			while (waits.count() < framesPerRun) {
+				while (buffer.framesAvailable() > 0) {
+					buffer.pop(frame);
+					waits.record((uint64_t)(nowNs() - frame.publishedNs) / 1000);
+				}
+				std::this_thread::sleep_for(framePeriod);
+			}
+			producer.join();
+			printWaits("Polling with a 20ms sleep", waits);
+		}
+
+		// The encoder thread: sleep until the buffer says a frame's been published
+		{
+			pcmFrameBuffer buffer(16);
+			latencyHistogram waits;
+			std::thread producer(produceFrames, std::ref(buffer));
+			while (waits.count() < framesPerRun) {
+				buffer.waitForFrame();
+				while (buffer.framesAvailable() > 0) {
+					buffer.pop(frame);
+					waits.record((uint64_t)(nowNs() - frame.publishedNs) / 1000);
+				}
+			}
+			producer.join();
+			printWaits("Woken on publish        ", waits);
+		}
+	}
+
+	static const bool registered = registerBenchmark("sendWake", "Frame pickup latency, waking on publish vs the old 20ms polling loop", runSendWake);
+}
@@ -0,0 +1,95 @@
+#include "bitrateAdapter.h"
+
+#include <algorithm>
+
+//---BITRATE ADAPTER---//
+
+namespace trbdrAudio {
+	// Fraction of the profile's bitrate at each backoff level.
+	static constexpr double levelScale[] = { 1.0, 0.75, 0.5, 0.35 };
+	static constexpr int maxLevel = (int)(sizeof(levelScale) / sizeof(levelScale[0])) - 1;
+
+	// Never go below this, whatever the profile. Music falls apart quickly under it.
+	static constexpr int minBitrate = 24000;
+
+	// Loss libopus plans for while backed off, so the FEC actually carries something.
+	static constexpr int backedOffLossPercent = 10;
+
+	// How long the queue has to stay past a threshold before we act, and how long between changes.
+	static constexpr int64_t backoffHoldNs = 500000000;		// Half a second
+	static constexpr int64_t recoverHoldNs = 5000000000;		// Five seconds
+
+	bitrateAdapter::bitrateAdapter(double backoffMs, double recoverMs) : backoffMs(backoffMs), recoverMs(recoverMs) {}
+
+	// Starts over at full rate from a profile's settings.
+	void bitrateAdapter::reset(int bitrate, bool fec, int lossPercent) {
+		baseBitrate = bitrate;
+		baseFec = fec;
+		baseLossPercent = lossPercent;
+		level = 0;
+		backedUpSinceNs = 0;
+		drainedSinceNs = 0;
+		lastChangeNs = 0;
+
+		baseBitrateOut.store(bitrate, std::memory_order_relaxed);
+		bitrateOut.store(bitrate, std::memory_order_relaxed);
+		fecOut.store(fec, std::memory_order_relaxed);
+	}
+
+	bitrateDecision bitrateAdapter::decisionFor(int atLevel) const {
+		bitrateDecision out;
+		if (atLevel == 0) {
+			out.bitrate = baseBitrate;
+			out.fec = baseFec;
+			out.packetLossPercent = baseLossPercent;
+		}
+		else {
+			out.bitrate = std::max(minBitrate, (int)(baseBitrate * levelScale[atLevel]));
+			out.fec = true;
+			out.packetLossPercent = std::max(baseLossPercent, backedOffLossPercent);
+		}
+		return out;
+	}
+
+	// Feeds in the queue depth after a packet was sent. Returns true when the settings should change.
+	bool bitrateAdapter::update(double queuedMs, int64_t nowNs, bitrateDecision& decision) {
+		if (backoffMs <= 0.0 || baseBitrate <= 0) { return false; }
+
+		backedUpSinceNs = (queuedMs > backoffMs) ? (backedUpSinceNs != 0 ? backedUpSinceNs : nowNs) : 0;
+		drainedSinceNs = (queuedMs < recoverMs) ? (drainedSinceNs != 0 ? drainedSinceNs : nowNs) : 0;
+
+		int newLevel = level;
+		if (backedUpSinceNs != 0 && level < maxLevel && nowNs - backedUpSinceNs >= backoffHoldNs
+			&& nowNs - lastChangeNs >= backoffHoldNs) {
+			newLevel = level + 1;
+			stepDowns.fetch_add(1, std::memory_order_relaxed);
+		}
+		else if (drainedSinceNs != 0 && level > 0 && nowNs - drainedSinceNs >= recoverHoldNs
+			&& nowNs - lastChangeNs >= recoverHoldNs) {
+			newLevel = level - 1;
+			stepUps.fetch_add(1, std::memory_order_relaxed);
+		}
+		if (newLevel == level) { return false; }
+
+		// Each step has to earn its own hold time
+		level = newLevel;
+		lastChangeNs = nowNs;
+		backedUpSinceNs = 0;
+		drainedSinceNs = 0;
+
+		decision = decisionFor(level);
+		bitrateOut.store(decision.bitrate, std::memory_order_relaxed);
+		fecOut.store(decision.fec, std::memory_order_relaxed);
+		return true;
+	}
+
+	bitrateAdapterStats bitrateAdapter::stats() const {
+		bitrateAdapterStats out;
+		out.baseBitrate = baseBitrateOut.load(std::memory_order_relaxed);
+		out.bitrate = bitrateOut.load(std::memory_order_relaxed);
+		out.fec = fecOut.load(std::memory_order_relaxed);
+		out.stepDowns = stepDowns.load(std::memory_order_relaxed);
+		out.stepUps = stepUps.load(std::memory_order_relaxed);
+		return out;
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+//---BITRATE ADAPTER---//
+
+namespace trbdrAudio {
+	// What the encoder should be running at, after a decision.
+	struct bitrateDecision {
+		int bitrate = 0;
+		bool fec = false;
+		int packetLossPercent = 0;
+	};
+
+	// Snapshot of the adapter, for the logs.
+	struct bitrateAdapterStats {
+		int baseBitrate = 0;
+		int bitrate = 0;
+		bool fec = false;
+		uint64_t stepDowns = 0;
+		uint64_t stepUps = 0;
+	};
+
+	// Steps the Opus bitrate down, and turns FEC on, while D++'s send queue is backed up, then steps back up once it's drained.
+	// A queue that keeps growing means packets aren't leaving as fast as we make them, so smaller packets and some
+	// redundancy beat pushing full bitrate into a connection that can't take it. Both directions need the queue to stay
+	// past its threshold for a while, and recovering is much slower than backing off, so a single late packet doesn't flap it.
+	// update() and reset() belong to the encoder thread; stats() can be read from anywhere.
+	class bitrateAdapter {
+	public:
+		// Backs off above "backoffMs" of queued audio, and recovers below "recoverMs". A backoffMs of 0 turns it off.
+		bitrateAdapter(double backoffMs, double recoverMs);
+
+		// Starts over at full rate from a profile's settings. Called whenever the profile changes.
+		void reset(int baseBitrate, bool baseFec, int baseLossPercent);
+
+		// Feeds in the queue depth after a packet was sent. Returns true, with the new settings, when they should change.
+		bool update(double queuedMs, int64_t nowNs, bitrateDecision& decision);
+
+		bitrateAdapterStats stats() const;
+
+	private:
+		bitrateDecision decisionFor(int level) const;
+
+		const double backoffMs;
+		const double recoverMs;
+
+		int baseBitrate = 0;
+		bool baseFec = false;
+		int baseLossPercent = 0;
+		int level = 0;										// 0 is the profile's own settings, higher is further backed off
+		int64_t backedUpSinceNs = 0;
+		int64_t drainedSinceNs = 0;
+		int64_t lastChangeNs = 0;
+
+		std::atomic<int> baseBitrateOut = 0;
+		std::atomic<int> bitrateOut = 0;
+		std::atomic<bool> fecOut = false;
+		std::atomic<uint64_t> stepDowns = 0;
+		std::atomic<uint64_t> stepUps = 0;
+	};
+}
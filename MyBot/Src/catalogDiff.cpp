@@ -0,0 +1,45 @@
+#include "catalogDiff.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+//---CATALOG DIFF---//
+
+namespace trbdrAudio {
+	// Folds the GUID's 16 bytes into two words and mixes them. GUIDs are already random, so this only has to be cheap.
+	size_t guidHash::operator()(const FMOD_GUID& id) const {
+		uint64_t words[2];
+		static_assert(sizeof(words) == sizeof(FMOD_GUID));
+		memcpy(words, &id, sizeof(words));
+		return (size_t)((words[0] * 0x9E3779B97F4A7C15ull) ^ words[1]);
+	}
+
+	bool guidEqual::operator()(const FMOD_GUID& a, const FMOD_GUID& b) const {
+		return memcmp(&a, &b, sizeof(FMOD_GUID)) == 0;
+	}
+
+	std::string formatGUID(const FMOD_GUID& id) {
+		char text[40];
+		snprintf(text, sizeof(text), "{%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x}", (unsigned int)id.Data1, (unsigned int)id.Data2, (unsigned int)id.Data3,
+			id.Data4[0], id.Data4[1], id.Data4[2], id.Data4[3], id.Data4[4], id.Data4[5], id.Data4[6], id.Data4[7]);
+		return text;
+	}
+
+	catalogDiff diffCatalog(const guidNames& indexed, const guidNames& live, std::string (*niceName)(std::string)) {
+		catalogDiff diff;
+
+		// Removals: indexed, but gone from the strings or under a different name now
+		for (const auto& [id, name] : indexed) {
+			auto found = live.find(id);
+			if (found == live.end() || niceName(found->second) != name) { diff.removed.push_back(name); }
+		}
+
+		// Additions: in the strings, but not indexed under that name
+		for (const auto& [id, path] : live) {
+			auto found = indexed.find(id);
+			if (found == indexed.end() || found->second != niceName(path)) { diff.added.push_back({ id, path }); }
+		}
+		return diff;
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "fmod_common.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+//---CATALOG DIFF---//
+
+namespace trbdrAudio {
+	// Let FMOD_GUIDs key unordered containers.
+	struct guidHash { size_t operator()(const FMOD_GUID& id) const; };
+	struct guidEqual { bool operator()(const FMOD_GUID& a, const FMOD_GUID& b) const; };
+
+	// Studio object IDs to a name: the Nice Name for what's indexed, the full path for what's in the strings bank.
+	using guidNames = std::unordered_map<FMOD_GUID, std::string, guidHash, guidEqual>;
+	using guidSet = std::unordered_set<FMOD_GUID, guidHash, guidEqual>;
+
+	// Writes a GUID the way FMOD Studio shows it, e.g. {f2a4f1ba-2c0c-4c3b-a0a1-6ab3b0c8f3d2}.
+	std::string formatGUID(const FMOD_GUID& id);
+
+	// What has to change to bring an index up to date with the strings bank.
+	struct catalogDiff {
+		std::vector<std::string> removed;									// Nice Names to drop
+		std::vector<std::pair<FMOD_GUID, std::string>> added;				// IDs and full paths to look up and add
+	};
+
+	// Compares "indexed" (ID to Nice Name) with "live" (ID to full path) by ID, in one pass over each.
+	// "niceName" turns a full path into its Nice Name, so a renamed or moved object counts as one of each.
+	catalogDiff diffCatalog(const guidNames& indexed, const guidNames& live, std::string (*niceName)(std::string));
+}
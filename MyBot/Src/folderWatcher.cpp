@@ -0,0 +1,98 @@
+#include "folderWatcher.h"
+
+#include <system_error>
+
+//---FOLDER WATCHER---//
+
+namespace trbdrUtils {
+	folderWatcher::~folderWatcher() { stop(); }
+
+	void folderWatcher::start(const std::filesystem::path& newFolder, const std::string& newExtension, std::chrono::milliseconds newPollInterval,
+		std::chrono::milliseconds newSettle, std::function<void(const folderChanges&)> newOnChange) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (running) { return; }
+			running = true;
+		}
+		folder = newFolder;
+		extension = newExtension;
+		pollInterval = newPollInterval;
+		settle = newSettle;
+		onChange = std::move(newOnChange);
+		thread = std::thread(&folderWatcher::run, this);
+	}
+
+	void folderWatcher::stop() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!running) { return; }
+			running = false;
+		}
+		wakeWatcher.notify_all();
+		if (thread.joinable()) { thread.join(); }
+	}
+
+	std::optional<folderWatcher::listing> folderWatcher::scan() const {
+		// Files can come and go mid-scan while something's writing them, so a file that can't be read this time just
+		// looks like a change, and gets another look next poll. The folder itself failing means no listing at all,
+		// since an empty or partial one would look like every file had gone.
+		listing found;
+		std::error_code error;
+		std::filesystem::directory_iterator entry(folder, error);
+		if (error) { return std::nullopt; }
+		for (std::filesystem::directory_iterator end; entry != end; entry.increment(error)) {
+			std::error_code fileError;
+			if (entry->path().extension() != extension || !entry->is_regular_file(fileError)) { continue; }
+			fileState state;
+			state.size = entry->file_size(fileError);
+			if (fileError) { continue; }
+			state.modified = entry->last_write_time(fileError);
+			if (fileError) { continue; }
+			found.insert({ entry->path(), state });
+		}
+		if (error) { return std::nullopt; }			// Failed part way, which also ends the loop
+		return found;
+	}
+
+	void folderWatcher::run() {
+		std::optional<listing> baseline = scan();
+		std::chrono::steady_clock::time_point lastChange = std::chrono::steady_clock::now();
+		while (!baseline) {								// Nothing to compare against until the folder's been read once
+			std::unique_lock<std::mutex> lock(mutex);
+			if (wakeWatcher.wait_for(lock, pollInterval, [this] { return !running; })) { return; }
+			lock.unlock();
+			baseline = scan();
+		}
+		listing reported = std::move(*baseline);
+		listing latest = reported;
+
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				if (wakeWatcher.wait_for(lock, pollInterval, [this] { return !running; })) { return; }
+			}
+
+			std::optional<listing> now = scan();
+			if (!now) { continue; }						// Couldn't read the folder this time, so skip the poll rather than report it empty
+			if (*now != latest) {						// Still being written, so start waiting again
+				latest = std::move(*now);
+				lastChange = std::chrono::steady_clock::now();
+				continue;
+			}
+			if (latest == reported || std::chrono::steady_clock::now() - lastChange < settle) { continue; }
+
+			// Settled, and different from last time
+			folderChanges changes;
+			for (const auto& [path, state] : latest) {
+				auto previous = reported.find(path);
+				if (previous == reported.end()) { changes.added.push_back(path); }
+				else if (!(previous->second == state)) { changes.changed.push_back(path); }
+			}
+			for (const auto& [path, state] : reported) {
+				if (!latest.contains(path)) { changes.removed.push_back(path); }
+			}
+			reported = latest;
+			onChange(changes);
+		}
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+//---FOLDER WATCHER---//
+
+namespace trbdrUtils {
+	// Files that appeared, were rewritten, or went away since the last report.
+	struct folderChanges {
+		std::vector<std::filesystem::path> added;
+		std::vector<std::filesystem::path> changed;
+		std::vector<std::filesystem::path> removed;
+
+		bool empty() const { return added.empty() && changed.empty() && removed.empty(); }
+	};
+
+	// Watches one folder for files with a given extension, by comparing each file's size and modified time every poll.
+	// Only reports once the folder has stopped changing for "settle", so a tool that writes several files one after
+	// another (like an FMOD Studio build) is reported once, after it's finished, rather than halfway through.
+	class folderWatcher {
+	public:
+		folderWatcher() = default;
+		~folderWatcher();
+
+		folderWatcher(const folderWatcher&) = delete;
+		folderWatcher& operator=(const folderWatcher&) = delete;
+
+		// Starts watching. What's there now is the baseline; onChange is called on the watcher's thread.
+		void start(const std::filesystem::path& folder, const std::string& extension, std::chrono::milliseconds pollInterval,
+			std::chrono::milliseconds settle, std::function<void(const folderChanges&)> onChange);
+
+		// Stops and joins the watcher. Changes that haven't settled yet aren't reported.
+		void stop();
+
+	private:
+		struct fileState {
+			uintmax_t size = 0;
+			std::filesystem::file_time_type modified;
+
+			bool operator==(const fileState&) const = default;
+		};
+		using listing = std::map<std::filesystem::path, fileState>;
+
+		// Lists the folder, or returns nothing if it couldn't be read (say, it's missing or locked for a moment).
+		std::optional<listing> scan() const;
+		void run();
+
+		std::filesystem::path folder;
+		std::string extension;
+		std::chrono::milliseconds pollInterval{ 0 };
+		std::chrono::milliseconds settle{ 0 };
+		std::function<void(const folderChanges&)> onChange;
+		std::thread thread;
+
+		std::mutex mutex;										// Guards running, and lets stop() wake the thread
+		std::condition_variable wakeWatcher;
+		bool running = false;
+	};
+}
@@ -0,0 +1,98 @@
+#include "frameBuffer.h"
+
+#include <chrono>
+
+//---AUDIO FRAME BUFFER---//
+
+namespace trbdrAudio {
+	pcmFrameBuffer::pcmFrameBuffer(size_t capacityFrames)
+		: capacityFrames(capacityFrames), slotCount(capacityFrames + 1) {
+		slots = new pcmFrame[slotCount];		// The only allocation this buffer ever makes
+	}
+
+	pcmFrameBuffer::~pcmFrameBuffer() {
+		delete[] slots;
+	}
+
+	// Returns where the next samples should be written, and how many samples are left in the frame being filled.
+	int16_t* pcmFrameBuffer::writePtr(size_t& samplesFree) {
+		size_t slot = head.load(std::memory_order_relaxed) % slotCount;
+		samplesFree = frameSampleCount - fillSamples;
+		return slots[slot].samples + fillSamples;
+	}
+
+	// Sets the capture stamps given to any frame that starts from here on.
+	void pcmFrameBuffer::stampCapture(uint64_t dspClock, int64_t capturedNs) {
+		blockDspClock = dspClock;
+		blockSamples = 0;
+		blockCapturedNs = capturedNs;
+	}
+
+	// Marks samples as written, publishing the frame once it's full.
+	void pcmFrameBuffer::commitWrite(size_t samplesWritten) {
+		if (fillSamples == 0 && samplesWritten > 0) {
+			pcmFrame& starting = slots[head.load(std::memory_order_relaxed) % slotCount];
+			starting.dspClock = blockDspClock + blockSamples;
+			starting.capturedNs = blockCapturedNs;
+		}
+		blockSamples += samplesWritten / frameChannels;
+		fillSamples += samplesWritten;
+		if (fillSamples < frameSampleCount) { return; }
+
+		fillSamples = 0;
+		size_t currentHead = head.load(std::memory_order_relaxed);
+		if (currentHead - tail.load(std::memory_order_acquire) >= capacityFrames) {
+			// Consumer is too far behind. Reuse the same slot for the next frame,
+			// which drops the one we just finished rather than stalling the mixer.
+			overrunCount.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		slots[currentHead % slotCount].publishedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		head.store(currentHead + 1, std::memory_order_release);
+		wake();
+	}
+
+	// Copies the oldest published frame into "out". Returns false (counting an underrun) if there isn't one.
+	bool pcmFrameBuffer::pop(pcmFrame& out) {
+		size_t currentTail = tail.load(std::memory_order_relaxed);
+		if (currentTail == head.load(std::memory_order_acquire)) {
+			underrunCount.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		out = slots[currentTail % slotCount];
+		tail.store(currentTail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Discards every published frame.
+	void pcmFrameBuffer::clear() {
+		tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+	// Discards up to "frames" of the oldest published frames.
+	size_t pcmFrameBuffer::discard(size_t frames) {
+		size_t currentTail = tail.load(std::memory_order_relaxed);
+		size_t available = head.load(std::memory_order_acquire) - currentTail;
+		if (frames > available) { frames = available; }
+		tail.store(currentTail + frames, std::memory_order_release);
+		return frames;
+	}
+
+	// Number of whole frames waiting to be popped.
+	size_t pcmFrameBuffer::framesAvailable() const {
+		return head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed);
+	}
+
+	// Blocks until a frame is published or wake() is called.
+	void pcmFrameBuffer::waitForFrame() {
+		uint32_t seen = signal.load(std::memory_order_acquire);
+		if (framesAvailable() > 0) { return; }		// Checked after reading the signal, so a publish in between can't be missed
+		signal.wait(seen, std::memory_order_acquire);
+	}
+
+	// Releases a waitForFrame() early. The producer calls this after every publish.
+	void pcmFrameBuffer::wake() {
+		signal.fetch_add(1, std::memory_order_release);
+		signal.notify_one();
+	}
+}
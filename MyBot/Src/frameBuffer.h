@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//---AUDIO FRAME BUFFER---//
+
+namespace trbdrAudio {
+	// Discord (via Opus) wants 48kHz stereo audio, cut into 20ms frames.
+	inline constexpr size_t frameSampleRate = 48000;
+	inline constexpr size_t frameChannels = 2;
+	inline constexpr size_t frameLengthMs = 20;
+	inline constexpr size_t frameSamplesPerChannel = frameSampleRate / 1000 * frameLengthMs;		// 960
+	inline constexpr size_t frameSampleCount = frameSamplesPerChannel * frameChannels;			// 1920 interleaved samples
+
+	// Size we pad shared indices out to, so the producer and consumer never fight over a cache line.
+	inline constexpr size_t cacheLineSize = 64;
+
+	// One 20ms frame of interleaved stereo 16-bit PCM, with when it was captured for the latency metrics.
+	struct pcmFrame {
+		int16_t samples[frameSampleCount];
+		uint64_t dspClock = 0;			// FMOD DSP clock at the frame's first sample, in 48 kHz samples
+		int64_t capturedNs = 0;			// steady_clock time of that mixer block
+		int64_t publishedNs = 0;		// steady_clock time the producer finished the frame
+	};
+
+	// Fixed-capacity, single-producer/single-consumer ring of whole PCM frames.
+	// The producer (FMOD's mixer thread) fills frames a few samples at a time and publishes each one once it's full;
+	// the consumer only ever sees complete frames. All memory is allocated up front, and neither side ever locks.
+	class pcmFrameBuffer {
+	public:
+		explicit pcmFrameBuffer(size_t capacityFrames);
+		~pcmFrameBuffer();
+
+		pcmFrameBuffer(const pcmFrameBuffer&) = delete;
+		pcmFrameBuffer& operator=(const pcmFrameBuffer&) = delete;
+
+		//---Producer side---//
+
+		// Returns where the next samples should be written, and how many samples are left in the frame being filled.
+		int16_t* writePtr(size_t& samplesFree);
+
+		// Sets the capture stamps given to any frame that starts from here on. Call once per mixer block, with the block's
+		// DSP clock in 48 kHz samples. A frame starting part way in gets the clock plus however far in it starts.
+		void stampCapture(uint64_t dspClock, int64_t capturedNs);
+
+		// Marks samples written at writePtr() as done. Publishes the frame when it fills up,
+		// or throws it away (counting an overrun) if the consumer has fallen too far behind.
+		void commitWrite(size_t samplesWritten);
+
+		//---Consumer side---//
+
+		// Copies the oldest published frame into "out". Returns false (counting an underrun) if there isn't one.
+		bool pop(pcmFrame& out);
+
+		// Discards every published frame.
+		void clear();
+
+		// Discards up to "frames" of the oldest published frames. Returns how many were actually discarded.
+		size_t discard(size_t frames);
+
+		// Number of whole frames waiting to be popped.
+		size_t framesAvailable() const;
+
+		// Blocks until a frame is published or wake() is called. Returns straight away if a frame is already waiting.
+		void waitForFrame();
+
+		// Releases a waitForFrame() early, e.g. to let the consumer notice it should stop. Safe from any thread.
+		void wake();
+
+		size_t capacity() const { return capacityFrames; }
+		uint64_t overruns() const { return overrunCount.load(std::memory_order_relaxed); }
+		uint64_t underruns() const { return underrunCount.load(std::memory_order_relaxed); }
+
+	private:
+		// One more slot than capacity, so the frame being filled never aliases a published one.
+		const size_t capacityFrames;
+		const size_t slotCount;
+		pcmFrame* slots = nullptr;
+
+		// Monotonic counters; published frames are [tail, head).
+		alignas(cacheLineSize) std::atomic<size_t> head{ 0 };		// Written by producer only
+		alignas(cacheLineSize) std::atomic<size_t> tail{ 0 };		// Written by consumer only
+
+		// Bumped on every publish and wake(). The consumer sleeps on it with C++20 atomic wait.
+		alignas(cacheLineSize) std::atomic<uint32_t> signal{ 0 };
+
+		// Producer-private fill level of slot (head % slotCount), and the stamps for the next frame to start.
+		alignas(cacheLineSize) size_t fillSamples = 0;
+		uint64_t blockDspClock = 0;
+		uint64_t blockSamples = 0;									// Per channel, written since the last stamp
+		int64_t blockCapturedNs = 0;
+
+		alignas(cacheLineSize) std::atomic<uint64_t> overrunCount{ 0 };
+		std::atomic<uint64_t> underrunCount{ 0 };
+	};
+}
@@ -0,0 +1,135 @@
+#include "headlessOutput.h"
+#include "frameBuffer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+//---HEADLESS OUTPUT---//
+
+namespace trbdrAudio {
+	// If the thread is ever this many blocks behind (a debugger pause, a suspended VM), it skips ahead instead of catching up.
+	static constexpr int maxCatchUpBlocks = 10;
+
+	headlessOutput::headlessOutput(mixBlockCallback onBlock, void* userdata) : onBlock(onBlock), userdata(userdata) {}
+
+	headlessOutput::~headlessOutput() {
+		joinThread();
+	}
+
+	// Description to hand to FMOD::System::registerOutput.
+	const FMOD_OUTPUT_DESCRIPTION* headlessOutput::description() {
+		static FMOD_OUTPUT_DESCRIPTION desc = [] {
+			FMOD_OUTPUT_DESCRIPTION d;
+			memset(&d, 0, sizeof(d));
+			d.apiversion = FMOD_OUTPUT_PLUGIN_VERSION;
+			d.name = "Troubadour Headless";
+			d.version = 0x00010000;
+			d.method = FMOD_OUTPUT_METHOD_MIX_DIRECT;		// We drive the mixer from our own thread
+			d.getnumdrivers = getNumDrivers;
+			d.getdriverinfo = getDriverInfo;
+			d.init = init;
+			d.start = start;
+			d.stop = stop;
+			d.close = close;
+			return d;
+		}();
+		return &desc;
+	}
+
+	headlessOutputStats headlessOutput::stats() const {
+		headlessOutputStats out;
+		out.blocksMixed = blocksMixed.load(std::memory_order_relaxed);
+		out.lateWakeups = lateWakeups.load(std::memory_order_relaxed);
+		return out;
+	}
+
+	FMOD_RESULT F_CALL headlessOutput::getNumDrivers(FMOD_OUTPUT_STATE* state, int* numdrivers) {
+		if (numdrivers == nullptr) { return FMOD_ERR_INVALID_PARAM; }
+		*numdrivers = 1;
+		return FMOD_OK;
+	}
+
+	FMOD_RESULT F_CALL headlessOutput::getDriverInfo(FMOD_OUTPUT_STATE* state, int id, char* name, int namelen, FMOD_GUID* guid,
+		int* systemrate, FMOD_SPEAKERMODE* speakermode, int* speakermodechannels) {
+
+		// FMOD only asks for what it wants, so any of these can be null
+		if (name != nullptr && namelen > 0) { snprintf(name, (size_t)namelen, "%s", "Discord"); }
+		if (guid != nullptr) { memset(guid, 0, sizeof(FMOD_GUID)); }
+		if (systemrate != nullptr) { *systemrate = (int)frameSampleRate; }
+		if (speakermode != nullptr) { *speakermode = FMOD_SPEAKERMODE_STEREO; }
+		if (speakermodechannels != nullptr) { *speakermodechannels = (int)frameChannels; }
+		return FMOD_OK;
+	}
+
+	// Claims the format we want and sizes the mix buffer. FMOD calls this from System::init.
+	FMOD_RESULT F_CALL headlessOutput::init(FMOD_OUTPUT_STATE* state, int selecteddriver, FMOD_INITFLAGS flags, int* outputrate,
+		FMOD_SPEAKERMODE* speakermode, int* speakermodechannels, FMOD_SOUND_FORMAT* outputformat, int dspbufferlength,
+		int* dspnumbuffers, int* dspnumadditionalbuffers, void* extradriverdata) {
+
+		headlessOutput* self = (headlessOutput*)extradriverdata;
+		if (self == nullptr || dspbufferlength <= 0) { return FMOD_ERR_OUTPUT_INIT; }
+		state->plugindata = self;
+		self->outputState = state;
+
+		*outputrate = (int)frameSampleRate;
+		*speakermode = FMOD_SPEAKERMODE_STEREO;
+		*speakermodechannels = (int)frameChannels;
+		*outputformat = FMOD_SOUND_FORMAT_PCMFLOAT;
+
+		self->blockFrames = (unsigned int)dspbufferlength;
+		self->mixBuffer.assign((size_t)dspbufferlength * frameChannels, 0.0f);
+		self->mixClock = 0;
+		return FMOD_OK;
+	}
+
+	FMOD_RESULT F_CALL headlessOutput::start(FMOD_OUTPUT_STATE* state) {
+		headlessOutput* self = (headlessOutput*)state->plugindata;
+		self->running = true;
+		self->thread = std::thread(&headlessOutput::run, self);
+		return FMOD_OK;
+	}
+
+	FMOD_RESULT F_CALL headlessOutput::stop(FMOD_OUTPUT_STATE* state) {
+		((headlessOutput*)state->plugindata)->joinThread();
+		return FMOD_OK;
+	}
+
+	FMOD_RESULT F_CALL headlessOutput::close(FMOD_OUTPUT_STATE* state) {
+		headlessOutput* self = (headlessOutput*)state->plugindata;
+		self->joinThread();
+		self->outputState = nullptr;
+		return FMOD_OK;
+	}
+
+	// Mixes one block per period, on absolute deadlines. If the OS wakes us late, every block
+	// that's come due gets mixed straight away, so FMOD's timeline never falls behind real time.
+	void headlessOutput::run() {
+		const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>((double)blockFrames / (double)frameSampleRate));
+		auto nextBlock = std::chrono::steady_clock::now();
+
+		while (running) {
+			int due = 0;
+			while (running && std::chrono::steady_clock::now() >= nextBlock) {
+				outputState->readfrommixer(outputState, mixBuffer.data(), blockFrames);
+				onBlock(mixBuffer.data(), blockFrames, (int)frameChannels, mixClock, userdata);
+				mixClock += blockFrames;
+				nextBlock += period;
+				due++;
+				if (due >= maxCatchUpBlocks) {
+					nextBlock = std::chrono::steady_clock::now() + period;
+					break;
+				}
+			}
+			blocksMixed.fetch_add((uint64_t)due, std::memory_order_relaxed);
+			if (due > 1) { lateWakeups.fetch_add(1, std::memory_order_relaxed); }
+			std::this_thread::sleep_until(nextBlock);
+		}
+	}
+
+	void headlessOutput::joinThread() {
+		running = false;
+		if (thread.joinable()) { thread.join(); }
+	}
+}
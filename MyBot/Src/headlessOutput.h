@@ -0,0 +1,66 @@
+#pragma once
+
+#include "fmod.hpp"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+//---HEADLESS OUTPUT---//
+
+namespace trbdrAudio {
+	// Called with each block FMOD mixes: interleaved float samples, and a running count of frames mixed so far.
+	typedef void (*mixBlockCallback)(const float* samples, unsigned int frames, int channels, uint64_t mixClock, void* userdata);
+
+	// Snapshot of how the output thread is keeping time.
+	struct headlessOutputStats {
+		uint64_t blocksMixed = 0;
+		uint64_t lateWakeups = 0;				// Wakeups that found more than one block due, and caught up
+	};
+
+	// FMOD output plugin that needs no audio device. Instead of FMOD's own mixer thread feeding a sound card,
+	// our thread pulls each block from the mixer on a steady clock (MIX_DIRECT) and hands it to a callback,
+	// which writes it straight into the capture path. Always 48 kHz stereo float.
+	// Pass the object as Studio's extradriverdata, so FMOD's callbacks can find it.
+	class headlessOutput {
+	public:
+		headlessOutput(mixBlockCallback onBlock, void* userdata);
+		~headlessOutput();
+
+		headlessOutput(const headlessOutput&) = delete;
+		headlessOutput& operator=(const headlessOutput&) = delete;
+
+		// Description to hand to FMOD::System::registerOutput.
+		static const FMOD_OUTPUT_DESCRIPTION* description();
+
+		headlessOutputStats stats() const;
+
+	private:
+		static FMOD_RESULT F_CALL getNumDrivers(FMOD_OUTPUT_STATE* state, int* numdrivers);
+		static FMOD_RESULT F_CALL getDriverInfo(FMOD_OUTPUT_STATE* state, int id, char* name, int namelen, FMOD_GUID* guid,
+			int* systemrate, FMOD_SPEAKERMODE* speakermode, int* speakermodechannels);
+		static FMOD_RESULT F_CALL init(FMOD_OUTPUT_STATE* state, int selecteddriver, FMOD_INITFLAGS flags, int* outputrate,
+			FMOD_SPEAKERMODE* speakermode, int* speakermodechannels, FMOD_SOUND_FORMAT* outputformat, int dspbufferlength,
+			int* dspnumbuffers, int* dspnumadditionalbuffers, void* extradriverdata);
+		static FMOD_RESULT F_CALL start(FMOD_OUTPUT_STATE* state);
+		static FMOD_RESULT F_CALL stop(FMOD_OUTPUT_STATE* state);
+		static FMOD_RESULT F_CALL close(FMOD_OUTPUT_STATE* state);
+
+		void run();
+		void joinThread();
+
+		mixBlockCallback onBlock;
+		void* userdata;
+
+		FMOD_OUTPUT_STATE* outputState = nullptr;
+		unsigned int blockFrames = 0;
+		std::vector<float> mixBuffer;					// Sized in init(), reused for every block
+		uint64_t mixClock = 0;
+
+		std::thread thread;
+		std::atomic<bool> running = false;
+
+		std::atomic<uint64_t> blocksMixed = 0;
+		std::atomic<uint64_t> lateWakeups = 0;
+	};
+}
@@ -0,0 +1,299 @@
+#include "indexCache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <system_error>
+#include <unordered_map>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+//---INDEX CACHE---//
+
+namespace trbdrAudio {
+	// Start of every index file.
+	static constexpr char indexMagic[4] = { 'T', 'I', 'D', 'X' };
+
+	// Banks bigger than this only have their first and last hashedEdgeBytes hashed. Their size and modified time still
+	// count, and re-reading gigabytes of sample data on every startup would cost more than the index saves.
+	static constexpr uintmax_t fullHashLimit = 64ull * 1024 * 1024;
+	static constexpr uintmax_t hashedEdgeBytes = 1024 * 1024;
+
+	struct indexHeader {
+		char magic[4];
+		uint32_t version;
+		uint64_t key;												// bankSetKey of the banks it was built from
+		uint64_t contentsKey;										// ...and their bankContentsKey
+		uint32_t counts[4];											// Events, busses, VCAs, snapshots
+		uint32_t paramCount;
+		uint32_t stringBytes;
+	};
+
+	// FNV-1a, as with the Opus cache
+	static void hashBytes(uint64_t& hash, const void* data, size_t length) {
+		const uint8_t* bytes = (const uint8_t*)data;
+		for (size_t i = 0; i < length; i++) {
+			hash = (hash ^ bytes[i]) * 1099511628211ull;
+		}
+	}
+
+	static void hashRange(uint64_t& hash, std::ifstream& in, uintmax_t from, uintmax_t length) {
+		char buffer[65536];
+		in.clear();
+		in.seekg((std::streamoff)from);
+		while (length > 0 && in) {
+			in.read(buffer, (std::streamsize)std::min<uintmax_t>(sizeof(buffer), length));
+			std::streamsize got = in.gcount();
+			if (got <= 0) { break; }
+			hashBytes(hash, buffer, (size_t)got);
+			length -= (uintmax_t)got;
+		}
+	}
+
+	uint64_t bankSetKey(const std::vector<std::filesystem::path>& banks) {
+		uint64_t hash = 14695981039346656037ull;
+		hashBytes(hash, &indexCacheVersion, sizeof(indexCacheVersion));
+		for (const std::filesystem::path& bank : banks) {
+			std::string name = bank.filename().string();
+			hashBytes(hash, name.data(), name.size() + 1);
+
+			std::error_code error;
+			uintmax_t size = std::filesystem::file_size(bank, error);
+			if (error) { size = 0; }
+			int64_t modified = 0;
+			auto writeTime = std::filesystem::last_write_time(bank, error);
+			if (!error) { modified = (int64_t)writeTime.time_since_epoch().count(); }
+			hashBytes(hash, &size, sizeof(size));
+			hashBytes(hash, &modified, sizeof(modified));
+		}
+		return hash;
+	}
+
+	uint64_t bankContentsKey(const std::vector<std::filesystem::path>& banks) {
+		// Every session indexes the same banks, so whoever gets here first pays for the read and the rest reuse it
+		static std::mutex keysMutex;
+		static std::unordered_map<uint64_t, uint64_t> keys;			// bankSetKey to bankContentsKey
+		uint64_t setKey = bankSetKey(banks);
+		std::lock_guard<std::mutex> lock(keysMutex);
+		auto found = keys.find(setKey);
+		if (found != keys.end()) { return found->second; }
+
+		uint64_t hash = 14695981039346656037ull;
+		hashBytes(hash, &indexCacheVersion, sizeof(indexCacheVersion));
+		for (const std::filesystem::path& bank : banks) {
+			std::string name = bank.filename().string();
+			hashBytes(hash, name.data(), name.size() + 1);
+
+			std::error_code error;
+			uintmax_t size = std::filesystem::file_size(bank, error);
+			if (error) { size = 0; }
+			hashBytes(hash, &size, sizeof(size));
+
+			std::ifstream in(bank, std::ios::binary);
+			if (!in.is_open()) { continue; }
+			if (size <= fullHashLimit) { hashRange(hash, in, 0, size); }
+			else {
+				hashRange(hash, in, 0, hashedEdgeBytes);
+				hashRange(hash, in, size - hashedEdgeBytes, hashedEdgeBytes);
+			}
+		}
+		keys.insert({ setKey, hash });
+		return hash;
+	}
+
+	// Whether the index in "file" was built from "banks". A different bankSetKey only means a bank was touched, copied or
+	// checked out again, so it's settled by the contents. If those still match, the new key is written back over the old
+	// one, so the next startup gets away with the cheap check. Another session can have the file mapped, in which case
+	// it's left for later. "matchedKey" is the key the file had, for checking it's still the same file once it's mapped.
+	static bool indexMatches(const std::filesystem::path& file, uint64_t key, const std::vector<std::filesystem::path>& banks, uint64_t& matchedKey) {
+		std::fstream io(file, std::ios::in | std::ios::out | std::ios::binary);
+		if (!io.is_open()) { io.open(file, std::ios::in | std::ios::binary); }
+		if (!io.is_open()) { return false; }
+		indexHeader header;
+		if (!io.read((char*)&header, sizeof(header))) { return false; }
+		if (memcmp(header.magic, indexMagic, sizeof(indexMagic)) != 0 || header.version != indexCacheVersion) { return false; }
+		matchedKey = header.key;
+		if (header.key == key) { return true; }
+		if (header.contentsKey != bankContentsKey(banks)) { return false; }
+
+		io.seekp((std::streamoff)offsetof(indexHeader, key));
+		io.write((const char*)&key, sizeof(key));
+		return true;
+	}
+
+	bool writeStudioIndex(const std::filesystem::path& file, const std::vector<std::filesystem::path>& banks, const studioIndex& index) {
+		const std::vector<indexedObject>* sections[4] = { &index.events, &index.busses, &index.vcas, &index.snapshots };
+
+		// Lay out the string table and records first, then write it all in one go
+		std::string strings;
+		auto addString = [&strings](const char* text) {
+			uint32_t offset = (uint32_t)strings.size();
+			strings.append(text);
+			strings.push_back('\0');
+			return offset;
+		};
+		std::vector<studioIndexCache::objectRecord> objects;
+		std::vector<studioIndexCache::paramRecord> params;
+		indexHeader header = {};
+		memcpy(header.magic, indexMagic, sizeof(indexMagic));
+		header.version = indexCacheVersion;
+		header.key = bankSetKey(banks);
+		header.contentsKey = bankContentsKey(banks);
+		for (int s = 0; s < 4; s++) {
+			header.counts[s] = (uint32_t)sections[s]->size();
+			for (const indexedObject& object : *sections[s]) {
+				studioIndexCache::objectRecord record = {};
+				record.id = object.id;
+				record.pathOffset = addString(object.path.c_str());
+				record.bankOffset = addString(object.bank.c_str());
+				record.firstParam = (uint32_t)params.size();
+				record.paramCount = (uint32_t)object.params.size();
+				for (const FMOD_STUDIO_PARAMETER_DESCRIPTION& param : object.params) {
+					studioIndexCache::paramRecord paramOut = {};
+					paramOut.nameOffset = addString(param.name);
+					paramOut.id = param.id;
+					paramOut.minimum = param.minimum;
+					paramOut.maximum = param.maximum;
+					paramOut.defaultValue = param.defaultvalue;
+					paramOut.type = (int32_t)param.type;
+					paramOut.flags = (uint32_t)param.flags;
+					paramOut.guid = param.guid;
+					params.push_back(paramOut);
+				}
+				objects.push_back(record);
+			}
+		}
+		header.paramCount = (uint32_t)params.size();
+		header.stringBytes = (uint32_t)strings.size();
+
+		// Sessions can finish indexing at the same time, and would otherwise write over each other's temporary
+		static std::mutex writeMutex;
+		std::lock_guard<std::mutex> lock(writeMutex);
+		std::filesystem::path temp = file;
+		temp += ".tmp";
+		{
+			std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+			if (!out.is_open()) { return false; }
+			out.write((const char*)&header, sizeof(header));
+			out.write((const char*)objects.data(), (std::streamsize)(objects.size() * sizeof(objects[0])));
+			out.write((const char*)params.data(), (std::streamsize)(params.size() * sizeof(params[0])));
+			out.write(strings.data(), (std::streamsize)strings.size());
+			if (!out) { return false; }
+		}
+		std::error_code error;
+		std::filesystem::rename(temp, file, error);
+		if (error) { std::filesystem::remove(temp, error); return false; }
+		return true;
+	}
+
+	studioIndexCache::~studioIndexCache() { close(); }
+
+	bool studioIndexCache::open(const std::filesystem::path& file, const std::vector<std::filesystem::path>& banks) {
+		close();
+		uint64_t key = bankSetKey(banks);
+		uint64_t matchedKey = 0;
+		if (!indexMatches(file, key, banks, matchedKey)) { return false; }
+
+#ifdef _WIN32
+		// Sharing delete lets a rebuilt index be renamed over this one while it's still mapped
+		HANDLE fileOpened = CreateFileW(file.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (fileOpened == INVALID_HANDLE_VALUE) { return false; }
+		fileHandle = fileOpened;
+		LARGE_INTEGER fileSize = {};
+		if (!GetFileSizeEx(fileOpened, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(indexHeader)) { close(); return false; }
+		mappingHandle = CreateFileMappingW(fileOpened, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mappingHandle == nullptr) { close(); return false; }
+		base = (const uint8_t*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+		size = (size_t)fileSize.QuadPart;
+#else
+		int descriptor = ::open(file.c_str(), O_RDONLY);
+		if (descriptor < 0) { return false; }
+		struct stat info = {};
+		if (fstat(descriptor, &info) != 0 || info.st_size < (off_t)sizeof(indexHeader)) { ::close(descriptor); return false; }
+		void* mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+		::close(descriptor);
+		if (mapped == MAP_FAILED) { return false; }
+		base = (const uint8_t*)mapped;
+		size = (size_t)info.st_size;
+#endif
+		if (base == nullptr) { close(); return false; }
+
+		// Check it's ours, and that every offset stays inside the file before anything trusts one
+		indexHeader header;
+		memcpy(&header, base, sizeof(header));
+		if (memcmp(header.magic, indexMagic, sizeof(indexMagic)) != 0 || header.version != indexCacheVersion
+			|| (header.key != key && header.key != matchedKey)) { close(); return false; }
+		uint64_t objectCount = (uint64_t)header.counts[0] + header.counts[1] + header.counts[2] + header.counts[3];
+		uint64_t expected = sizeof(indexHeader) + objectCount * sizeof(objectRecord) + (uint64_t)header.paramCount * sizeof(paramRecord) + header.stringBytes;
+		if (expected != size || header.stringBytes == 0) { close(); return false; }
+
+		objects = (const objectRecord*)(base + sizeof(indexHeader));
+		paramRecords = (const paramRecord*)(objects + objectCount);
+		strings = (const char*)(paramRecords + header.paramCount);
+		if (strings[header.stringBytes - 1] != '\0') { close(); return false; }
+		for (uint64_t i = 0; i < objectCount; i++) {
+			const objectRecord& object = objects[i];
+			if (object.pathOffset >= header.stringBytes || object.bankOffset >= header.stringBytes || (uint64_t)object.firstParam + object.paramCount > header.paramCount) { close(); return false; }
+		}
+		for (uint32_t i = 0; i < header.paramCount; i++) {
+			if (paramRecords[i].nameOffset >= header.stringBytes) { close(); return false; }
+		}
+		memcpy(counts, header.counts, sizeof(counts));
+		return true;
+	}
+
+	void studioIndexCache::close() {
+#ifdef _WIN32
+		if (base != nullptr) { UnmapViewOfFile(base); }
+		if (mappingHandle != nullptr) { CloseHandle(mappingHandle); }
+		if (fileHandle != nullptr) { CloseHandle(fileHandle); }
+		mappingHandle = nullptr;
+		fileHandle = nullptr;
+#else
+		if (base != nullptr) { munmap((void*)base, size); }
+#endif
+		base = nullptr;
+		size = 0;
+		objects = nullptr;
+		paramRecords = nullptr;
+		strings = nullptr;
+		memset(counts, 0, sizeof(counts));
+	}
+
+	std::vector<FMOD_STUDIO_PARAMETER_DESCRIPTION> studioIndexCache::params(const objectRecord& object) const {
+		std::vector<FMOD_STUDIO_PARAMETER_DESCRIPTION> out;
+		out.reserve(object.paramCount);
+		for (uint32_t i = 0; i < object.paramCount; i++) {
+			const paramRecord& record = paramRecords[object.firstParam + i];
+			FMOD_STUDIO_PARAMETER_DESCRIPTION param = {};
+			param.name = strings + record.nameOffset;
+			param.id = record.id;
+			param.minimum = record.minimum;
+			param.maximum = record.maximum;
+			param.defaultvalue = record.defaultValue;
+			param.type = (FMOD_STUDIO_PARAMETER_TYPE)record.type;
+			param.flags = (FMOD_STUDIO_PARAMETER_FLAGS)record.flags;
+			param.guid = record.guid;
+			out.push_back(param);
+		}
+		return out;
+	}
+
+	std::span<const studioIndexCache::objectRecord> studioIndexCache::section(int which) const {
+		if (base == nullptr) { return {}; }
+		size_t first = 0;
+		for (int s = 0; s < which; s++) { first += counts[s]; }
+		return std::span<const objectRecord>(objects + first, counts[which]);
+	}
+}
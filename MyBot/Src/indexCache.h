@@ -0,0 +1,99 @@
+#pragma once
+
+#include "fmod_studio.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+//---INDEX CACHE---//
+
+namespace trbdrAudio {
+	// Bump if the file layout changes, so old index files get rebuilt.
+	inline constexpr uint32_t indexCacheVersion = 3;
+
+	// One Studio object, as indexStudio found it.
+	struct indexedObject {
+		std::string path;
+		FMOD_GUID id = {};
+		std::string bank;											// File name of the bank it's in, for events and snapshots
+		std::vector<FMOD_STUDIO_PARAMETER_DESCRIPTION> params;		// Events only
+	};
+
+	// Everything indexStudio pulls out of the strings bank, ready to be written out.
+	struct studioIndex {
+		std::vector<indexedObject> events;
+		std::vector<indexedObject> busses;
+		std::vector<indexedObject> vcas;
+		std::vector<indexedObject> snapshots;
+	};
+
+	// Hashes the name, size and modified time of every bank, in order. Only a few stat calls, so it's the everyday check.
+	uint64_t bankSetKey(const std::vector<std::filesystem::path>& banks);
+
+	// Hashes the name, size and contents of every bank, in order. Reads the banks, so it's only worked out when
+	// bankSetKey doesn't match, or an index is written, and then just once per process for each bankSetKey.
+	uint64_t bankContentsKey(const std::vector<std::filesystem::path>& banks);
+
+	// Writes the index to "file", tagged with both keys for "banks". Goes via a temporary so a crash never leaves half of one.
+	bool writeStudioIndex(const std::filesystem::path& file, const std::vector<std::filesystem::path>& banks, const studioIndex& index);
+
+	// A studioIndex file mapped read-only into memory. Nothing is copied out up front: paths and parameter names
+	// point straight into the mapping, so it has to stay open for as long as anything uses them.
+	class studioIndexCache {
+	public:
+		// Fixed-size records, as laid out in the file.
+		struct objectRecord {
+			FMOD_GUID id;
+			uint32_t pathOffset;									// Into the string table
+			uint32_t bankOffset;									// ...
+			uint32_t firstParam;
+			uint32_t paramCount;
+		};
+		struct paramRecord {
+			uint32_t nameOffset;
+			FMOD_STUDIO_PARAMETER_ID id;
+			float minimum;
+			float maximum;
+			float defaultValue;
+			int32_t type;
+			uint32_t flags;
+			FMOD_GUID guid;
+		};
+
+		studioIndexCache() = default;
+		~studioIndexCache();
+
+		studioIndexCache(const studioIndexCache&) = delete;
+		studioIndexCache& operator=(const studioIndexCache&) = delete;
+
+		// Maps "file". Returns false if it's missing, from another version, damaged, or built from a different set of banks.
+		bool open(const std::filesystem::path& file, const std::vector<std::filesystem::path>& banks);
+		void close();
+		bool isOpen() const { return base != nullptr; }
+
+		std::span<const objectRecord> events() const { return section(0); }
+		std::span<const objectRecord> busses() const { return section(1); }
+		std::span<const objectRecord> vcas() const { return section(2); }
+		std::span<const objectRecord> snapshots() const { return section(3); }
+
+		const char* path(const objectRecord& object) const { return strings + object.pathOffset; }
+		const char* bank(const objectRecord& object) const { return strings + object.bankOffset; }
+		std::vector<FMOD_STUDIO_PARAMETER_DESCRIPTION> params(const objectRecord& object) const;
+
+	private:
+		std::span<const objectRecord> section(int which) const;
+
+		const uint8_t* base = nullptr;
+		size_t size = 0;
+		const objectRecord* objects = nullptr;
+		uint32_t counts[4] = {};
+		const paramRecord* paramRecords = nullptr;
+		const char* strings = nullptr;
+#ifdef _WIN32
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+#endif
+	};
+}
@@ -0,0 +1,70 @@
+#include "latencyHistogram.h"
+
+#include <bit>
+
+//---LATENCY HISTOGRAM---//
+
+namespace trbdrAudio {
+	void latencyHistogram::record(uint64_t us) {
+		buckets[bucketFor(us)].fetch_add(1, std::memory_order_relaxed);
+		total.fetch_add(1, std::memory_order_relaxed);
+
+		uint64_t currentMax = maxUs.load(std::memory_order_relaxed);
+		while (us > currentMax && !maxUs.compare_exchange_weak(currentMax, us, std::memory_order_relaxed)) {}
+	}
+
+	// Approximate value at or below which "percent" of recorded durations fall.
+	uint64_t latencyHistogram::percentile(double percent) const {
+		static const latencyHistogram empty;
+		return percentileOf(*this, empty, percent);
+	}
+
+	void latencyHistogram::reset() {
+		for (auto& bucket : buckets) { bucket.store(0, std::memory_order_relaxed); }
+		total.store(0, std::memory_order_relaxed);
+		maxUs.store(0, std::memory_order_relaxed);
+	}
+
+	// Percentile across two histograms at once, as if their counts were added together.
+	uint64_t latencyHistogram::percentileOf(const latencyHistogram& a, const latencyHistogram& b, double percent) {
+		uint64_t recorded = a.count() + b.count();
+		if (recorded == 0) { return 0; }
+
+		uint64_t currentMax = std::max(a.max(), b.max());
+		uint64_t rank = (uint64_t)((percent / 100.0) * (double)recorded);
+		if (rank >= recorded) { rank = recorded - 1; }
+		uint64_t seen = 0;
+		for (size_t i = 0; i < bucketCount; i++) {
+			seen += a.buckets[i].load(std::memory_order_relaxed) + b.buckets[i].load(std::memory_order_relaxed);
+			if (seen > rank) { return std::min(bucketMidpoint(i), currentMax); }
+		}
+		return currentMax;
+	}
+
+	size_t latencyHistogram::bucketFor(uint64_t us) {
+		if (us < subBuckets) { return (size_t)us; }
+		if (us >= (1ull << 32)) { return bucketCount - 1; }
+		size_t exponent = (size_t)std::bit_width(us) - 1;			// 5 or more here
+		size_t sub = (size_t)(us >> (exponent - 5)) & (subBuckets - 1);
+		return subBuckets + ((exponent - 5) * subBuckets) + sub;
+	}
+
+	uint64_t latencyHistogram::bucketMidpoint(size_t bucket) {
+		if (bucket < subBuckets) { return bucket; }
+		size_t exponent = ((bucket - subBuckets) / subBuckets) + 5;
+		uint64_t sub = (bucket - subBuckets) % subBuckets;
+		uint64_t width = 1ull << (exponent - 5);
+		return (1ull << exponent) + (sub * width) + (width / 2);
+	}
+
+	// Empties the older window and starts recording into it.
+	void rollingLatencyHistogram::rotate() {
+		int older = 1 - active.load(std::memory_order_relaxed);
+		windows[older].reset();
+		active.store(older, std::memory_order_relaxed);
+	}
+
+	uint64_t rollingLatencyHistogram::percentile(double percent) const {
+		return latencyHistogram::percentileOf(windows[0], windows[1], percent);
+	}
+}
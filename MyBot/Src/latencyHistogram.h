@@ -0,0 +1,60 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//---LATENCY HISTOGRAM---//
+
+namespace trbdrAudio {
+	// Lock-free histogram of durations in microseconds, for the audio pipeline's latency reports.
+	// Buckets are exact below 32us, then 32 per power of two (about 3% wide), up to a bit over an hour.
+	// Any thread may record; reads are a best-effort snapshot, which is all a log line needs.
+	class latencyHistogram {
+	public:
+		void record(uint64_t us);
+
+		// Approximate value at or below which "percent" of recorded durations fall. 0 if nothing's been recorded.
+		uint64_t percentile(double percent) const;
+
+		uint64_t count() const { return total.load(std::memory_order_relaxed); }
+		uint64_t max() const { return maxUs.load(std::memory_order_relaxed); }
+
+		// Zeroes everything. Not atomic with respect to concurrent record() calls.
+		void reset();
+
+	private:
+		static constexpr size_t subBuckets = 32;
+		static constexpr size_t bucketCount = subBuckets + (27 * subBuckets);	// Exponents 5 through 31
+
+		friend class rollingLatencyHistogram;
+
+		static size_t bucketFor(uint64_t us);
+		static uint64_t bucketMidpoint(size_t bucket);
+		static uint64_t percentileOf(const latencyHistogram& a, const latencyHistogram& b, double percent);
+
+		std::atomic<uint64_t> buckets[bucketCount] = {};
+		std::atomic<uint64_t> total = 0;
+		std::atomic<uint64_t> maxUs = 0;
+	};
+
+	// Two latencyHistograms taking turns, so reports cover recent history rather than the whole run.
+	// rotate() empties the older window and starts recording into it; reads cover both windows,
+	// so they always span between one and two rotation periods.
+	class rollingLatencyHistogram {
+	public:
+		void record(uint64_t us) { windows[active.load(std::memory_order_relaxed)].record(us); }
+
+		// Call periodically from one thread. A record() racing the flip can land in the cleared window; that's fine for metrics.
+		void rotate();
+
+		uint64_t percentile(double percent) const;
+		uint64_t count() const { return windows[0].count() + windows[1].count(); }
+		uint64_t max() const { return std::max(windows[0].max(), windows[1].max()); }
+
+	private:
+		latencyHistogram windows[2];
+		std::atomic<int> active = 0;
+	};
+}
@@ -1,7 +1,21 @@
 ﻿#include "main.h"			//Pre-written sanity checks for versions
 #include "utils.h"			//Utility functions and all other necessary includes
+#include "frameBuffer.h"	//Lock-free buffer of PCM frames between FMOD and D++
+#include "pcmKernels.h"		//SIMD sample conversion for the capture path
+#include "resampler.h"		//Converts the capture path to 48 kHz, and absorbs clock drift
+#include "pipelineMetrics.h"	//Per-stage latency histograms, for /metrics and the metrics file
+#include "headlessOutput.h"		//FMOD output plugin that mixes straight to Discord, no sound card needed
+#include "opusCache.h"		//Loose sound files pre-encoded to Opus, for when one plays alone
+#include "indexCache.h"		//What indexStudio found, saved next to the banks for the next startup
+#include "catalogDiff.h"	//Works out what /playable reindex has to add and remove, by GUID
+#include "voiceEncoder.h"	//Opus encoding thread, feeding D++
+#include "workerPool.h"		//Threads shared by every guild's session, one strand each
+#include "tickTimer.h"		//Fixed-rate thread that queues every session's tick
+#include "mpscQueue.h"		//Lock-free queue carrying slash commands to their session's tick
+#include "folderWatcher.h"	//Notices banks being rebuilt, so sessions can swap them in
 
 using namespace trbdrUtils;
+using namespace trbdrAudio;
 
 
 //---Constants you might change---//
@@ -9,9 +23,33 @@ static const std::string masterBankFile = "Master.bank";			// The name of the Ma
 static const std::string masterStringsFile = "Master.strings.bank";	// The name of the Master Strings Bank file
 static const std::string soundbanksFolder = "soundbanks";			// The folder where the program's built FMOD Studio banks are located
 static const std::string soundfilesFolder = "soundfiles";			// The folder where loose sound files can be found and played.
+static const std::string studioIndexFile = "troubadour.index";		// Saved index of the banks, kept in the soundbanks folder and rebuilt whenever they change
+static const bool watchBanks = true;								// Reload banks as they're rebuilt, without a restart or /banks
+static const std::chrono::milliseconds bankWatchInterval(500);		// How often the soundbanks folder is checked for changes
+static const std::chrono::milliseconds bankWatchSettle(2000);		// How long it has to stay unchanged before banks are reloaded, so a build finishes first
+static const uint64_t bankMemoryBudgetMB = 512;						// Banks load when something in them is first played, and idle ones are unloaded once the loaded bank files add up to more than this on disk. 0 loads them all up front and keeps them
 static const std::string callableEventPrefix = "event:/Master/";	// The FMOD-internal path where our callable events exist
 static const float fmodMasterBusVolOffset = -10.0f;					// How much to pull down the Master Bus fader when running
-static const size_t sendAudioThresh = dpp::send_audio_raw_max_length / 2;		//How many PCM samples we need before sending them to DPP
+static const bool useHeadlessOutput = true;							// Mix straight to Discord with no audio device. If false, or if it fails, capture from the sound card's mix instead
+static const size_t captureBufferFrames = 50;						// How many 20ms frames of captured audio we hold before dropping (1 second)
+static const unsigned int fmodTickRateHz = 100;						// How often each session ticks, calling its Studio update()
+static const std::chrono::microseconds fmodUpdateInterval(1000000 / fmodTickRateHz);
+static const double maxDriftCorrectionPpm = 500.0;					// Most drift correction may speed up or slow down capture
+static const dropPolicy captureDropPolicy = dropPolicy::dropToLatest;	// What to throw away when audio backs up: dropOldest trims, dropToLatest jumps to live
+static const size_t maxQueuedFrames = 5;							// Captured frames allowed to wait for the encoder before the drop policy kicks in (100ms)
+static const uint32_t catchUpThresholdMs = 250;						// If D++ has more than this queued, flush it and restart from live audio
+static const double bitrateBackoffMs = 120.0;						// Lower the Opus bitrate and turn on FEC while D++ has more than this queued. 0 turns it off
+static const double bitrateRecoverMs = 80.0;						// Raise it again once D++ stays under this
+static const bool useOpusCache = true;								// Stream pre-encoded Opus when a single sound file is all that's playing
+static const std::chrono::milliseconds bankLoadPollInterval(2);	// How often loading banks are checked on while a session starts or /banks runs
+static const std::string opusCacheFolder = "opuscache";				// Where pre-encoded sound files are kept, next to the executable
+static const std::string opusProfilesFile = "opus.config";			// Optional Opus encoding profiles, added to or overriding the built-in ones
+static const std::string defaultOpusProfile = "balanced";			// Profile used at startup. Built in: lowcpu, balanced, lowlatency
+static const size_t maxGuildSessions = 7;							// Servers we'll play in at once. Each has its own FMOD system; FMOD allows 8, and the Opus cache uses one
+static const unsigned int sessionWorkerThreads = 0;					// Threads shared by every server's session. 0 is one per core
+static const std::string metricsFilePrefix = "metrics-";			// Latency reports, one per server (metrics-<guild id>.txt), rewritten next to the executable while running
+static const std::chrono::seconds metricsWriteInterval(10);			// How often the metrics file is rewritten
+static const std::chrono::seconds metricsWindow(60);				// Latency reports cover the last one to two of these
 static const dpp::embed basicEmbed = dpp::embed()					// Generic embed, to be duplicated from for each embed response
 	.set_color(dpp::colors::construction_cone_orange)
 	.set_timestamp(time(0));
@@ -30,96 +68,326 @@ static std::filesystem::path exePath;
 static std::filesystem::path banksDirPath;
 static std::filesystem::path soundsDirPath;
 
-//---FMOD Declarations---//
-static FMOD::Studio::System* pSystem = nullptr;						// FMOD Studio system
-static FMOD::System* pCoreSystem = nullptr;							// FMOD Core system
-static FMOD::Studio::Bus* pMasterBus = nullptr;						// Master bus
-static FMOD::ChannelGroup* pMasterBusGroup = nullptr;				// Channel Group of the master bus
-static FMOD::DSP* mCaptureDSP = nullptr;							// DSP to attach to Master Channel Group for stealing output
-static FMOD::ChannelGroup* pCoreGroup = nullptr;					// The group we'll route low-level playback through
+//---Guild Sessions---//
+
+// One bank being loaded, and how it went, for the load report.
+struct bankLoad {
+	std::filesystem::path path;
+	FMOD::Studio::Bank* bank = nullptr;
+	FMOD_RESULT result = FMOD_OK;									// From loadBankFile, or from the loading state once it's done
+	uintmax_t bytes = 0;
+	std::chrono::steady_clock::time_point finished;					// First poll that saw it done
+	double loadMs = 0.0;											// Since the bank loaded before it finished, as Studio loads one at a time
+	bool done = false;
+};
+
+// Everything one server's table needs: its own FMOD Studio system and mixer, what's loaded and playing in it,
+// and the capture and encoding path out to its voice channel. Every FMOD call and every change to the maps below
+// happens in a job on the session's strand, so only one thread is ever inside a session at a time.
+// The mixer thread only touches the capture path, which is built to be shared with it.
+struct guildSession {
+	explicit guildSession(dpp::snowflake guildId);
+
+	dpp::snowflake guildId;
+	strand jobs;													// Where all of this session's work runs
+	std::atomic<bool> ready = false;								// Set once FMOD is up and the banks are indexed
+	std::atomic<bool> tickPending = false;							// A tick is queued or running, so sessionTicker doesn't stack them up
+	mpscQueue<dpp::slashcommand_t> commands;						// Pushed from D++'s threads, applied together at the start of each tick
+	uint64_t commandsApplied = 0;									// Tick only
+	uint64_t largestCommandBatch = 0;								// ...
+	std::atomic<std::shared_ptr<const sessionSnapshot>> snapshot;	// Published by every tick, for /list and autocomplete on any thread
+	std::shared_ptr<const sessionCatalog> catalog;					// Tick only: the catalog in the last snapshot
+	bool catalogChanged = true;										// Set by anything that re-indexes, so the next tick rebuilds the catalog
+	uint64_t ticks = 0;												// Tick only
+
+	//---FMOD Declarations---//
+	FMOD::Studio::System* pSystem = nullptr;						// FMOD Studio system
+	FMOD::System* pCoreSystem = nullptr;							// FMOD Core system
+	FMOD::Studio::Bus* pMasterBus = nullptr;						// Master bus
+	FMOD::ChannelGroup* pMasterBusGroup = nullptr;					// Channel Group of the master bus
+	FMOD::DSP* mCaptureDSP = nullptr;								// DSP to attach to Master Channel Group for stealing output, when not headless
+	bool headlessActive = false;									// Whether FMOD is running on discordOutput (set once, during init)
+	int mixerRate = (int)frameSampleRate;							// What the mixer ended up running at (set once, during init)
+	FMOD::ChannelGroup* pCoreGroup = nullptr;						// The group we'll route low-level playback through
+
+	// Banks
+	FMOD::Studio::Bank* pMasterBank = nullptr;						// Master Bank, always loads first and contains shared content
+	FMOD::Studio::Bank* pMasterStringsBank = nullptr;				// Master Strings, allows us to refer to events by name instead of GUID
+	std::vector<std::filesystem::path> bankPaths;					// Vector of paths to the respective .bank files (at time of load)
+	std::vector<FMOD::Studio::Bank*> pBanks;						// Vector of all other banks
+	std::map<std::filesystem::path, FMOD::Studio::Bank*> bankFiles;	// Which file each of pBanks was loaded from, for hot reloading and residency
+	std::set<std::filesystem::path> pinnedBanks;					// Banks holding snapshots, which are never unloaded to save memory
+	std::map<std::filesystem::path, uint64_t> bankLastUsed;			// When each bank last had an event played or prefetched from it, counted in bankUses
+	uint64_t bankUses = 0;
+	uint64_t bankLoads = 0;											// Banks loaded because an event in them was needed
+	uint64_t bankEvictions = 0;										// Banks unloaded to get back under bankMemoryBudgetMB
+	studioIndexCache indexCache;									// The saved index, if it matched the banks
+	std::unordered_set<std::string> paramNames;						// Every parameter name our descriptions point at. FMOD's own go when their bank's unloaded
+
+	// Events
+	std::vector<std::string> eventPaths;							// Vector of FMOD-internal paths the user can call
+	std::map<std::string, sessionEventDesc> pEventDescriptions;		// Map of all Event Descriptions and their parameters (with Nice Names as keys)
+	std::map<std::string, sessionEventInstance> pEventInstances;	// Map of all Event Instances (with User-given names as keys)
+
+	// Busses
+	std::vector<std::string> busPaths;								// Vector of FMOD-internal paths to each bus
+	std::map <std::string, FMOD::Studio::Bus*> pBusses;				// Map of pointers to each bus object, by their path/name
+
+	// VCAs
+	std::vector<std::string> vcaPaths;								// Same as busses but for VCAs
+	std::map <std::string, FMOD::Studio::VCA*> pVCAs;				// ...
+
+	// Snapshots
+	std::vector<std::string> snapshotPaths;							// Same as events but for Snapshots
+	std::map<std::string, FMOD::Studio::EventDescription*> pSnapshotDescriptions;
+	std::map<std::string, FMOD::Studio::EventInstance*> pSnapshotInstances;
+
+	// Global Parameters
+	std::vector<std::string> globalParamNames;						// Similar but for Global Params (Local live with each event)
+	std::map<std::string, FMOD_STUDIO_PARAMETER_DESCRIPTION> globalParamDescriptions;
+
+	// Loose audio files
+	std::vector<std::string> soundPaths;							// Similar but for loose sound files
+	std::map<std::string, FMOD::Sound*> pSounds;					// Like Event Descriptions but created on-the-fly so users have playback options
+	std::map<std::string, sessionSoundInstance> pChannels;			// Like Event Instances, sorta
+	std::map<std::string, std::filesystem::path> soundFilePaths;	// Where each of pSounds was loaded from, for the Opus cache
+
+	//---Voice and Capture---//
+	dpp::discord_voice_client* currentClient = nullptr;				// This guild's Voice Client, if we're in a call here
+	dpp::discord_client* voiceShard = nullptr;						// Shard the call came in on, so shutdown can leave it
+	std::atomic<bool> isConnected = false;							// Set to "true" while anyone's listening, here or through a relay. Read from the mixer thread.
+	pcmFrameBuffer pcmFrames;										// Buffer of PCM audio frames, which FMOD fills and the encoder takes from
+	pipelineMetrics audioMetrics;									// Latency of each stage between FMOD and Discord
+	voiceEncoder opusEncoder;										// Takes frames from pcmFrames, encodes them, and sends them to currentClient and any relays
+	polyphaseResampler captureResampler;							// Converts to 48 kHz if needed, and corrects the mixer's clock drift
+	tickMetrics tickTiming;											// How late each tick started after its deadline, and how long it ran
+	headlessOutput discordOutput;									// Our FMOD output plugin, when headless
+	FMOD::Channel* cachedChannel = nullptr;							// Channel the encoder is streaming from soundCache for, if any
+	std::shared_ptr<const cachedOpusSound> cachedSound;				// ...and what it's streaming
+	int16_t resampleStaging[resamplerBlockFrames * frameChannels];	// Mixer thread's stereo PCM, on its way into captureResampler
+};
+
+static workerPool sessionWorkers;								// Threads every session's jobs run on
+static tickTimer sessionTicker;									// Queues a tick for every session, fmodTickRateHz times a second
+static folderWatcher bankWatcher;								// Queues a bank reload for every session when the soundbanks folder changes
+static std::mutex sessionsMutex;								// Guards the sessions and relays maps (not the sessions themselves)
+static std::map<dpp::snowflake, std::unique_ptr<guildSession>> sessions;	// One per server we've been used in, kept until exit
+
+// A voice channel playing another server's session through /broadcast, rather than one of its own.
+// The source session's encoder sends it the same packets as everyone else, so it costs no FMOD system and no extra encoding.
+struct sessionRelay {
+	dpp::snowflake sourceGuild;
+	dpp::discord_voice_client* client = nullptr;					// Once voice is ready
+	dpp::discord_client* shard = nullptr;							// ...and the shard it's on
+};
+static std::map<dpp::snowflake, sessionRelay> relays;			// By the guild listening
+static std::mutex deferredMutex;								// Guards deferredReplies
+static std::set<dpp::snowflake> deferredReplies;				// Commands answered with "Thinking..." while their session started, by interaction ID
+
+// Awaitable that runs "work" on a session's strand, then resumes the awaiting coroutine with its result on that pool thread.
+// Lets a command handler defer, hand its FMOD work to the session, and wait for it without holding a D++ thread.
+template <typename R>
+static dpp::async<R> onStrand(guildSession& session, std::function<R()> work) {
+	return dpp::async<R>{ [&session, work = std::move(work)](std::function<void(R)> done) {
+		sessionWorkers.post(session.jobs, [work, done] { done(work()); });
+	} };
+}
+
+// Replies to a command, or fills in its "Thinking..." message instead if it was deferred while its session started up.
+static void respond(const dpp::slashcommand_t& event, const dpp::message& message) {
+	bool deferred = false;
+	{
+		std::lock_guard<std::mutex> lock(deferredMutex);
+		deferred = (deferredReplies.erase(event.command.id) > 0);
+	}
+	if (deferred) { event.edit_original_response(message); }
+	else { event.reply(message); }
+}
 
-// Banks
-static FMOD::Studio::Bank* pMasterBank = nullptr;					// Master Bank, always loads first and contains shared content
-static FMOD::Studio::Bank* pMasterStringsBank = nullptr;			// Master Strings, allows us to refer to events by name instead of GUID
-static std::vector<std::filesystem::path> bankPaths;				// Vector of paths to the respective .bank files (at time of load)
-static std::vector<FMOD::Studio::Bank*> pBanks;						// Vector of all other banks
+// Answers with "Thinking..." for a command that won't get to its reply within Discord's 3 seconds, so respond() fills that in later.
+static dpp::task<void> deferReply(dpp::slashcommand_t event) {
+	{
+		std::lock_guard<std::mutex> lock(deferredMutex);
+		deferredReplies.insert(event.command.id);
+	}
+	co_await event.co_thinking(true);
+}
 
-// Events
-static std::vector<std::string> eventPaths;							// Vector of FMOD-internal paths the user can call
-static std::map<std::string, sessionEventDesc> pEventDescriptions;	// Map of all Event Descriptions and their parameters (with Nice Names as keys)
-static std::map<std::string, sessionEventInstance> pEventInstances;	// Map of all Event Instances (with User-given names as keys)
 
-// Busses
-static std::vector<std::string> busPaths;							// Vector of FMOD-internal paths to each bus
-static std::map <std::string, FMOD::Studio::Bus*> pBusses;			// Map of pointers to each bus object, by their path/name
+//---Misc Bot Declarations---//
+static dpp::application botapp;									// Application object of the bot. Defined from a callback during startup
+static std::vector<opusProfile> opusProfiles;					// Encoding profiles /opus can switch between
+static opusCache soundCache;									// Pre-encoded loose sound files, shared by every session
+static std::atomic<bool> exitRequested = false;					// Set to "true" when you want off Mr. Bones Wild Tunes.
+static std::set<dpp::snowflake> authorizedUsers;				// Whitelisted users, including Owner.
 
-// VCAs
-static std::vector<std::string> vcaPaths;							// Same as busses but for VCAs
-static std::map <std::string, FMOD::Studio::VCA*> pVCAs;			// ...
 
-// Snapshots
-static std::vector<std::string> snapshotPaths;						// Same as events but for Snapshots
-static std::map<std::string, FMOD::Studio::EventDescription*> pSnapshotDescriptions;
-static std::map<std::string, FMOD::Studio::EventInstance*> pSnapshotInstances;
 
-// Global Parameters
-static std::vector<std::string> globalParamNames;					// Similar but for Global Params (Local live with each event)
-static std::map<std::string, FMOD_STUDIO_PARAMETER_DESCRIPTION> globalParamDescriptions;
+//---FMOD and Audio Functions---//
 
-// Loose audio files
-static std::vector<std::string> soundPaths;							// Similar but for loose sound files
-static std::map<std::string, FMOD::Sound*> pSounds;					// Like Event Descriptions but created on-the-fly so users have playback options
-static std::map<std::string, sessionSoundInstance> pChannels;		// Like Event Instances, sorta
+// Converts a block of mixer output, whatever its channel count, to stereo 16-bit PCM
+static void captureToPCMStereo(const float* in, int inchannels, int16_t* out, unsigned int count) {
+	if (inchannels == 1) { floatMonoToPCMStereo(in, out, count); }					//Twice, because D++ expects stereo input
+	else if (inchannels == 2) { floatStereoToPCM(in, out, count); }
+	else { downmixToPCMStereo(in, inchannels, out, count); }
+}
 
+// Feeds one block of mixer output into the frame buffer. Shared by the headless output and the capture DSP,
+// and runs on whichever thread is mixing: no allocating, no locking, no printing.
+static void captureMixBlock(guildSession& session, const float* inbuffer, unsigned int length, int inchannels, uint64_t mixClock) {
+	if (!session.isConnected) { return; }
 
-//---Misc Bot Declarations---//
-static dpp::application botapp;									// Application object of the bot. Defined from a callback during startup
-static dpp::discord_voice_client* currentClient = nullptr;		// Current Voice Client of the bot. Only designed to run on one server
-static std::vector<int16_t> pcmDataBuffer;						// Our buffer of PCM audio data, which FMOD adds to and D++ cuts "frames" from
-static bool exitRequested = false;								// Set to "true" when you want off Mr. Bones Wild Tunes.
-static bool isConnected = false;								// Set to "true" when bot is connected to a Voice Channel.
-static std::set<dpp::snowflake> authorizedUsers;				// Whitelisted users, including Owner.
+	// Stamp frames starting in this block, for the latency metrics and for lining up cached packets
+	uint64_t clock = (session.mixerRate == (int)frameSampleRate) ? mixClock : mixClock * frameSampleRate / (uint64_t)session.mixerRate;
+	session.pcmFrames.stampCapture(clock, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
 
+	// Convert in chunks and let the resampler fill the frame buffer (always, unless it's failed to configure)
+	if (session.captureResampler.isActive()) {
+		unsigned int samp = 0;
+		while (samp < length) {
+			unsigned int count = std::min(length - samp, (unsigned int)resamplerBlockFrames);
+			captureToPCMStereo(inbuffer + (samp * inchannels), inchannels, session.resampleStaging, count);
+			session.captureResampler.process(session.resampleStaging, count, session.pcmFrames);
+			samp += count;
+		}
+		return;
+	}
+
+	// Write straight into the frame buffer, which may take a few frames' worth of writes to fit the block
+	unsigned int samp = 0;
+	while (samp < length) {
+		size_t samplesFree = 0;
+		int16_t* out = session.pcmFrames.writePtr(samplesFree);
+		unsigned int count = std::min(length - samp, (unsigned int)(samplesFree / frameChannels));
+		captureToPCMStereo(inbuffer + (samp * inchannels), inchannels, out, count);
+		session.pcmFrames.commitWrite(count * frameChannels);
+		samp += count;
+	}
+}
 
+// Callback for each block the headless output pulls from FMOD's mixer. Always 48kHz stereo.
+static void headlessMixCallback(const float* samples, unsigned int frames, int channels, uint64_t mixClock, void* userdata) {
+	captureMixBlock(*(guildSession*)userdata, samples, frames, channels, mixClock);
+}
 
-//---FMOD and Audio Functions---//
+// Lives down here as the output plugin needs the callback above.
+guildSession::guildSession(dpp::snowflake guildId) : guildId(guildId), pcmFrames(captureBufferFrames),
+	opusEncoder(pcmFrames, audioMetrics, bitrateBackoffMs, bitrateRecoverMs),
+	discordOutput(headlessMixCallback, this) {}
 
-// Callback for stealing sample data from the Master Bus
+// Callback for stealing sample data from the Master Bus. Only used if the headless output couldn't be set up.
 static FMOD_RESULT F_CALL captureDSPReadCallback(FMOD_DSP_STATE* dsp_state, float* inbuffer,
 	float* outbuffer, unsigned int length, int inchannels, int* outchannels) {
 
-	if (isConnected) {
-		switch (inchannels) {
-			case 1:																				//Mono Input
-				if (*outchannels == 1) {
-					for (unsigned int samp = 0; samp < length; samp++) {
-						outbuffer[(samp * *outchannels)] = 0.0f;										//Brute force mutes system output
-						pcmDataBuffer.push_back(floatToPCM(inbuffer[samp]));					//Adds sample to PCM buffer...
-						pcmDataBuffer.push_back(floatToPCM(inbuffer[samp]));					//...twice, because D++ expects stereo input
-					}
-				}
-				else {
-					std::cout << "Capture DSP Read Error: Mono in, but not mono out!" << std::endl;
-				}
-				break;
-
-			case 2:																				//Stereo Input
-				for (unsigned int samp = 0; samp < length; samp++) {
-					for (int chan = 0; chan < *outchannels; chan++) {
-						pcmDataBuffer.push_back(floatToPCM(inbuffer[(samp * inchannels) + chan]));			//Adds sample to PCM buffer in approprate channel
-					}
-				}
-				break;
+	switch (inchannels) {
+		case 1:																				//Mono Input
+			if (*outchannels != 1) { return FMOD_ERR_DSP_DONTPROCESS; }
+			break;
+		case 2:																				//Stereo Input
+			break;
+		default:																			//Quad, 5.1 and 7.1 Input, downmixed to stereo
+			if (!canDownmixToStereo(inchannels)) { return FMOD_ERR_DSP_DONTPROCESS; }
+			break;
+	}
+
+	unsigned long long dspClock = 0;
+	unsigned int clockOffset = 0, clockLength = 0;
+	dsp_state->functions->getclock(dsp_state, &dspClock, &clockOffset, &clockLength);
+	void* session = nullptr;
+	dsp_state->functions->getuserdata(dsp_state, &session);			// Set in the DSP description, in initFMOD()
+	captureMixBlock(*(guildSession*)session, inbuffer, length, inchannels, dspClock);
+	return FMOD_ERR_DSP_SILENCE;		//ensures System output is silent without manually telling every sample to be 0.0f
+}
 
-			//Add cases here for other input channel configurations. Ultimately, all must mix down to stereo.
+// True if nothing on the way from this channel to the output changes the sound beyond its volume.
+// Faders are fine (the gain is baked into the cache), and so is our capture DSP, which only listens.
+static bool isPlainGainPath(guildSession& session, FMOD::ChannelControl* control) {
+	int numDSPs = 0;
+	if (control->getNumDSPs(&numDSPs) != FMOD_OK) { return false; }
+	for (int i = 0; i < numDSPs; i++) {
+		FMOD::DSP* dsp = nullptr;
+		FMOD_DSP_TYPE type = FMOD_DSP_TYPE_UNKNOWN;
+		bool bypassed = false;
+		if (control->getDSP(i, &dsp) != FMOD_OK) { return false; }
+		if (dsp == session.mCaptureDSP) { continue; }
+		dsp->getBypass(&bypassed);
+		dsp->getType(&type);
+		if (!bypassed && type != FMOD_DSP_TYPE_FADER) { return false; }
+	}
+	return true;
+}
 
-			default:
-				std::cout << "Capture DSP Read needs mono or stereo in and out!" << std::endl;
-				return FMOD_ERR_DSP_DONTPROCESS;
-				break;
+// Reads a channel's position along with the DSP clock it was at, in 48 kHz samples like the captured frames' clocks.
+// The mixer can move on between the two reads, so the clock's read either side and it tries again if it did.
+static bool channelPositionAt(guildSession& session, FMOD::Channel* channel, unsigned int& position, uint64_t& clock) {
+	for (int attempt = 0; attempt < 3; attempt++) {
+		unsigned long long before = 0, after = 0;
+		if (channel->getDSPClock(&before, nullptr) != FMOD_OK) { return false; }
+		if (channel->getPosition(&position, FMOD_TIMEUNIT_PCM) != FMOD_OK) { return false; }
+		if (channel->getDSPClock(&after, nullptr) != FMOD_OK) { return false; }
+		if (before == after) {
+			clock = (uint64_t)after * frameSampleRate / (uint64_t)session.mixerRate;
+			return true;
 		}
 	}
-	return FMOD_ERR_DSP_SILENCE;		//ensures System output is silent without manually telling every sample to be 0.0f
+	return false;
+}
+
+// Swaps the encoder over to pre-encoded packets while a single loose sound file is the only thing playing,
+// untouched but for volume, and back to the live mix the moment that stops being true. Run from the session's tick.
+// FMOD keeps mixing throughout, so the live mix is always there to switch back to without a gap.
+// Packets are built in the encoder's current format, so they can stand in for what it would have sent.
+static void updateOpusCache(guildSession& session) {
+	FMOD::Channel* channel = nullptr;
+	std::shared_ptr<const cachedOpusSound> sound;
+	unsigned int position = 0;
+	uint64_t clock = 0;
+	float rate = 0.0f;
+
+	int channelsPlaying = 0;
+	session.pCoreSystem->getChannelsPlaying(&channelsPlaying, nullptr);
+	if (session.isConnected && session.pEventInstances.empty() && session.pSnapshotInstances.empty() && session.pChannels.size() == 1 && channelsPlaying == 1) {
+		const sessionSoundInstance& solo = session.pChannels.begin()->second;
+		FMOD::Sound* fmodSound = nullptr;
+		bool paused = true;
+		float pitch = 0.0f, frequency = 0.0f, gain = 0.0f;
+		solo.channel->getPaused(&paused);
+		solo.channel->getPitch(&pitch);
+		solo.channel->getFrequency(&frequency);
+		solo.channel->getAudibility(&gain);			// Channel volume times every parent group's, i.e. what the cache needs baked in
+		solo.channel->getCurrentSound(&fmodSound);
+		if (fmodSound != nullptr) { fmodSound->getDefaults(&rate, nullptr); }
+
+		bool plain = !paused && pitch == 1.0f && rate > 0.0f && frequency == rate && session.soundFilePaths.contains(solo.soundNiceName)
+			&& isPlainGainPath(session, solo.channel);
+		for (FMOD::ChannelGroup* group = session.pCoreGroup; plain && group != nullptr; ) {
+			plain = isPlainGainPath(session, group);
+			FMOD::ChannelGroup* parent = nullptr;
+			group->getParentGroup(&parent);
+			group = parent;
+		}
+
+		if (plain && channelPositionAt(session, solo.channel, position, clock)) {
+			sound = soundCache.find(session.soundFilePaths.at(solo.soundNiceName), gain, session.opusEncoder.cacheFormat());	// Queues a build the first time
+			channel = solo.channel;
+		}
+	}
+
+	if (sound == nullptr) {
+		if (session.cachedSound != nullptr) { session.opusEncoder.setCachedSource(nullptr, 0); }
+		session.cachedChannel = nullptr;
+		session.cachedSound = nullptr;
+		return;
+	}
+
+	// Anchor afresh for a new channel or sound, or when the encoder has fallen back to live (say, a loop went round)
+	if (channel != session.cachedChannel || sound != session.cachedSound || !session.opusEncoder.isStreamingCached()) {
+		int64_t positionSamples = (int64_t)((double)position * frameSampleRate / rate);
+		session.opusEncoder.setCachedSource(sound, (int64_t)clock - positionSamples);
+
+		session.cachedChannel = channel;
+		session.cachedSound = sound;
+	}
 }
 
 // Callback that triggers when an Event Instance is released
@@ -137,20 +405,26 @@ static FMOD_RESULT F_CALL eventInstanceDestroyedCallback(FMOD_STUDIO_EVENT_CALLB
 		bool isSnapshot = false;
 		myEventDesc->isSnapshot(&isSnapshot);
 
+		// Each Instance carries the session it was started in
+		guildSession* owner = nullptr;
+		myEvent->getUserData((void**)&owner);
+		if (owner == nullptr) { return FMOD_OK; }
+		guildSession& session = *owner;
+
 		// Iterate through the respective Instance map and erase the entry associated with this Instance.
 		if (!isSnapshot) {		// Event
-			for (const auto& [niceName, sessionEventInstance] : pEventInstances) {
+			for (const auto& [niceName, sessionEventInstance] : session.pEventInstances) {
 				if (myEvent == sessionEventInstance.instance) {
 					std::cout << "Event Instance destroyed, erasing key from pEventInstances: " << niceName << std::endl;
-					pEventInstances.erase(niceName);
+					session.pEventInstances.erase(niceName);
 				}
 			}
 		}
 		else {					// Snapshot
-			for (const auto& [niceName, snapshotInstance] : pSnapshotInstances) {
+			for (const auto& [niceName, snapshotInstance] : session.pSnapshotInstances) {
 				if (myEvent == snapshotInstance) {
 					std::cout << "Snapshot destroyed, erasing key from pSnapshotInstances: " << niceName << std::endl;
-					pSnapshotInstances.erase(niceName);
+					session.pSnapshotInstances.erase(niceName);
 				}
 			}
 		}
@@ -178,6 +452,12 @@ static FMOD_RESULT F_CALL soundChannelControlCallback(FMOD_CHANNELCONTROL *chann
 			" This is definitely a bug of some kind." << std::endl;
 	}
 
+	// Channels carry the session they were started in
+	guildSession* owner = nullptr;
+	((FMOD::ChannelControl*)channelcontrol)->getUserData((void**)&owner);
+	if (owner == nullptr) { return FMOD_OK; }
+	guildSession& session = *owner;
+
 	//Only one callback allowed per-sound, so filter here depending on callback type
 	switch (callbacktype) {
 	// This case should only work if the callbackObj is a Channel (not Channel Group)
@@ -191,9 +471,9 @@ static FMOD_RESULT F_CALL soundChannelControlCallback(FMOD_CHANNELCONTROL *chann
 			// so just remove it from our list (if found with reverse search).
 			// Also don't release Sounds, that'll unload the file itself.
 
-			for (auto it = pChannels.begin(); it != pChannels.end(); ++it) {
+			for (auto it = session.pChannels.begin(); it != session.pChannels.end(); ++it) {
 				if (it->second.channel == callbackObj.channel) {
-					pChannels.erase(it->first);
+					session.pChannels.erase(it->first);
 				}
 			}
 		}
@@ -209,10 +489,115 @@ static FMOD_RESULT F_CALL soundChannelControlCallback(FMOD_CHANNELCONTROL *chann
 
 // Simple ping, responds in chat and output log
 static void ping(const dpp::slashcommand_t& event) {
-	event.reply(dpp::message("Pong! I'm alive!").set_flags(dpp::m_ephemeral));
+	respond(event, dpp::message("Pong! I'm alive!").set_flags(dpp::m_ephemeral));
 	std::cout << "Responding to Ping command." << std::endl;
 }
 
+// One line per voice connection the session is sending to, with how far behind its D++ queue is and what's been flushed from it
+static std::string describeDestinations(guildSession& session) {
+	std::string output;
+	for (const voiceDestinationStats& ds : session.opusEncoder.destinationStats()) {
+		output += (ds.serverId == (uint64_t)session.guildId ? "Here" : "Relay to " + std::to_string(ds.serverId)) + ": "
+			+ std::to_string(ds.packetsSent) + " packets, " + std::to_string((int)ds.queuedMs) + "ms queued (max "
+			+ std::to_string((int)ds.maxQueuedMs) + "ms), " + std::to_string(ds.framesFlushed) + " frames flushed in "
+			+ std::to_string(ds.flushes) + " flushes, " + std::to_string(ds.sendErrors) + " send errors\n";
+	}
+	return output;
+}
+
+// One line on how punctual a run of ticks has been
+static std::string describeTicks(const tickStats& ts) {
+	return std::to_string(ts.ticks) + " ticks, " + std::to_string(ts.skipped) + " skipped, started "
+		+ std::to_string(ts.averageJitterUs) + "us late on average / " + std::to_string(ts.maxJitterUs) + "us max, ran "
+		+ std::to_string(ts.averageDurationUs) + "us on average / " + std::to_string(ts.maxDurationUs) + "us max";
+}
+
+// The size on disk of every loaded bank file, which is what bankMemoryBudgetMB is measured in. Studio only counts its
+// own memory in the logging libraries, and FMOD's allocator counts every session in the process together, so neither
+// can tell one session when to unload. Sample data's the bulk of a bank, so this tracks it closely enough.
+static uint64_t loadedBankBytes(guildSession& session) {
+	uint64_t bytes = 0;
+	for (const auto& [path, bank] : session.bankFiles) {
+		std::error_code sizeError;
+		uintmax_t size = std::filesystem::file_size(path, sizeError);
+		if (!sizeError) { bytes += size; }
+	}
+	return bytes;
+}
+
+// Loaded banks, on-demand loads and evictions, and their size against the budget, for /metrics. Alongside, what FMOD
+// has actually allocated: Studio's count for this session when the logging libraries keep one, and the whole process's.
+static std::string describeBanks(guildSession& session) {
+	std::string out = "Banks: " + std::to_string(session.bankFiles.size()) + " loaded (" + std::to_string(session.pinnedBanks.size()) + " pinned), "
+		+ std::to_string(session.bankLoads) + " loaded on demand, " + std::to_string(session.bankEvictions) + " unloaded, "
+		+ std::to_string(loadedBankBytes(session) / (1024 * 1024)) + " MB on disk";
+	if (bankMemoryBudgetMB > 0) { out += " of " + std::to_string(bankMemoryBudgetMB) + " MB"; }
+
+	FMOD_STUDIO_MEMORY_USAGE usage = {};
+	if (session.pSystem->getMemoryUsage(&usage) == FMOD_OK && usage.inclusive > 0) {
+		out += "\nFMOD memory: " + std::to_string(usage.inclusive / (1024 * 1024)) + " MB in this session";
+	}
+	int current = 0;
+	int peak = 0;
+	if (FMOD::Memory_GetStats(&current, &peak, false) == FMOD_OK) {
+		out += (usage.inclusive > 0 ? ", " : "\nFMOD memory: ") + std::to_string(current / (1024 * 1024)) + " MB in every session ("
+			+ std::to_string(peak / (1024 * 1024)) + " MB peak)";
+	}
+	return out + "\n";
+}
+
+// How much to speed up (or, negative, slow down) capture to cancel the mixer clock's measured drift.
+// Nothing until there's been enough audio to measure it.
+static double driftCorrectionPpm(guildSession& session) {
+	return std::clamp(session.audioMetrics.clockDriftPpm(), -maxDriftCorrectionPpm, maxDriftCorrectionPpm);
+}
+
+// Shows how long audio is taking to get from FMOD to Discord, stage by stage
+static void metrics(guildSession& session, const dpp::slashcommand_t& event) {
+	respond(event, dpp::message("Audio latency, last " + std::to_string(metricsWindow.count()) + "-"
+		+ std::to_string(metricsWindow.count() * 2) + " seconds:\n```\n" + session.audioMetrics.report()
+		+ "Drift correction: " + std::to_string((int)std::lround(driftCorrectionPpm(session))) + " ppm\n"
+		+ describeDestinations(session) + describeBanks(session) + "Session at " + std::to_string(fmodTickRateHz) + " Hz: " + describeTicks(session.tickTiming.stats())
+		+ "\nTimer: " + describeTicks(sessionTicker.stats()) + "\n```").set_flags(dpp::m_ephemeral));
+	std::cout << "Responding to Metrics command." << std::endl;
+}
+
+// Lists the Opus encoding profiles and the CPU each has cost so far, or switches to one
+static void opus(guildSession& session, const dpp::slashcommand_t& event) {
+	dpp::command_interaction cmd_data = event.command.get_command_interaction();
+
+	if (!cmd_data.options.empty()) {
+		std::string name = std::get<std::string>(event.get_parameter("profile"));
+		const opusProfile* profile = findOpusProfile(opusProfiles, name);
+		if (profile == nullptr) {
+			respond(event, dpp::message("No Opus profile called " + name + ".").set_flags(dpp::m_ephemeral));
+			return;
+		}
+		session.opusEncoder.setProfile(*profile);
+		respond(event, dpp::message("Switching to Opus profile " + describeOpusProfile(*profile)).set_flags(dpp::m_ephemeral));
+		std::cout << "Switching to Opus profile " << name << "." << std::endl;
+		return;
+	}
+
+	std::string current = session.opusEncoder.profileName();
+	std::vector<profileEncodeStats> measured = session.opusEncoder.profileStats();
+	std::string output = "Opus profiles:\n```\n";
+	for (const opusProfile& profile : opusProfiles) {
+		output += (profile.name == current ? "* " : "  ") + describeOpusProfile(profile) + "\n";
+		for (const profileEncodeStats& ps : measured) {
+			if (ps.name == profile.name) {
+				output += "    " + std::to_string(ps.cpuPercent) + "% of a core encoding, over " + std::to_string(ps.audioMs / 1000) + "s of audio\n";
+			}
+		}
+	}
+	bitrateAdapterStats bs = session.opusEncoder.bitrateStats();
+	output += "Adaptive bitrate: " + std::to_string(bs.bitrate / 1000) + " of " + std::to_string(bs.baseBitrate / 1000) + " kbps, FEC "
+		+ (bs.fec ? "on" : "off") + ", stepped down " + std::to_string(bs.stepDowns) + " and up " + std::to_string(bs.stepUps) + " times\n";
+	output += "```";
+	respond(event, dpp::message(output).set_flags(dpp::m_ephemeral));
+	std::cout << "Responding to Opus command." << std::endl;
+}
+
 // Simple Help function, meant to list all commands. Must be manually updated.
 static void help(const dpp::slashcommand_t& event) {
 
@@ -224,7 +609,7 @@ static void help(const dpp::slashcommand_t& event) {
 	unsigned int count = (unsigned int)cmd_data.options.size();
 	if (count > 2) {
 		std::cout << "Help command arrived with too many arguments. Bad juju!" << std::endl;
-		event.reply(dpp::message("Help command sent with too many arguments. That shouldn't happen.").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Help command sent with too many arguments. That shouldn't happen.").set_flags(dpp::m_ephemeral));
 		return;
 	}
 
@@ -248,17 +633,19 @@ static void help(const dpp::slashcommand_t& event) {
 		.add_field("/banks", "List all banks in the Soundbanks folder.")
 		.add_field("/join", "Join your current voice channel.")
 		.add_field("/leave", "Leave the current voice channel.")
+		.add_field("/broadcast", "Play another server's session in your voice channel here. /leave stops it.")
 		.add_field("/user", "List, Add, or Remove user permissions.")
 		.add_field("/quit", "Leave voice and exit the program.")
+		.add_field("/metrics", "Show how long audio is taking to reach Discord, stage by stage.")
+		.add_field("/opus", "List Opus encoding profiles and what they cost, or switch to one.")
 		.add_field("/help", "Show this message again!");
 
-	if (isPublic) { event.reply(dpp::message(helpEmbed)); }
-	else { event.reply(dpp::message(helpEmbed).set_flags(dpp::m_ephemeral)); }
+	if (isPublic) { respond(event, dpp::message(helpEmbed)); }
+	else { respond(event, dpp::message(helpEmbed).set_flags(dpp::m_ephemeral)); }
 }
 
-// Base function, called on startup and when requested by List Banks command
-static void banks() {
-
+// Finds every additional .bank file in the soundbanks folder, and adds them to bankPaths in sorted order.
+static void findBanks(guildSession& session) {
 	std::cout << "Checking Banks path: " << banksDirPath.string() << "\n";
 
 	std::set<std::filesystem::path> sortedOutput;
@@ -286,37 +673,236 @@ static void banks() {
 	// Now, for each key pass to the bank Paths vector
 	// We do this to automatically sort, by virtue of how std::set works
 	for (auto & key : sortedOutput) {
-		bankPaths.push_back(key);
+		session.bankPaths.push_back(key);
 	}
 
 	std::cout << std::endl;
+}
 
-	//Get list of already loaded banks
-	int count = 0;
-	errorCheckFMODHard(pSystem->getBankCount(&count));
-	std::vector<FMOD::Studio::Bank*> loadedBanks; loadedBanks.resize(count);
-	int writtenCount = 0;
-	errorCheckFMODHard(pSystem->getBankList(loadedBanks.data(), count, &writtenCount));
-
-	std::cout << "Loading Banks...\n";
-
-	// For every accepted bank path, add to output list, and attempt to load
-	for (int i = 0; i < (int)bankPaths.size(); i++) {					// For every accepted bank path
+// Starts loading every bank at once with FMOD_STUDIO_LOAD_BANK_NONBLOCKING, then polls them all in one pass until each
+// has finished, so the files load back to back on Studio's loading thread instead of one blocking call at a time.
+// Prints how long each took and how big it is. Results come back in the same order as the paths.
+static std::vector<bankLoad> loadBanks(guildSession& session, const std::vector<std::filesystem::path>& paths) {
+	auto started = std::chrono::steady_clock::now();
+	std::vector<bankLoad> loads(paths.size());
+	for (size_t i = 0; i < paths.size(); i++) {
+		bankLoad& load = loads[i];
+		load.path = paths[i];
+		std::error_code sizeError;
+		load.bytes = std::filesystem::file_size(load.path, sizeError);
+		if (sizeError) { load.bytes = 0; }
+		load.result = session.pSystem->loadBankFile(load.path.string().c_str(), FMOD_STUDIO_LOAD_BANK_NONBLOCKING, &load.bank);
+		load.done = (load.result != FMOD_OK);		// Failed straight away, e.g. already loaded or not there
+		load.finished = started;
+	}
+
+	// Loads are only handed to Studio on update(), so keep updating while we wait
+	size_t pending = 0;
+	do {
+		errorCheckFMODHard(session.pSystem->update());
+		pending = 0;
+		for (bankLoad& load : loads) {
+			if (load.done) { continue; }
+			FMOD_STUDIO_LOADING_STATE state = FMOD_STUDIO_LOADING_STATE_LOADING;
+			FMOD_RESULT result = load.bank->getLoadingState(&state);		// Returns the load's error if it failed
+			if (result != FMOD_OK || state == FMOD_STUDIO_LOADING_STATE_LOADED || state == FMOD_STUDIO_LOADING_STATE_ERROR) {
+				load.result = (state == FMOD_STUDIO_LOADING_STATE_ERROR && result == FMOD_OK) ? FMOD_ERR_FILE_BAD : result;
+				load.done = true;
+				load.finished = std::chrono::steady_clock::now();
+			}
+			else { pending++; }
+		}
+		if (pending > 0) { std::this_thread::sleep_for(bankLoadPollInterval); }
+	} while (pending > 0);
+
+	// Studio's loading thread takes the banks one after another, so each one's time is from when the one before it
+	// finished. Only as fine as the poll interval: banks finishing in the same poll share it, and the first takes it all.
+	std::vector<size_t> finishOrder(loads.size());
+	for (size_t i = 0; i < loads.size(); i++) { finishOrder[i] = i; }
+	std::stable_sort(finishOrder.begin(), finishOrder.end(), [&loads](size_t a, size_t b) { return loads[a].finished < loads[b].finished; });
+	std::chrono::steady_clock::time_point previous = started;
+	for (size_t i : finishOrder) {
+		loads[i].loadMs = std::chrono::duration<double, std::milli>(loads[i].finished - previous).count();
+		previous = loads[i].finished;
+	}
+
+	// Startup report
+	double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+	uintmax_t totalBytes = 0;
+	for (const bankLoad& load : loads) { totalBytes += load.bytes; }
+	std::cout << "Bank load report: " << loads.size() << " banks, " << totalBytes / 1024 << " KB in " << (int)wallMs << "ms\n";
+	for (const bankLoad& load : loads) {
+		std::cout << "   " << load.path.filename().string() << ": " << load.bytes / 1024 << " KB, ";
+		if (load.result == FMOD_OK) { std::cout << (int)load.loadMs << "ms\n"; }
+		else { std::cout << FMOD_ErrorString(load.result) << "\n"; }
+	}
+	std::cout << std::endl;
+	return loads;
+}
 
-		FMOD::Studio::Bank* newBank = nullptr;						// Load, if bank qualifies
-		FMOD_RESULT result = pSystem->loadBankFile(bankPaths[i].string().c_str(), FMOD_STUDIO_LOAD_BANK_NORMAL, &newBank);
-		if (result == FMOD_OK) {
-			pBanks.push_back(newBank);
-			std::cout << "   Loaded: " << bankPaths[i].string() << "\n";
+// Keeps the additional banks that loaded, from "first" on. One that's already loaded is fine, and one that failed
+// is logged and left out, so a single bad bank can't take down every session in the process.
+static void adoptBanks(guildSession& session, const std::vector<bankLoad>& loads, size_t first) {
+	for (size_t i = first; i < loads.size(); i++) {
+		if (loads[i].result == FMOD_OK) {
+			session.pBanks.push_back(loads[i].bank);
+			session.bankFiles[loads[i].path] = loads[i].bank;
+			std::cout << "   Loaded: " << loads[i].path.string() << "\n";
 		}
-		else if (result == FMOD_ERR_EVENT_ALREADY_LOADED) {
-			std::cout << "   Skipped Load (bank already loaded in FMOD Studio): " << bankPaths[i].string() << "\n";
+		else if (loads[i].result == FMOD_ERR_EVENT_ALREADY_LOADED) {
+			std::cout << "   Skipped Load (bank already loaded in FMOD Studio): " << loads[i].path.string() << "\n";
 		}
 		else {
-			errorCheckFMODHard(result);
+			std::cout << "   Couldn't load " << loads[i].path.string() << ": " << FMOD_ErrorString(loads[i].result) << "\n";
 		}
+
 	}
 	std::cout << std::endl;
+}
+
+// Points a parameter's name at the session's own copy. FMOD's points into the bank (or the saved index) it was read from,
+// and banks get unloaded while their events stay indexed.
+static void ownParamName(guildSession& session, FMOD_STUDIO_PARAMETER_DESCRIPTION& param) {
+	param.name = session.paramNames.insert(param.name).first->c_str();		// Set nodes never move, so the pointer holds
+}
+
+// The parameters of an event a user can set: not built-in, and not read-only.
+static std::vector<FMOD_STUDIO_PARAMETER_DESCRIPTION> userParams(guildSession& session, FMOD::Studio::EventDescription* description) {
+	std::vector<FMOD_STUDIO_PARAMETER_DESCRIPTION> params;
+	int count = 0;
+	description->getParameterDescriptionCount(&count);
+	for (int i = 0; i < count; i++) {
+		FMOD_STUDIO_PARAMETER_DESCRIPTION parameter;
+		description->getParameterDescriptionByIndex(i, &parameter);
+		if (parameter.type == FMOD_STUDIO_PARAMETER_GAME_CONTROLLED && ((parameter.flags % 2) != 1)) {
+			ownParamName(session, parameter);
+			params.push_back(parameter);
+		}
+	}
+	return params;
+}
+
+// Every Event Description (and Snapshot) a bank holds.
+static std::vector<FMOD::Studio::EventDescription*> bankEvents(FMOD::Studio::Bank* bank) {
+	int count = 0;
+	bank->getEventCount(&count);
+	std::vector<FMOD::Studio::EventDescription*> descriptions(count);
+	if (count > 0) { bank->getEventList(descriptions.data(), count, &count); }
+	descriptions.resize(std::max(count, 0));
+	return descriptions;
+}
+
+// Unloads a bank that nothing's playing from. Its events stay in the catalog, and are looked up by GUID again once it's back.
+static void evictBank(guildSession& session, const std::filesystem::path& path) {
+	FMOD::Studio::Bank* bank = session.bankFiles.at(path);
+	std::string file = path.filename().string();
+	for (auto& [name, desc] : session.pEventDescriptions) {
+		if (desc.bankFile == file) { desc.description = nullptr; }
+	}
+	errorCheckFMODSoft(bank->unload());
+	errorCheckFMODSoft(session.pSystem->flushCommands());		// So /metrics' memory count reflects it
+	std::erase(session.pBanks, bank);
+	session.bankFiles.erase(path);
+	session.bankEvictions++;
+	std::cout << "Unloaded bank " << file << ", least recently used." << std::endl;
+}
+
+// While the loaded banks are over bankMemoryBudgetMB, unloads the least recently used bank that isn't pinned, isn't "keep",
+// and has nothing playing from it. Stops early if everything left is in use.
+static void enforceBankBudget(guildSession& session, const std::filesystem::path& keep = {}) {
+	if (bankMemoryBudgetMB == 0) { return; }
+	const uint64_t budget = bankMemoryBudgetMB * 1024 * 1024;
+
+	std::set<std::string> busy;
+	for (const auto& [name, instance] : session.pEventInstances) {
+		auto desc = session.pEventDescriptions.find(instance.sourceEvent);
+		if (desc != session.pEventDescriptions.end()) { busy.insert(desc->second.bankFile); }
+	}
+
+	while (loadedBankBytes(session) > budget) {
+		const std::filesystem::path* oldest = nullptr;
+		uint64_t oldestUse = UINT64_MAX;
+		for (const auto& [path, bank] : session.bankFiles) {
+			if (path == keep || session.pinnedBanks.contains(path) || busy.contains(path.filename().string())) { continue; }
+			auto used = session.bankLastUsed.find(path);
+			uint64_t lastUse = (used != session.bankLastUsed.end()) ? used->second : 0;
+			if (lastUse < oldestUse) { oldest = &path; oldestUse = lastUse; }
+		}
+		if (oldest == nullptr) { break; }
+		evictBank(session, std::filesystem::path(*oldest));
+	}
+}
+
+// Makes sure the bank an event lives in is loaded, loading it and its sample data if it's never been needed or was
+// unloaded, then marks it as just used. Returns false if it couldn't be loaded. Holds up the strand while it loads,
+// so it's kept out of ticks: /play loads ahead in a job of its own, as does autocomplete's prefetch.
+static bool makeResident(guildSession& session, const std::string& bankFile) {
+	if (bankFile.empty() || bankFile == masterBankFile || bankFile == masterStringsFile) { return true; }
+	std::filesystem::path path = banksDirPath / bankFile;
+	session.bankLastUsed[path] = ++session.bankUses;
+	if (session.bankFiles.contains(path)) { return true; }
+
+	std::vector<bankLoad> loads = loadBanks(session, { path });
+	if (loads[0].result != FMOD_OK) {
+		std::cout << "Couldn't load " << bankFile << ": " << FMOD_ErrorString(loads[0].result) << std::endl;
+		return false;
+	}
+	session.pBanks.push_back(loads[0].bank);
+	session.bankFiles[path] = loads[0].bank;
+	errorCheckFMODSoft(loads[0].bank->loadSampleData());		// Starts now, rather than when the first instance asks for it
+	session.bankLoads++;
+	enforceBankBudget(session, path);
+	return true;
+}
+
+// Loads the bank behind an event ahead of time, e.g. while its name is still being typed.
+static void prefetchEvent(guildSession& session, const std::string& eventName) {
+	auto desc = session.pEventDescriptions.find(eventName);
+	if (desc != session.pEventDescriptions.end()) { makeResident(session, desc->second.bankFile); }
+}
+
+// The bank "eventName" lives in, if it isn't loaded right now. Empty if it's loaded, always kept loaded, or unknown.
+static std::string unloadedBank(guildSession& session, const std::string& eventName) {
+	auto desc = session.pEventDescriptions.find(eventName);
+	if (desc == session.pEventDescriptions.end()) { return ""; }
+	const std::string& bankFile = desc->second.bankFile;
+	if (bankFile.empty() || bankFile == masterBankFile || bankFile == masterStringsFile) { return ""; }
+	if (session.bankFiles.contains(banksDirPath / bankFile)) { return ""; }
+	return bankFile;
+}
+
+// Which file each loaded Event Description came from, so its bank can be unloaded and loaded again later.
+static std::map<FMOD::Studio::EventDescription*, std::string> eventBankFiles(guildSession& session) {
+	std::map<FMOD::Studio::EventDescription*, std::string> eventBanks;
+	for (FMOD::Studio::EventDescription* description : bankEvents(session.pMasterBank)) { eventBanks[description] = masterBankFile; }
+	for (const auto& [path, bank] : session.bankFiles) {
+		for (FMOD::Studio::EventDescription* description : bankEvents(bank)) { eventBanks[description] = path.filename().string(); }
+	}
+	return eventBanks;
+}
+
+// Loads every bank the memory budget has left out, for when everything has to be looked at by path.
+// Returns false if they were all loaded already. Follow up with enforceBankBudget once done.
+static bool loadEveryBank(guildSession& session) {
+	std::vector<std::filesystem::path> unloaded;
+	for (const std::filesystem::path& path : session.bankPaths) {
+		if (!session.bankFiles.contains(path)) { unloaded.push_back(path); }
+	}
+	if (unloaded.empty()) { return false; }
+	adoptBanks(session, loadBanks(session, unloaded), 0);
+	return true;
+}
+
+// Base function, called when requested by List Banks command
+static void banks(guildSession& session) {
+	findBanks(session);
+
+	// With a memory budget, listing them is all there is to do: a bank loads once something in it is played, and the
+	// folder watcher or /playable reindex picks up what's in new ones. Without one, new banks join the rest up front
+	if (bankMemoryBudgetMB == 0) {
+		std::cout << "Loading Banks...\n";
+		loadEveryBank(session);
+	}
 
 	// We deliberately don't unload banks that are no longer used.
 	// This can be a problem over a long runtime if the user is adding and removing a ton of banks,
@@ -325,19 +911,19 @@ static void banks() {
 	// If that changes in the future...unload unused banks here!
 }
 
-// Indexes and Prints all valid .bank files
-static void banks(const dpp::slashcommand_t& event) {
+// Indexes and Prints all valid .bank files. Defers straight away, since the session can be busy and, with everything
+// kept loaded, new banks can take seconds, then waits on the session's strand without holding up a D++ thread.
+static dpp::task<void> banks(guildSession& session, dpp::slashcommand_t event) {
+	co_await event.co_thinking(true);		// Show "Thinking..." while putting the list together
 
-	if (pEventInstances.size() > 0) {	// Unsafe to load/unload banks while events are active
-		event.reply(dpp::message("It's dangerous to mess with banks while the bot is playing audio! Please stop all events first.").set_flags(dpp::m_ephemeral));
-		return;
-	}
-	
-	bankPaths.clear();		// Clear current Bank vector
+	dpp::message reply = co_await onStrand<dpp::message>(session, [&session, event] {
+		if (session.pEventInstances.size() > 0) {	// Unsafe to load/unload banks while events are active
+			return dpp::message("It's dangerous to mess with banks while the bot is playing audio! Please stop all events first.");
+		}
+
+		session.bankPaths.clear();		// Clear current Bank vector
+		banks(session);					// Re-list what banks exist, load new ones if everything's kept loaded
 
-	//Show "Thinking..." while putting the list together
-	event.thinking(true, [event](const dpp::confirmation_callback_t& callback) {
-		banks();					// Re-list what banks exist, load new ones
 
 		dpp::embed bankListEmbed = basicEmbed;		// Create the embed and set non-standard details
 		bankListEmbed.set_title("Found FMOD Banks");
@@ -346,38 +932,36 @@ static void banks(const dpp::slashcommand_t& event) {
 		bankListEmbed.add_field("Required Banks", "- Master.bank\n- Master.strings.bank");
 
 		std::string bankPathsOutput = "";
-		std::cout << "BankPaths size: " << std::to_string(bankPaths.size()) << "\n";
+		std::cout << "BankPaths size: " << std::to_string(session.bankPaths.size()) << "\n";
 
 		// For every additional bank, add the shortened path as a field
-		for (int i = 0; i < (int)bankPaths.size(); i++) {					// For every path
-			bankPathsOutput.append(bankPaths[i].filename().string());   
+		for (int i = 0; i < (int)session.bankPaths.size(); i++) {					// For every path
+			bankPathsOutput.append(session.bankPaths[i].filename().string());
 			continue;
 		}
 
 		if (!bankPathsOutput.empty()) {
 			bankListEmbed.add_field("Additional Banks", bankPathsOutput);
 		}
-
-		event.edit_original_response(dpp::message(event.command.channel_id, bankListEmbed));
+		return dpp::message(event.command.channel_id, bankListEmbed);
 	});
-}
 
-// Indexes all Events, Busses, VCAs, Snapshots, etc. on Startup ONLY.
-static void indexStudio() {
-	// Make sure vectors and maps are clear
-	eventPaths.clear();
-	busPaths.clear();
-	vcaPaths.clear();
-	snapshotPaths.clear();
+	co_await event.co_edit_original_response(reply);
+}
 
+// Walks every string in the Master Strings bank, sorting out the events, busses, VCAs and snapshots we can use,
+// and adds them to the session and to "index" so they can be saved. Returns false if there's nothing to walk.
+static bool indexStrings(guildSession& session, studioIndex& index) {
 	int count = 0;
-	errorCheckFMODHard(pMasterStringsBank->getStringCount(&count));
+	errorCheckFMODHard(session.pMasterStringsBank->getStringCount(&count));
 	if (count < 1) {
 		std::cout << "Invalid strings count of " << count << ", that's a problem." << std::endl;
 		std::cout << "Double check the Master.strings.bank file was loaded properly." << std::endl;
-		return;
+		return false;
 	}
 
+	std::map<FMOD::Studio::EventDescription*, std::string> eventBanks = eventBankFiles(session);
+
 	// Dump each section into sets to sort them, then we'll print after
 	std::set<std::string> eventSet;
 	std::set<std::string> busSet;
@@ -396,7 +980,7 @@ static void indexStudio() {
 
 		// If the string doesn't fit in the allotted size, resize appropriately and continue
 		// We do this because FMOD Studio will tell us exactly how long it _should_ be, but only after trying once
-		FMOD_RESULT result = pMasterStringsBank->getStringInfo(i, &pathGUID, pathStringCharsptr, 256, &retrieved);
+		FMOD_RESULT result = session.pMasterStringsBank->getStringInfo(i, &pathGUID, pathStringCharsptr, 256, &retrieved);
 		if (result != FMOD_OK) {
 			if (result == FMOD_ERR_TRUNCATED) {
 				pathStringChars.resize(retrieved);
@@ -435,12 +1019,14 @@ static void indexStudio() {
 
 			// What's left should be good for our eventPaths vector
 			std::cout << "   Accepted as Event: " << entry << "\n";
-			eventPaths.push_back(entry);
+			session.eventPaths.push_back(entry);
 
 			// Grab associated Event Description
 			FMOD::Studio::EventDescription* newEventDesc = nullptr;
-			errorCheckFMODHard(pSystem->getEvent(entry.c_str(), &newEventDesc));
+			errorCheckFMODHard(session.pSystem->getEvent(entry.c_str(), &newEventDesc));
 			sessionEventDesc newSessionEventDesc; newSessionEventDesc.description = newEventDesc;
+			errorCheckFMODHard(newEventDesc->getID(&newSessionEventDesc.id));
+			newSessionEventDesc.bankFile = eventBanks[newEventDesc];
 
 			// Grab the name of each associated non-built-in parameter
 			int descParamCount = 0;
@@ -458,10 +1044,12 @@ static void indexStudio() {
 					coutString.append(" " + paramMinMaxString(parameter));
 					coutString.append(" " + paramAttributesString(parameter));
 					std::cout << coutString;
+					ownParamName(session, parameter);
 					newSessionEventDesc.params.push_back(parameter);
 				}
 			}
-			pEventDescriptions.insert({ truncateEventPath(entry), newSessionEventDesc });	// Add to map, connected to a trimmed "easy" path name
+			session.pEventDescriptions.insert({ truncateEventPath(entry), newSessionEventDesc });	// Add to map, connected to a trimmed "easy" path name
+			index.events.push_back({ entry, newSessionEventDesc.id, newSessionEventDesc.bankFile, newSessionEventDesc.params });
 		}
 	}
 	
@@ -474,9 +1062,12 @@ static void indexStudio() {
 			else {
 				// Get the Bus and add it to the map
 				FMOD::Studio::Bus* newBus = nullptr;
-				errorCheckFMODHard(pSystem->getBus(entry.c_str(), &newBus));
-				pBusses.insert({ truncateBusPath(entry), newBus });
-				busPaths.push_back(entry);
+				errorCheckFMODHard(session.pSystem->getBus(entry.c_str(), &newBus));
+				session.pBusses.insert({ truncateBusPath(entry), newBus });
+				session.busPaths.push_back(entry);
+				indexedObject indexed{ entry };
+				errorCheckFMODHard(newBus->getID(&indexed.id));
+				index.busses.push_back(indexed);
 				std::cout << "   Accepted as Bus: " << entry << " || Nice Name: " << truncateBusPath(entry) << "\n";
 			}
 		}
@@ -487,10 +1078,13 @@ static void indexStudio() {
 		for (auto& entry : vcaSet) {
 			// Get the VCA and add it to the map
 			FMOD::Studio::VCA* newVCA = nullptr;
-			errorCheckFMODHard(pSystem->getVCA(entry.c_str(), &newVCA));
-			pVCAs.insert({ truncateVCAPath(entry), newVCA });
+			errorCheckFMODHard(session.pSystem->getVCA(entry.c_str(), &newVCA));
+			session.pVCAs.insert({ truncateVCAPath(entry), newVCA });
 
-			vcaPaths.push_back(entry);
+			session.vcaPaths.push_back(entry);
+			indexedObject indexed{ entry };
+			errorCheckFMODHard(newVCA->getID(&indexed.id));
+			index.vcas.push_back(indexed);
 			std::cout << "   Accepted as VCA: " << entry << " || Nice Name: " << truncateVCAPath(entry) << "\n";
 		}
 	}
@@ -500,7 +1094,7 @@ static void indexStudio() {
 		for (auto& entry : snapshotSet) {
 			// Get the Snapshot and add it to the map
 			FMOD::Studio::EventDescription* newSnapshot = nullptr;
-			errorCheckFMODHard(pSystem->getEvent(entry.c_str(), &newSnapshot));
+			errorCheckFMODHard(session.pSystem->getEvent(entry.c_str(), &newSnapshot));
 
 			bool isSnapshot = false;
 			newSnapshot->isSnapshot(&isSnapshot);
@@ -508,8 +1102,13 @@ static void indexStudio() {
 				std::cout << "   Skipped as Snapshot: " << entry << " -- Not actually a snapshot!" << "\n";
 			}
 			else {
-				pSnapshotDescriptions.insert({ truncateSnapshotPath(entry), newSnapshot });
-				snapshotPaths.push_back(entry);
+				session.pSnapshotDescriptions.insert({ truncateSnapshotPath(entry), newSnapshot });
+				session.snapshotPaths.push_back(entry);
+				indexedObject indexed{ entry };
+				errorCheckFMODHard(newSnapshot->getID(&indexed.id));
+				indexed.bank = eventBanks[newSnapshot];
+				index.snapshots.push_back(indexed);
+				if (indexed.bank != masterBankFile) { session.pinnedBanks.insert(banksDirPath / indexed.bank); }
 				std::cout << "   Accepted as Snapshot: " << entry << " || Nice Name: " << truncateSnapshotPath(entry) << "\n";
 			}
 		}
@@ -539,24 +1138,113 @@ static void indexStudio() {
 		
 		std::cout << std::endl;
 	}
-	
+	return true;
+}
+
+// Fills the session from the saved index instead of walking the strings bank. Events keep just their GUID and bank until
+// they're first played; busses, VCAs and snapshots are few, so they're looked up by GUID straight away.
+static void indexFromCache(guildSession& session) {
+	const studioIndexCache& cache = session.indexCache;
+	for (const auto& object : cache.events()) {
+		std::string path = cache.path(object);
+		sessionEventDesc newSessionEventDesc;
+		newSessionEventDesc.id = object.id;
+		newSessionEventDesc.bankFile = cache.bank(object);
+		newSessionEventDesc.params = cache.params(object);
+		for (FMOD_STUDIO_PARAMETER_DESCRIPTION& param : newSessionEventDesc.params) { ownParamName(session, param); }
+		session.eventPaths.push_back(path);
+		session.pEventDescriptions.insert({ truncateEventPath(path), newSessionEventDesc });
+	}
+	for (const auto& object : cache.busses()) {
+		std::string path = cache.path(object);
+		FMOD::Studio::Bus* newBus = nullptr;
+		errorCheckFMODHard(session.pSystem->getBusByID(&object.id, &newBus));
+		session.pBusses.insert({ truncateBusPath(path), newBus });
+		session.busPaths.push_back(path);
+	}
+	for (const auto& object : cache.vcas()) {
+		std::string path = cache.path(object);
+		FMOD::Studio::VCA* newVCA = nullptr;
+		errorCheckFMODHard(session.pSystem->getVCAByID(&object.id, &newVCA));
+		session.pVCAs.insert({ truncateVCAPath(path), newVCA });
+		session.vcaPaths.push_back(path);
+	}
+
+	// Snapshots can be started any time, so the banks holding them are loaded now and kept
+	std::vector<std::filesystem::path> snapshotBanks;
+	for (const auto& object : cache.snapshots()) {
+		std::filesystem::path bank = banksDirPath / cache.bank(object);
+		if (bank.filename() == masterBankFile || session.pinnedBanks.contains(bank)) { continue; }
+		session.pinnedBanks.insert(bank);
+		if (!session.bankFiles.contains(bank)) { snapshotBanks.push_back(bank); }
+	}
+	if (!snapshotBanks.empty()) { adoptBanks(session, loadBanks(session, snapshotBanks), 0); }
+	for (const auto& object : cache.snapshots()) {
+		std::string path = cache.path(object);
+		FMOD::Studio::EventDescription* newSnapshot = nullptr;
+		errorCheckFMODHard(session.pSystem->getEventByID(&object.id, &newSnapshot));
+		session.pSnapshotDescriptions.insert({ truncateSnapshotPath(path), newSnapshot });
+		session.snapshotPaths.push_back(path);
+	}
+	std::cout << "Loaded index from " << studioIndexFile << ": " << session.eventPaths.size() << " events, " << session.busPaths.size() << " busses, "
+		<< session.vcaPaths.size() << " VCAs, " << session.snapshotPaths.size() << " snapshots\n\n";
+}
+
+// Event Descriptions from the saved index are looked up by GUID the first time they're needed.
+static FMOD::Studio::EventDescription* resolveEvent(guildSession& session, sessionEventDesc& desc) {
+	if (desc.description == nullptr) {
+		if (session.pSystem->getEventByID(&desc.id, &desc.description) != FMOD_OK) { desc.description = nullptr; }
+	}
+	return desc.description;
+}
+
+// Indexes all Events, Busses, VCAs, Snapshots, etc. on Startup ONLY.
+static void indexStudio(guildSession& session) {
+	// Make sure vectors and maps are clear
+	session.eventPaths.clear();
+	session.busPaths.clear();
+	session.vcaPaths.clear();
+	session.snapshotPaths.clear();
+	session.pEventDescriptions.clear();
+	session.pBusses.clear();
+	session.pVCAs.clear();
+	session.pSnapshotDescriptions.clear();
+	session.catalogChanged = true;
+
+	// The saved index only holds if every bank is exactly as it was when it was written
+	std::vector<std::filesystem::path> bankFiles = { banksDirPath / masterBankFile, banksDirPath / masterStringsFile };
+	bankFiles.insert(bankFiles.end(), session.bankPaths.begin(), session.bankPaths.end());
+	if (session.indexCache.open(banksDirPath / studioIndexFile, bankFiles)) {
+		indexFromCache(session);
+	}
+	else {
+		// Walking the strings needs every bank loaded, even the ones the memory budget left out. They're trimmed again after
+		loadEveryBank(session);
+
+		studioIndex index;
+		if (!indexStrings(session, index)) { return; }
+		if (writeStudioIndex(banksDirPath / studioIndexFile, bankFiles, index)) { std::cout << "Saved index to " << studioIndexFile << "\n"; }
+		else { std::cout << "Couldn't save index to " << studioIndexFile << ", the banks will be indexed again next time.\n"; }
+		enforceBankBudget(session);
+	}
 
 	// Seperately, get the list of Global Parameters
 	// For this purpose we assume there's at least 1 Global Param
 	std::vector<FMOD_STUDIO_PARAMETER_DESCRIPTION> paramVector(1);
 	FMOD_STUDIO_PARAMETER_DESCRIPTION* paramVectorPtr = paramVector.data();
 	int paramCount = 0;
-	errorCheckFMODHard(pSystem->getParameterDescriptionCount(&paramCount));
+	errorCheckFMODHard(session.pSystem->getParameterDescriptionCount(&paramCount));
 	paramVector.resize(paramCount);
 	paramVectorPtr = paramVector.data();
-	errorCheckFMODHard(pSystem->getParameterDescriptionList(paramVectorPtr, paramCount, &paramCount));
+	errorCheckFMODHard(session.pSystem->getParameterDescriptionList(paramVectorPtr, paramCount, &paramCount));
 
 	// Add them to the vector, one-by-one
 	std::cout << "   Global Parameters:\n";
 	if (paramCount < 1) { std::cout << "      ...none\n"; }
 	for (int i = 0; i < paramCount; i++) {
-		globalParamNames.push_back(paramVector[i].name);
-		globalParamDescriptions.insert({ paramVector[i].name, paramVector[i] });
+		ownParamName(session, paramVector[i]);
+		session.globalParamNames.push_back(paramVector[i].name);
+		session.globalParamDescriptions.insert({ paramVector[i].name, paramVector[i] });
 
 		std::string coutString = "      - ";
 		coutString.append(paramVector[i].name);
@@ -567,12 +1255,191 @@ static void indexStudio() {
 
 }
 
+// Takes out everything a bank put in the catalog, ahead of it being unloaded. Instances started from it are stopped and released,
+// since unloading would destroy them anyway; everything else keeps playing. "bank" is null if it isn't loaded right now.
+// Everything's matched by GUID against what the bank holds. Events are also matched by the bank file they were indexed
+// from, which is all there is to go on while the bank's unloaded, and then nothing can be playing from it either.
+static void dropBankContents(guildSession& session, const std::filesystem::path& path, FMOD::Studio::Bank* bank) {
+	guidSet ids;
+	if (bank != nullptr) {
+		for (FMOD::Studio::EventDescription* description : bankEvents(bank)) {
+			FMOD_GUID id;
+			if (description->getID(&id) == FMOD_OK) { ids.insert(id); }
+		}
+	}
+	auto fromBank = [&ids](FMOD::Studio::EventDescription* description) {
+		FMOD_GUID id;
+		return description != nullptr && description->getID(&id) == FMOD_OK && ids.contains(id);
+	};
+
+	for (auto entry = session.pEventInstances.begin(); entry != session.pEventInstances.end();) {
+		FMOD::Studio::EventDescription* description = nullptr;
+		entry->second.instance->getDescription(&description);
+		if (fromBank(description)) {
+			std::cout << "   Stopping " << entry->first << ", its bank is being reloaded.\n";
+			entry->second.instance->stop(FMOD_STUDIO_STOP_IMMEDIATE);
+			entry->second.instance->release();
+			entry = session.pEventInstances.erase(entry);
+		}
+		else { entry++; }
+	}
+	for (auto entry = session.pSnapshotInstances.begin(); entry != session.pSnapshotInstances.end();) {
+		FMOD::Studio::EventDescription* description = nullptr;
+		entry->second->getDescription(&description);
+		if (fromBank(description)) {
+			std::cout << "   Stopping snapshot " << entry->first << ", its bank is being reloaded.\n";
+			entry->second->stop(FMOD_STUDIO_STOP_IMMEDIATE);
+			entry->second->release();
+			entry = session.pSnapshotInstances.erase(entry);
+		}
+		else { entry++; }
+	}
+
+	std::string file = path.filename().string();
+	std::set<std::string> droppedNames;
+	std::erase_if(session.pEventDescriptions, [&](const auto& entry) {
+		if (entry.second.bankFile != file && !ids.contains(entry.second.id)) { return false; }
+		droppedNames.insert(entry.first);
+		return true;
+	});
+	std::erase_if(session.eventPaths, [&](const std::string& eventPath) { return droppedNames.contains(truncateEventPath(eventPath)); });
+	droppedNames.clear();
+	std::erase_if(session.pSnapshotDescriptions, [&](const auto& entry) {
+		if (!fromBank(entry.second)) { return false; }
+		droppedNames.insert(entry.first);
+		return true;
+	});
+	std::erase_if(session.snapshotPaths, [&](const std::string& snapshotPath) { return droppedNames.contains(truncateSnapshotPath(snapshotPath)); });
+	session.pinnedBanks.erase(path);
+	session.bankLastUsed.erase(path);
+}
+
+// Adds a freshly loaded bank's events and snapshots to the catalog, by the same rules as indexStrings. Ones Master.strings.bank
+// has no path for, because it wasn't rebuilt along with the bank, are logged and left out until it is.
+static void indexBankContents(guildSession& session, const std::filesystem::path& file, FMOD::Studio::Bank* bank) {
+	size_t unnamed = 0;
+	for (FMOD::Studio::EventDescription* description : bankEvents(bank)) {
+		std::vector<char> pathChars(256);
+		int retrieved = 0;
+		FMOD_RESULT result = description->getPath(pathChars.data(), (int)pathChars.size(), &retrieved);
+		if (result == FMOD_ERR_TRUNCATED) {
+			pathChars.resize(retrieved);
+			result = description->getPath(pathChars.data(), (int)pathChars.size(), &retrieved);
+		}
+		if (result != FMOD_OK) {
+			FMOD_GUID id = {};
+			description->getID(&id);
+			std::cout << "   Skipped: " << formatGUID(id) << " in " << file.filename().string() << " -- No path in " << masterStringsFile << " (" << FMOD_ErrorString(result) << ").\n";
+			unnamed++;
+			continue;
+		}
+		std::string path(pathChars.data());
+
+		bool isSnapshot = false;
+		description->isSnapshot(&isSnapshot);
+		if (isSnapshot && path.find(snapshotPrefix, 0) == 0) {
+			session.pSnapshotDescriptions.insert_or_assign(truncateSnapshotPath(path), description);
+			session.snapshotPaths.push_back(path);
+			session.pinnedBanks.insert(file);
+			std::cout << "   Accepted as Snapshot: " << path << "\n";
+		}
+		else if (!isSnapshot && path.find(callableEventPrefix, 0) == 0) {
+			sessionEventDesc newSessionEventDesc;
+			newSessionEventDesc.description = description;
+			description->getID(&newSessionEventDesc.id);
+			newSessionEventDesc.bankFile = file.filename().string();
+			newSessionEventDesc.params = userParams(session, description);
+			session.pEventDescriptions.insert_or_assign(truncateEventPath(path), newSessionEventDesc);
+			session.eventPaths.push_back(path);
+			std::cout << "   Accepted as Event: " << path << "\n";
+		}
+	}
+	if (unnamed > 0) {
+		std::cout << "   " << unnamed << " events and snapshots in " << file.filename().string() << " couldn't be indexed. Rebuild "
+			<< masterStringsFile << " along with it to pick them up." << std::endl;
+	}
+}
+
+
+// Swaps in banks that were added, rebuilt or deleted while running. Only the affected banks are unloaded and loaded,
+// and only the catalog entries they hold are re-indexed, so events from every other bank keep playing throughout.
+static void reloadBanks(guildSession& session, const folderChanges& changes) {
+	if (!session.ready) { return; }		// Never started, so there's nothing to swap
+
+	std::vector<std::filesystem::path> unloading;
+	std::vector<std::filesystem::path> loading;
+	bool stringsChanged = false;
+	auto isMaster = [](const std::filesystem::path& path) { return path.filename() == masterBankFile; };
+	auto isStrings = [](const std::filesystem::path& path) { return path.filename() == masterStringsFile; };
+	for (const std::filesystem::path& path : changes.added) {
+		if (!isMaster(path) && !isStrings(path)) { loading.push_back(path); }
+	}
+	for (const std::filesystem::path& path : changes.changed) {
+		if (isMaster(path)) { std::cout << "Master.bank changed. It holds the mixer everything plays through, so restart to pick it up.\n"; }
+		else if (isStrings(path)) { stringsChanged = true; }
+		else { unloading.push_back(path); loading.push_back(path); }
+	}
+	for (const std::filesystem::path& path : changes.removed) {
+		if (isMaster(path) || isStrings(path)) { std::cout << "   " << path.filename().string() << " was removed, keeping the loaded copy.\n"; }
+		else { unloading.push_back(path); }
+	}
+	if (unloading.empty() && loading.empty() && !stringsChanged) { return; }
+	std::cout << "Reloading banks: " << unloading.size() << " out, " << loading.size() << " in" << (stringsChanged ? ", new strings" : "") << "\n";
+
+	for (const std::filesystem::path& path : unloading) {
+		auto loaded = session.bankFiles.find(path);
+		if (loaded == session.bankFiles.end()) {		// Not resident, so there's only the catalog to clear
+			dropBankContents(session, path, nullptr);
+			continue;
+		}
+		dropBankContents(session, path, loaded->second);
+		errorCheckFMODSoft(loaded->second->unload());
+		std::erase(session.pBanks, loaded->second);
+		session.bankFiles.erase(loaded);
+		std::cout << "   Unloaded: " << path.string() << "\n";
+	}
+	std::erase_if(session.bankPaths, [&](const std::filesystem::path& path) { return std::find(unloading.begin(), unloading.end(), path) != unloading.end(); });
+	if (stringsChanged) { errorCheckFMODSoft(session.pMasterStringsBank->unload()); }
+	errorCheckFMODSoft(session.pSystem->flushCommands());		// Unloads have to finish before the same banks can load again
+
+	// New strings go first, so the new banks' events have paths to index by
+	std::vector<std::filesystem::path> bankFiles;
+	if (stringsChanged) { bankFiles.push_back(banksDirPath / masterStringsFile); }
+	bankFiles.insert(bankFiles.end(), loading.begin(), loading.end());
+	std::vector<bankLoad> loads = loadBanks(session, bankFiles);
+	size_t first = 0;
+	if (stringsChanged) {
+		if (loads[0].result == FMOD_OK) { session.pMasterStringsBank = loads[0].bank; }
+		else { std::cout << "   Couldn't reload " << masterStringsFile << ": " << FMOD_ErrorString(loads[0].result) << "\n"; }
+		first = 1;
+	}
+	for (size_t i = first; i < loads.size(); i++) {
+		if (loads[i].result != FMOD_OK) {
+			std::cout << "   Couldn't load " << loads[i].path.string() << ": " << FMOD_ErrorString(loads[i].result) << "\n";
+			continue;
+		}
+		session.pBanks.push_back(loads[i].bank);
+		session.bankFiles[loads[i].path] = loads[i].bank;
+		session.bankPaths.push_back(loads[i].path);
+		indexBankContents(session, loads[i].path, loads[i].bank);
+	}
+	enforceBankBudget(session);		// New banks were loaded to be indexed, whether or not anything needs them yet
+
+	std::sort(session.bankPaths.begin(), session.bankPaths.end());
+	std::sort(session.eventPaths.begin(), session.eventPaths.end());
+	std::sort(session.snapshotPaths.begin(), session.snapshotPaths.end());
+	session.catalogChanged = true;
+	std::cout << "...Done reloading banks.\n" << std::endl;
+}
+
 // Indexes all loose sound files, for playback with FMOD Core. On Startup ONLY.
-static void indexCore() {
+static void indexCore(guildSession& session) {
 	// Make sure vectors and maps are clear
-	pSounds.clear();
+	session.pSounds.clear();
+	session.soundFilePaths.clear();
+	session.catalogChanged = true;
 	//for (auto& entry : pChannels) { entry.second->stop(); }
-	pChannels.clear();
+	session.pChannels.clear();
 
 	// Get a set of the valid files (not necessarily sounds) in the soundfiles folder
 	std::set<std::filesystem::path> files = getSoundFiles(soundsDirPath);
@@ -580,7 +1447,7 @@ static void indexCore() {
 	// Attempt to load each sound
 	for (auto& entry : files) {
 		FMOD::Sound* newSound = nullptr;
-		FMOD_RESULT result = pCoreSystem->createSound(entry.string().c_str(), FMOD_DEFAULT, nullptr, &newSound);
+		FMOD_RESULT result = session.pCoreSystem->createSound(entry.string().c_str(), FMOD_DEFAULT, nullptr, &newSound);
 
 		// If there's an error, give a warning in the console and toss it out
 		if (result != FMOD_OK) {
@@ -591,441 +1458,386 @@ static void indexCore() {
 		else {
 			// Some sanitization to translate filepath to user-friendly paths
 			std::cout << "  Accepted: " << entry.string() << "\n";
-			pSounds.insert({ formatPathToSoundfile(entry, soundsDirPath), newSound});
+			session.pSounds.insert({ formatPathToSoundfile(entry, soundsDirPath), newSound});
+			session.soundFilePaths.insert({ formatPathToSoundfile(entry, soundsDirPath), entry });
 		}
 	}
-	if (pSounds.size() > 0) {
+	if (session.pSounds.size() > 0) {
 		std::cout << "Sounds:\n";
-		for (auto& entry : pSounds) {
+		for (auto& entry : session.pSounds) {
 			std::cout << "   " << entry.first << "\n";
 		}
 	}
 	
 }
 
-// Prints all currently indexed Events, Snapshots, Global Parameters, Busses, and VCAs.
-static void list(const dpp::slashcommand_t& event) {
+// Prints all currently playing Event instances, Snapshots, and Sounds, plus Global Parameters and optionally Busses and VCAs.
+// Reads the session's last published snapshot, so it never waits on the session or calls into FMOD.
+static void list(guildSession& session, const dpp::slashcommand_t& event) {
 	dpp::command_interaction cmd_data = event.command.get_command_interaction();
 
 	// Check the input variables are good
 	unsigned int count = (unsigned int)cmd_data.options.size();
 	if (count > 2) {
 		std::cout << "List command received with too many arguments.\n";
-		event.reply(dpp::message("List command received with too many arguments.").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("List command received with too many arguments.").set_flags(dpp::m_ephemeral));
 		return;
 	}
+	bool showFaders = false;
+	if (count > 0) {
+		showFaders = std::get<bool>(event.get_parameter(cmd_data.options[0].name));
+	}
 
-	event.thinking(true, [event](const dpp::confirmation_callback_t& callback) {
-
-		// Basic setup
-		dpp::embed listEmbed = basicEmbed;
-		listEmbed.set_title("Dashboard List");
-		std::cout << "Listing current:" << "\n";
-
-		// Event Instances
-		if (pEventInstances.empty()) {
-			std::cout << "   No playing Event Instances.\n";
-			listEmbed.add_field("Active Events", "- No active events");
-		}
-		else {
-			std::string eventInstanceList = "";
-			for (auto const& inst : pEventInstances) {		// For each Event Instance
-
-				// Get the Event Instance name
-				std::string instName = inst.first;
-
-				// Get the related Event Description
-				FMOD::Studio::EventDescription* instDesc;
-				inst.second.instance->getDescription(&instDesc);
-
-				// Get the Event Description's name
-				std::vector<char> pathchars(256);
-				char* pathptr = pathchars.data();
-				int retrieved = 0;
-				FMOD_RESULT result = instDesc->getPath(pathptr, 256, &retrieved);
-				if (result != FMOD_OK) {
-					if (result == FMOD_ERR_TRUNCATED) {
-						pathchars.resize(retrieved);
-						pathptr = pathchars.data();
-					}
-					else { errorCheckFMODSoft(result); }
-				}
-
-				std::string instDescName(pathptr);					// Make string, then format
-				instDescName = truncateEventPath(instDescName);
-
-				eventInstanceList.append("- __" + instName + "__");	// Append the event Instance name
-
-				if (!inst.second.params.empty()) {			// If this Instance has any parameters associated...
-					std::string paramOutString = " - source event: " + instDescName + "\n";	// add in the event name
-					for (unsigned int i = 0; i < inst.second.params.size(); i++) {
-						// Skip this parameter if it's Read-Only
-						if ((inst.second.params[i].flags % 2) == 1) { continue; }
-
-						// get current parameter name & value
-						std::string paramName(inst.second.params[i].name);
-						float paramVal = 0; float paramFinalVal = 0;
-						errorCheckFMODHard(inst.second.instance->getParameterByID(inst.second.params[i].id, &paramVal, &paramFinalVal));
-						std::string paramValStr = paramValueString(paramVal, inst.second.params[i]);
+	std::shared_ptr<const sessionSnapshot> snapshot = session.snapshot.load();
+	if (snapshot == nullptr) {
+		respond(event, dpp::message("Still loading this server's banks, try again in a moment.").set_flags(dpp::m_ephemeral));
+		return;
+	}
 
-						// Get the min/max
-						std::string paramMinMaxStr = paramMinMaxString(inst.second.params[i]);
-						// Get the Attributes
-						std::string paramAttributesStr = paramAttributesString(inst.second.params[i]);
+	// Basic setup
+	dpp::embed listEmbed = basicEmbed;
+	listEmbed.set_title("Dashboard List");
+	std::cout << "Listing current:" << "\n";
 
-						// Glue 'em all together, adding new lines per-parameter
-						paramOutString.append(" - " + paramName + ": " + paramValStr + "  " + paramMinMaxStr + paramAttributesStr);
-						if (i > 0) { paramOutString.append("\n"); }
-					}
-					eventInstanceList.append("\n" + paramOutString);
+	// Event Instances
+	if (snapshot->events.empty()) {
+		std::cout << "   No playing Event Instances.\n";
+		listEmbed.add_field("Active Events", "- No active events");
+	}
+	else {
+		std::string eventInstanceList = "";
+		for (const snapshotEventInstance& inst : snapshot->events) {		// For each Event Instance
+			eventInstanceList.append("- __" + inst.name + "__");			// Append the event Instance name
+
+			if (!inst.params.empty()) {			// If this Instance has any parameters associated...
+				std::string paramOutString = " - source event: " + inst.sourceEvent + "\n";	// add in the event name
+				for (unsigned int i = 0; i < inst.params.size(); i++) {
+					const snapshotParam& param = inst.params[i];
+					if (param.readOnly) { continue; }		// Skip this parameter if it's Read-Only
+
+					// Glue 'em all together, adding new lines per-parameter
+					paramOutString.append(" - " + param.name + ": " + param.valueText + "  " + param.rangeText);
+					if (i > 0) { paramOutString.append("\n"); }
 				}
-				eventInstanceList.append("\n");		// Close it off, new line, next event
+				eventInstanceList.append("\n" + paramOutString);
 			}
-			listEmbed.add_field("Active Events", eventInstanceList);
+			eventInstanceList.append("\n");		// Close it off, new line, next event
 		}
+		listEmbed.add_field("Active Events", eventInstanceList);
+	}
 
-
-		// Global Parameters
-		if (globalParamDescriptions.empty()) {
-			std::cout << "   No current Global Parameters." << std::endl;
-			listEmbed.add_field("Global Parameters", "- No Global Parameters");
+	// Global Parameters
+	if (snapshot->globalParams.empty()) {
+		std::cout << "   No current Global Parameters." << std::endl;
+		listEmbed.add_field("Global Parameters", "- No Global Parameters");
+	}
+	else {
+		std::string globalParametersList = "";
+		for (const snapshotParam& param : snapshot->globalParams) {
+			globalParametersList.append("- " + param.name + ": " + param.valueText + "  " + param.rangeText + "\n");
 		}
-		else {
-			std::string globalParametersList = "";
-
-			for (auto const& param : globalParamDescriptions) {
-
-				// Get the Global Parameter's name
-				std::string paramName = param.first;
-
-				// Get the Parameter's current value
-				float paramVal = 0;
-				errorCheckFMODHard(pSystem->getParameterByName(param.second.name, &paramVal));
-				std::string paramValStr = paramValueString(paramVal, param.second);
-
-				// Get the min/max
-				std::string paramMinMaxStr = paramMinMaxString(param.second);
-				// Get the Attributes
-				std::string paramAttributesStr = paramAttributesString(param.second);
+		listEmbed.add_field("Global Parameters", globalParametersList);
+	}
 
-				// Glue 'em all together, adding new lines per-parameter
-				globalParametersList.append("- " + paramName + ": " + paramValStr + "  " + paramMinMaxStr + paramAttributesStr + "\n");
-			}
-			listEmbed.add_field("Global Parameters", globalParametersList);
+	// Snapshots
+	if (snapshot->snapshots.empty()) {
+		std::cout << "   No current Snapshots." << std::endl;
+		listEmbed.add_field("Active Snapshots", "- No Snapshots active");
+	}
+	else {
+		std::string snapshotsList = "";
+		for (const std::string& snapName : snapshot->snapshots) {
+			snapshotsList.append("- " + snapName + "\n");
 		}
+		listEmbed.add_field("Active Snapshots", snapshotsList);
+	}
 
+	// Files
+	if (snapshot->sounds.empty()) {
+		std::cout << "   No current sounds playing from files." << std::endl;
+		listEmbed.add_field("Active Sounds", "- No actively playing sounds.");
+	}
+	else {
+		std::string soundsList = "";
+		for (const auto& [instanceName, soundName] : snapshot->sounds) {
+			soundsList.append("- " + instanceName + " (" + soundName + ")\n");
+		}
+		listEmbed.add_field("Active Sounds", soundsList);
+	}
 
-		// Snapshots
-		if (pSnapshotInstances.empty()) {
-			std::cout << "   No current Snapshots." << std::endl;
-			listEmbed.add_field("Active Snapshots", "- No Snapshots active");
+	// Busses and VCAs
+	if (showFaders) {
+		// Busses
+		if (snapshot->busses.empty()) {
+			std::cout << "   No current Busses." << std::endl;
+			listEmbed.add_field("Busses", "- No Busses, somehow. This is either a bug, or you've messed up the FMOD project.");
 		}
 		else {
-			std::string snapshotsList = "";
-
-			for (auto const& snapshot : pSnapshotInstances) {
-				// Get the Event Instance name and append it. Much simpler!
-				std::string snapName = snapshot.first;
-				snapshotsList.append("- " + snapName + "\n");
+			//Todo: Sort the Busses in a hierarchical way. Maybe by number of slash chars in name? Maybe when these are indexed?
+			std::string bussesList = "";
+			for (const snapshotFader& bus : snapshot->busses) {
+				bussesList.append("- " + bus.name + ": " + volumeString(bus.volumeDb) + "\n");
 			}
-			listEmbed.add_field("Active Snapshots", snapshotsList);
-		}
-		
-		// Some workarounds to extract the values from "event" rather than passing them in (forbidden due to lambda)
-		int count = (int)event.command.get_command_interaction().options.size();
-		bool showFaders = false;
-		if (count > 0) {
-			showFaders = std::get<bool>(event.get_parameter(event.command.get_command_interaction().options[0].name));
+			listEmbed.add_field("Busses", bussesList);
 		}
 
-		// Files
-		if (pChannels.empty()) {
-			std::cout << "   No current sounds playing from files." << std::endl;
-			listEmbed.add_field("Active Sounds", "- No actively playing sounds.");
+		// VCAs
+		if (snapshot->vcas.empty()) {
+			std::cout << "   No current VCAs." << std::endl;
+			listEmbed.add_field("VCAs", "- No Current VCAs");
 		}
 		else {
-			std::string soundsList = "";
-			for (auto& entry : pChannels) {
-				soundsList.append("- " + entry.first + " (" + entry.second.soundNiceName + ")\n");
+			std::string vcaList = "";
+			for (const snapshotFader& vca : snapshot->vcas) {
+				vcaList.append("- " + vca.name + ": " + volumeString(vca.volumeDb) + "\n");
 			}
-			listEmbed.add_field("Active Sounds", soundsList);
+			listEmbed.add_field("VCAs", vcaList);
 		}
+	}
 
-		// Busses and VCAs
-		if (showFaders) {
-			// Busses
-			if (pBusses.empty()) {
-				std::cout << "   No current Busses." << std::endl;
-				listEmbed.add_field("Busses", "- No Busses, somehow. This is either a bug, or you've messed up the FMOD project.");
-			}
-			else {
-				std::string bussesList = "";
-				
-				//Todo: Sort the Busses in a hierarchical way. Maybe by number of slash chars in name? Maybe when these are indexed?
-				for (auto const& bus : pBusses) {
-
-					// Get the Bus name
-					std::string busName = bus.first;
-
-					float value = 0;
-					errorCheckFMODHard(bus.second->getVolume(&value));
-					value = floatTodB(value);
-
-					bussesList.append("- " + busName + ": " + volumeString(value) + "\n");
-				}
-				listEmbed.add_field("Busses", bussesList);
-			}
-
-			// VCAs
-			if (pVCAs.empty()) {
-				std::cout << "   No current VCAs." << std::endl;
-				listEmbed.add_field("VCAs", "- No Current VCAs");
-			}
-			else {
-				std::string vcaList = "";
-
-				for (auto const& vca : pVCAs) {
-
-					// Get the VCA name
-					std::string vcaName = vca.first;
+	// Send it off, finally
+	respond(event, dpp::message(event.command.channel_id, listEmbed).set_flags(dpp::m_ephemeral));
+}
 
-					float value = 0;
-					errorCheckFMODHard(vca.second->getVolume(&value));
-					value = floatTodB(value);
+// What a re-index added and took away, by Nice Name.
+struct playableChanges {
+	std::vector<std::string> addedEvents;
+	std::vector<std::string> removedEvents;
+	std::vector<std::string> addedSnapshots;
+	std::vector<std::string> removedSnapshots;
 
-					vcaList.append("- " + vcaName + ": " + volumeString(value) + "\n");
-				}
-				listEmbed.add_field("VCAs", vcaList);
-			}
-		}
+	bool empty() const { return addedEvents.empty() && removedEvents.empty() && addedSnapshots.empty() && removedSnapshots.empty(); }
+};
 
-		// Send it off, finally
-		event.edit_original_response(dpp::message(event.command.channel_id, listEmbed));
-	});
-}
+// Base function, called when requested by Playable command. Compares the Master Strings bank with what's indexed, by GUID,
+// and only adds what's new and drops what's gone, so a re-index costs one pass over the strings however many there are.
+// Renamed or moved events count as one of each. Events already playing are left alone.
+static playableChanges playable(guildSession& session) {
+	playableChanges changes;
 
-// Base function, called when requested by Playable command
-static void playable() {
 	// Get the number of strings in the Master Strings bank
 	int count = 0;
-	errorCheckFMODHard(pMasterStringsBank->getStringCount(&count));
+	errorCheckFMODHard(session.pMasterStringsBank->getStringCount(&count));
 	if (count <= 0) {
 		std::cout << "Invalid strings count of " << count << ", that's a problem." << "\n";
 		std::cout << "Double check the Master.strings.bank file was loaded properly." << std::endl;
-		return;
+		return changes;
 	}
 
 	std::cout << "Refreshing playables list..." << "\n";
 
-	// Get a copy of the event Paths list, and the same for the Snapshots path list
-	std::vector<std::string> existingEvents = eventPaths;
-	std::vector<std::string> existingSnapshots = snapshotPaths;
-
-	// For every entry
+	// Every callable event and snapshot the strings bank knows about now
+	guidNames liveEvents;
+	guidNames liveSnapshots;
+	liveEvents.reserve(session.pEventDescriptions.size());
+	std::vector<char> pathStringChars(256);
 	for (int i = 0; i < count; i++) {
-		// Get the Event Description's name and details
-		std::vector<char> pathStringChars(256);
-		char* pathStringCharsptr = pathStringChars.data();
+		FMOD_GUID pathGUID;
 		int retrieved = 0;
-		FMOD_RESULT result = pMasterStringsBank->getStringInfo(i, nullptr, pathStringCharsptr, 256, &retrieved);
-		if (result != FMOD_OK) {
-			if (result == FMOD_ERR_TRUNCATED) {
-				pathStringChars.resize(retrieved);
-				pathStringCharsptr = pathStringChars.data();
-			}
-			else { errorCheckFMODHard(result); }
+		FMOD_RESULT result = session.pMasterStringsBank->getStringInfo(i, &pathGUID, pathStringChars.data(), (int)pathStringChars.size(), &retrieved);
+		if (result == FMOD_ERR_TRUNCATED) {		// Too long for the buffer, so grow it and ask again
+			pathStringChars.resize(retrieved);
+			result = session.pMasterStringsBank->getStringInfo(i, &pathGUID, pathStringChars.data(), (int)pathStringChars.size(), &retrieved);
 		}
-		std::string pathString(pathStringCharsptr);
+		errorCheckFMODHard(result);
+		std::string pathString(pathStringChars.data());
+
+		if (pathString.find(callableEventPrefix, 0) == 0) { liveEvents.insert({ pathGUID, std::move(pathString) }); }
+		else if (pathString.find(snapshotPrefix, 0) == 0) { liveSnapshots.insert({ pathGUID, std::move(pathString) }); }
+	}
+
+	// ...and everything that's indexed
+	guidNames indexedEvents;
+	indexedEvents.reserve(session.pEventDescriptions.size());
+	for (const auto& [niceName, desc] : session.pEventDescriptions) { indexedEvents.insert({ desc.id, niceName }); }
+	guidNames indexedSnapshots;
+	for (const auto& [niceName, description] : session.pSnapshotDescriptions) {
+		FMOD_GUID id;
+		if (description->getID(&id) == FMOD_OK) { indexedSnapshots.insert({ id, niceName }); }
+	}
+
+	catalogDiff eventDiff = diffCatalog(indexedEvents, liveEvents, truncateEventPath);
+	catalogDiff snapshotDiff = diffCatalog(indexedSnapshots, liveSnapshots, truncateSnapshotPath);
+
+	// Removals first, so a renamed one's new name goes in cleanly
+	changes.removedEvents = std::move(eventDiff.removed);
+	changes.removedSnapshots = std::move(snapshotDiff.removed);
+	if (!changes.removedEvents.empty()) {
+		std::unordered_set<std::string> removed(changes.removedEvents.begin(), changes.removedEvents.end());
+		for (const std::string& niceName : removed) { session.pEventDescriptions.erase(niceName); }
+		std::erase_if(session.eventPaths, [&removed](const std::string& path) { return removed.contains(truncateEventPath(path)); });
+	}
+	if (!changes.removedSnapshots.empty()) {
+		std::unordered_set<std::string> removed(changes.removedSnapshots.begin(), changes.removedSnapshots.end());
+		for (const std::string& niceName : removed) { session.pSnapshotDescriptions.erase(niceName); }
+		std::erase_if(session.snapshotPaths, [&removed](const std::string& path) { return removed.contains(truncateSnapshotPath(path)); });
+	}
+
+	// Additions
+	const std::vector<std::pair<FMOD_GUID, std::string>>& newEvents = eventDiff.added;
+	const std::vector<std::pair<FMOD_GUID, std::string>>& newSnapshots = snapshotDiff.added;
 
-		// Discard if this string isn't an event or snapshot
-		if ((pathString.find(eventPrefix, 0) != 0) && (pathString.find(snapshotPrefix, 0) != 0)) {	// Skip if not Event or Snapshot...
-			std::cout << "   Skipped: " << pathString << " -- Not Event or Snapshot." << std::endl;
+
+	// New ones can be in banks the memory budget hasn't loaded, so load everything for the lookup and trim again after
+	bool loadedEverything = false;
+	if (!newEvents.empty() || !newSnapshots.empty()) { loadedEverything = loadEveryBank(session); }
+	std::map<FMOD::Studio::EventDescription*, std::string> eventBanks;
+	if (!newEvents.empty() || !newSnapshots.empty()) { eventBanks = eventBankFiles(session); }
+
+	for (const auto& [id, path] : newEvents) {
+		FMOD::Studio::EventDescription* newEventDesc = nullptr;
+		if (session.pSystem->getEventByID(&id, &newEventDesc) != FMOD_OK) {
+			std::cout << "   Skipped: " << path << " -- Not in any loaded bank." << std::endl;
 			continue;
 		}
-		// Discard if it's an event outside the Master folder
-		if ((pathString.find(eventPrefix, 0) == 0) && (pathString.find(callableEventPrefix, 0) != 0)) {								// Skip if not in Master folder...
-			std::cout << "   Skipped: " << pathString << " -- Event not in Master folder." << std::endl;
+		sessionEventDesc newSessionEventDesc;
+		newSessionEventDesc.description = newEventDesc;
+		newSessionEventDesc.id = id;
+		newSessionEventDesc.bankFile = eventBanks[newEventDesc];
+		newSessionEventDesc.params = userParams(session, newEventDesc);
+		session.pEventDescriptions.insert_or_assign(truncateEventPath(path), newSessionEventDesc);		// Add to map, connected to a trimmed "easy" path name
+		session.eventPaths.push_back(path);
+		changes.addedEvents.push_back(truncateEventPath(path));
+		std::cout << "   Accepted as Event: " << path << std::endl;
+	}
+	for (const auto& [id, path] : newSnapshots) {
+		FMOD::Studio::EventDescription* newSnapshotDesc = nullptr;
+		bool isSnapshot = false;
+		if (session.pSystem->getEventByID(&id, &newSnapshotDesc) != FMOD_OK || newSnapshotDesc->isSnapshot(&isSnapshot) != FMOD_OK || !isSnapshot) {
+			std::cout << "   Skipped: " << path << " -- Not a snapshot in any loaded bank." << std::endl;
 			continue;
 		}
+		session.pSnapshotDescriptions.insert_or_assign(truncateSnapshotPath(path), newSnapshotDesc);
+		session.snapshotPaths.push_back(path);
+		std::string bankFile = eventBanks[newSnapshotDesc];
+		if (!bankFile.empty() && bankFile != masterBankFile) { session.pinnedBanks.insert(banksDirPath / bankFile); }
+		changes.addedSnapshots.push_back(truncateSnapshotPath(path));
+		std::cout << "   Accepted as Snapshot: " << path << std::endl;
+	}
+	if (loadedEverything) { enforceBankBudget(session); }
+
+	if (!changes.addedEvents.empty()) { std::sort(session.eventPaths.begin(), session.eventPaths.end()); }
+	if (!changes.addedSnapshots.empty()) { std::sort(session.snapshotPaths.begin(), session.snapshotPaths.end()); }
+	if (!changes.empty()) { session.catalogChanged = true; }
+	std::cout << "...Done! Events +" << changes.addedEvents.size() << " -" << changes.removedEvents.size()
+		<< ", Snapshots +" << changes.addedSnapshots.size() << " -" << changes.removedSnapshots.size() << "\n" << std::endl;
+	return changes;
+}
 
-		// Discard strings that are already loaded
-		// Also remove them from their respective "existing" lists, such that whatever remains
-		// on those lists is no longer available (removed during Live Connect?)
-		if (!eventPaths.empty()) {
-			bool alreadyExistsEvent = false;
-			for (unsigned int j = 0; i < (int)eventPaths.size(); j++) {
-				if (eventPaths[i] == pathString) { alreadyExistsEvent = true; break; }
-			}
-			if (alreadyExistsEvent) {
-				std::cout << "   Skipped: " << pathString << " -- Event already listed." << std::endl;
-				for (unsigned int k = 0; k < existingEvents.size(); k++) {
-					if (pathString == existingEvents[k]) {
-						existingEvents.erase(existingEvents.begin() + k);
-					}
-				}
-				continue;
-			}
-		}
-
-		if (!snapshotPaths.empty()) {
-			bool alreadyExistsSnapshot = false;
-			for (unsigned int j = 0; i < (int)snapshotPaths.size(); j++) {
-				if (snapshotPaths[i] == pathString) { alreadyExistsSnapshot = true; break; }
-			}
-			if (alreadyExistsSnapshot) {
-				std::cout << "   Skipped: " << pathString << " -- Snapshot already listed." << std::endl;
-				for (unsigned int k = 0; k < existingSnapshots.size(); k++) {
-					if (pathString == existingSnapshots[k]) {
-						existingSnapshots.erase(existingSnapshots.begin() + k);
-					}
-				}
-				continue;
-			}
-		}
-
-		// What's left should be good for our vectors
-		
-		// Events
-		if ((pathString.find(eventPrefix, 0) == 0)) {
-			std::cout << "   Accepted as Event: " << pathString << std::endl;
-			eventPaths.push_back(pathString);
-
-			// Grab associated Event Description
-			FMOD::Studio::EventDescription* newEventDesc = nullptr;
-			errorCheckFMODHard(pSystem->getEvent(pathString.c_str(), &newEventDesc));
-			sessionEventDesc newSessionEventDesc; newSessionEventDesc.description = newEventDesc;
-
-			// Grab the name of each associated non-built-in parameter
-			int descParamCount = 0;
-			newSessionEventDesc.description->getParameterDescriptionCount(&descParamCount);
-			for (int i = 0; i < descParamCount; i++) {
-				FMOD_STUDIO_PARAMETER_DESCRIPTION parameter;
-				newSessionEventDesc.description->getParameterDescriptionByIndex(i, &parameter);
-				if (parameter.type == FMOD_STUDIO_PARAMETER_GAME_CONTROLLED) {
-					std::string paramName(parameter.name);
-					std::string coutString = "      ";
-
-					coutString.append(" - Parameter: " + paramName);
-					coutString.append(" " + paramMinMaxString(parameter));
-					coutString.append(" " + paramAttributesString(parameter));
-					std::cout << coutString;
-					newSessionEventDesc.params.push_back(parameter);
-				}
-			}
-			pEventDescriptions.insert({ truncateEventPath(pathString), newSessionEventDesc });		// Add to map, connected to a trimmed "easy" path name
-		}
-
-		// Snapshots
-		else {
-			std::cout << "   Accepted as Snapshot: " << pathString << std::endl;
-			snapshotPaths.push_back(pathString);
-
-			// Grab Snapshot's Event Description and add to Snapshots map
-			FMOD::Studio::EventDescription* newSnapshotDesc = nullptr;
-			errorCheckFMODHard(pSystem->getEvent(pathString.c_str(), &newSnapshotDesc));
-			pSnapshotDescriptions.insert({truncateSnapshotPath(pathString), newSnapshotDesc});
-		}
-	}
-	std::cout << "...Done!" << "\n" << std::endl;
+// One line per kind of change, naming as many as fit in an embed field.
+static std::string describeChanges(const playableChanges& changes) {
+	if (changes.empty()) { return "Nothing changed."; }
+	std::string out;
+	auto list = [&out](const char* label, const std::vector<std::string>& names) {
+		if (names.empty()) { return; }
+		std::string line = std::string(label) + " (" + std::to_string(names.size()) + "): ";
+		size_t shown = 0;
+		for (const std::string& name : names) {
+			if (line.size() + name.size() > 240) { break; }
+			line += (shown > 0 ? ", " : "") + name;
+			shown++;
+		}
+		if (shown < names.size()) { line += ", and " + std::to_string(names.size() - shown) + " more"; }
+		out += line + "\n";
+	};
+	list("Added events", changes.addedEvents);
+	list("Removed events", changes.removedEvents);
+	list("Added snapshots", changes.addedSnapshots);
+	list("Removed snapshots", changes.removedSnapshots);
+	return out;
 }
 
-// Indexes and Prints all playable Event Descriptions & Parameters.
-static void playable(const dpp::slashcommand_t& event) {
-
-	if (!pMasterStringsBank->isValid() || pMasterStringsBank == nullptr) {
-		std::cout << "Master Strings bank is invalid or nullptr. Bad juju!" << std::endl;
-		event.reply(dpp::message("Master Strings bank is invalid or nullptr. Bad juju!")
-			.set_flags(dpp::m_ephemeral));
-		return;
-	}
-
+// Indexes and Prints all playable Event Descriptions & Parameters. Defers straight away, since re-indexing walks every string
+// in the Master Strings bank, then waits on the session's strand for it without holding up a D++ thread.
+static dpp::task<void> playable(guildSession& session, dpp::slashcommand_t event) {
 	dpp::command_interaction cmd_data = event.command.get_command_interaction();
 
 	// Check the input variables are good
 	unsigned int count = (unsigned int)cmd_data.options.size();
 	if (count > 1) {
 		std::cout << "Playable command received with too many arguments." << std::endl;
-		event.reply(dpp::message("Playable command received with too many arguments.").set_flags(dpp::m_ephemeral));
-		return;
+		respond(event, dpp::message("Playable command received with too many arguments.").set_flags(dpp::m_ephemeral));
+		co_return;
 	}
 
-	event.thinking(true, [event](const dpp::confirmation_callback_t& callback) {
-
-		// Get whether the command came with the optional "reindex" parameter
-		unsigned int count = (unsigned int)event.command.get_command_interaction().options.size();
-		bool reindex = false;
-		if (count > 0) {
-			reindex = std::get<bool>(event.get_parameter(event.command.get_command_interaction().options[0].name));
-		}
+	// Get whether the command came with the optional "reindex" parameter
+	bool reindex = false;
+	if (count > 0) {
+		reindex = std::get<bool>(event.get_parameter(cmd_data.options[0].name));
+	}
 
-		// If told to, clear all event description vectors/maps, then re-index
-		if (reindex) {
-			eventPaths.clear();
-			pEventDescriptions.clear();
-			snapshotPaths.clear();
-			pSnapshotDescriptions.clear();
+	co_await event.co_thinking(true);
 
-			playable();
+	dpp::message reply = co_await onStrand<dpp::message>(session, [&session, event, reindex] {
+		if (session.pMasterStringsBank == nullptr || !session.pMasterStringsBank->isValid()) {
+			std::cout << "Master Strings bank is invalid or nullptr. Bad juju!" << std::endl;
+			return dpp::message("Master Strings bank is invalid or nullptr. Bad juju!");
 		}
+
+		// If told to, bring the index up to date with the strings bank
+		std::string reindexOutput = "";
+		if (reindex) { reindexOutput = describeChanges(playable(session)); }
 		else { std::cout << "Listing Playables without re-indexing." << std::endl; }
 
 		// And now print 'em to Discord!
-		if ((eventPaths.size() == 0) && (snapshotPaths.size() == 0)) {
+		if ((session.eventPaths.size() == 0) && (session.snapshotPaths.size() == 0)) {
 			// If no playables are found, say so.
-			event.edit_original_response(dpp::message("No playable Events or Snapshots found!"));
+			return dpp::message("No playable Events or Snapshots found!");
 		}
-		else {
-			dpp::embed paramListEmbed = basicEmbed;								// Create the embed and set non-standard details
-			paramListEmbed.set_title("Playables");
-
-			std::string playableEventsOutput = "";
-
-			// Events
-			for (int i = 0; i < (int)eventPaths.size(); i++) {								// For every path	
-				std::vector<FMOD_STUDIO_PARAMETER_DESCRIPTION> eventParams = pEventDescriptions.at(truncateEventPath(eventPaths[i])).params;
-				playableEventsOutput.append("- " + truncateEventPath(eventPaths[i]) + "\n");
-
-				if (eventParams.size() != 0) {
-					std::string paramOutString = "";
-					for (int j = 0; j < (int)eventParams.size(); j++) {			// as well as each associated parameters and their ranges, if any.
-						paramOutString.append("  - ");
-						paramOutString.append(eventParams[j].name);
-						paramOutString.append(" ");
-						paramOutString.append(paramMinMaxString(eventParams[j]) + paramAttributesString(eventParams[j]));
-					}
-					playableEventsOutput.append(paramOutString);
-				}
-			}
-			paramListEmbed.add_field("Events", playableEventsOutput);
 
-			std::string playableSnapshotsOutput = "";
-			// Snapshots 
-			for (int i = 0; i < (int)snapshotPaths.size(); i++) {						// For every path	
-				playableSnapshotsOutput.append("- ");
-				playableSnapshotsOutput.append(truncateSnapshotPath(snapshotPaths[i]) + "\n");
-			}
-			paramListEmbed.add_field("Snapshots", playableSnapshotsOutput);
+		dpp::embed paramListEmbed = basicEmbed;								// Create the embed and set non-standard details
+		paramListEmbed.set_title("Playables");
+		if (!reindexOutput.empty()) { paramListEmbed.add_field("Re-index", reindexOutput); }
 
-			std::string playableFilesOutput = "";
-			// Files
-			for (auto& entry : pSounds) {
-				playableFilesOutput.append("- ");
-				playableFilesOutput.append(entry.first + "\n");
+		std::string playableEventsOutput = "";
+
+		// Events
+		for (int i = 0; i < (int)session.eventPaths.size(); i++) {								// For every path	
+			std::vector<FMOD_STUDIO_PARAMETER_DESCRIPTION> eventParams = session.pEventDescriptions.at(truncateEventPath(session.eventPaths[i])).params;
+			playableEventsOutput.append("- " + truncateEventPath(session.eventPaths[i]) + "\n");
+
+			if (eventParams.size() != 0) {
+				std::string paramOutString = "";
+				for (int j = 0; j < (int)eventParams.size(); j++) {			// as well as each associated parameters and their ranges, if any.
+					paramOutString.append("  - ");
+					paramOutString.append(eventParams[j].name);
+					paramOutString.append(" ");
+					paramOutString.append(paramMinMaxString(eventParams[j]) + paramAttributesString(eventParams[j]));
+				}
+				playableEventsOutput.append(paramOutString);
 			}
-			paramListEmbed.add_field("Files", playableFilesOutput);
+		}
+		paramListEmbed.add_field("Events", playableEventsOutput);
+
+		std::string playableSnapshotsOutput = "";
+		// Snapshots 
+		for (int i = 0; i < (int)session.snapshotPaths.size(); i++) {						// For every path	
+			playableSnapshotsOutput.append("- ");
+			playableSnapshotsOutput.append(truncateSnapshotPath(session.snapshotPaths[i]) + "\n");
+		}
+		paramListEmbed.add_field("Snapshots", playableSnapshotsOutput);
 
-			event.edit_original_response(dpp::message(event.command.channel_id, paramListEmbed));
+		std::string playableFilesOutput = "";
+		// Files
+		for (auto& entry : session.pSounds) {
+			playableFilesOutput.append("- ");
+			playableFilesOutput.append(entry.first + "\n");
 		}
+		paramListEmbed.add_field("Files", playableFilesOutput);
+
+		return dpp::message(event.command.channel_id, paramListEmbed);
 	});
+
+	co_await event.co_edit_original_response(reply);
 }
 
 // Play Sub-Command: create a new Instance of an event.
-static void play_event(const dpp::slashcommand_t& event, const std::string& eventToPlay, const std::string& inputName) {
+static void play_event(guildSession& session, const dpp::slashcommand_t& event, const std::string& eventToPlay, const std::string& inputName) {
 
 	std::string newName = inputName;
 	std::string cleanName = newName;
 	int iterator = 1;
-	while (pEventInstances.find(newName) != pEventInstances.end()) {		// If that name already exists, quietly give it a number
+	while (session.pEventInstances.find(newName) != session.pEventInstances.end()) {		// If that name already exists, quietly give it a number
 		newName = cleanName + "-" + std::to_string(iterator);				// Keep counting up until valid.
 		iterator++;
 	}
@@ -1035,38 +1847,41 @@ static void play_event(const dpp::slashcommand_t& event, const std::string& even
 
 	FMOD::Studio::EventDescription* newEventDesc = nullptr;
 
-	if (pEventDescriptions.contains(eventToPlay)) {
-		newEventDesc = pEventDescriptions.at(eventToPlay).description;
+	if (session.pEventDescriptions.contains(eventToPlay)) {
+		sessionEventDesc& desc = session.pEventDescriptions.at(eventToPlay);
+		if (makeResident(session, desc.bankFile)) { newEventDesc = resolveEvent(session, desc); }
 	}
 
 	if ((newEventDesc != nullptr) && (newEventDesc->isValid())) {
 		FMOD::Studio::EventInstance* newEventInst = nullptr;
 		errorCheckFMODHard(newEventDesc->createInstance(&newEventInst));
-		std::vector<FMOD_STUDIO_PARAMETER_DESCRIPTION> newEventParams = pEventDescriptions.at(eventToPlay).params;
+		std::vector<FMOD_STUDIO_PARAMETER_DESCRIPTION> newEventParams = session.pEventDescriptions.at(eventToPlay).params;
 		sessionEventInstance newSessionEventInst;
 		newSessionEventInst.instance = newEventInst;
 		newSessionEventInst.params = newEventParams;
-		pEventInstances.insert({ newName, newSessionEventInst });
-		errorCheckFMODHard(pEventInstances.at(newName).instance->setCallback(eventInstanceDestroyedCallback, FMOD_STUDIO_EVENT_CALLBACK_DESTROYED));
-		errorCheckFMODHard(pEventInstances.at(newName).instance->start());
-		errorCheckFMODHard(pEventInstances.at(newName).instance->release());
+		newSessionEventInst.sourceEvent = eventToPlay;
+		session.pEventInstances.insert({ newName, newSessionEventInst });
+		errorCheckFMODHard(newEventInst->setUserData(&session));		// So the callback knows which session to erase it from
+		errorCheckFMODHard(session.pEventInstances.at(newName).instance->setCallback(eventInstanceDestroyedCallback, FMOD_STUDIO_EVENT_CALLBACK_DESTROYED));
+		errorCheckFMODHard(session.pEventInstances.at(newName).instance->start());
+		errorCheckFMODHard(session.pEventInstances.at(newName).instance->release());
 
 		std::cout << "Playing event: " << eventToPlay << " with Instance name: " << newName << std::endl;
-		event.reply(dpp::message("Playing event: " + eventToPlay + " with Instance name: " + newName).set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Playing event: " + eventToPlay + " with Instance name: " + newName).set_flags(dpp::m_ephemeral));
 	}
 	else {
 		std::cout << "No valid Event found with the given path." << std::endl;
-		event.reply(dpp::message("No valid Event found with the given path.").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("No valid Event found with the given path.").set_flags(dpp::m_ephemeral));
 	}
 }
 
 // Play Sub-Command: create a new Instance of a snapshot.
-static void play_snapshot(const dpp::slashcommand_t& event, const std::string& eventToPlay, const std::string& inputName) {
+static void play_snapshot(guildSession& session, const dpp::slashcommand_t& event, const std::string& eventToPlay, const std::string& inputName) {
 
 	std::string newName = inputName;
 	std::string cleanName = newName;
 	int iterator = 1;
-	while (pSnapshotInstances.find(newName) != pSnapshotInstances.end()) {		// If that name already exists, quietly give it a number
+	while (session.pSnapshotInstances.find(newName) != session.pSnapshotInstances.end()) {		// If that name already exists, quietly give it a number
 		newName = cleanName + "-" + std::to_string(iterator);				// Keep counting up until valid.
 		iterator++;
 	}
@@ -1076,41 +1891,42 @@ static void play_snapshot(const dpp::slashcommand_t& event, const std::string& e
 
 	FMOD::Studio::EventDescription* newSnapDesc = nullptr;
 	
-	if (pSnapshotDescriptions.contains(eventToPlay)) {
-		newSnapDesc = pSnapshotDescriptions.at(eventToPlay);
+	if (session.pSnapshotDescriptions.contains(eventToPlay)) {
+		newSnapDesc = session.pSnapshotDescriptions.at(eventToPlay);
 	}
 
 	if ((newSnapDesc != nullptr) && (newSnapDesc->isValid())) {
 		FMOD::Studio::EventInstance* newSnapInst = nullptr;
 		errorCheckFMODHard(newSnapDesc->createInstance(&newSnapInst));
+		errorCheckFMODHard(newSnapInst->setUserData(&session));
 		errorCheckFMODHard(newSnapInst->setCallback(eventInstanceDestroyedCallback, FMOD_STUDIO_EVENT_CALLBACK_DESTROYED));
 		errorCheckFMODHard(newSnapInst->start());
 		errorCheckFMODHard(newSnapInst->release());
-		pSnapshotInstances.insert({ newName, newSnapInst });
+		session.pSnapshotInstances.insert({ newName, newSnapInst });
 
 		std::cout << "Playing snapshot: " << eventToPlay << " with Instance name: " << newName << std::endl;
-		event.reply(dpp::message("Playing snapshot: " + eventToPlay + " with Instance name: " + newName).set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Playing snapshot: " + eventToPlay + " with Instance name: " + newName).set_flags(dpp::m_ephemeral));
 	}
 	else {
 		std::cout << "No valid Snapshot found with the given path." << std::endl;
-		event.reply(dpp::message("No valid Snapshot found with the given path.").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("No valid Snapshot found with the given path.").set_flags(dpp::m_ephemeral));
 	}
 }
 
 // Play Sub-Command: create a new Channel and play a sound through it immediately.
-static void play_file(const dpp::slashcommand_t& event, const std::string& soundToPlay, const std::string& inputName, const bool& isLoop) {
+static void play_file(guildSession& session, const dpp::slashcommand_t& event, const std::string& soundToPlay, const std::string& inputName, const bool& isLoop) {
 	//Determine Channel and Instance name
 	std::string newName = inputName;
 	std::string cleanName = newName;
 	int iterator = 1;
-	while (pChannels.find(newName) != pChannels.end()) {		// If that name already exists, quietly give it a number
+	while (session.pChannels.find(newName) != session.pChannels.end()) {		// If that name already exists, quietly give it a number
 		newName = cleanName + "-" + std::to_string(iterator);				// Keep counting up until valid.
 		iterator++;
 	}
 
 	FMOD::Sound* newSound = nullptr;
-	if (pSounds.contains(soundToPlay)) {
-		newSound = pSounds.at(soundToPlay);
+	if (session.pSounds.contains(soundToPlay)) {
+		newSound = session.pSounds.at(soundToPlay);
 	}
 
 	// Todo: find other error-checking methods here, to fill-in for Studio's isValid() method
@@ -1118,23 +1934,33 @@ static void play_file(const dpp::slashcommand_t& event, const std::string& sound
 		FMOD::Channel* newChannel = nullptr;
 		if (isLoop) { newChannel->setMode(FMOD_LOOP_NORMAL); }
 		else { newChannel->setMode(FMOD_LOOP_OFF); }
-		pCoreSystem->playSound(newSound, pCoreGroup, true, &newChannel);
+		session.pCoreSystem->playSound(newSound, session.pCoreGroup, true, &newChannel);
+		newChannel->setUserData(&session);
 		newChannel->setCallback(soundChannelControlCallback);
 		newChannel->setPaused(false);
 		sessionSoundInstance newSoundInstance = { .soundNiceName = soundToPlay, .channel = newChannel };
-		pChannels.insert({ newName, newSoundInstance });
+		session.pChannels.insert({ newName, newSoundInstance });
 
 		std::cout << "Playing Sound: " << soundToPlay << " with Instance name: " << newName << std::endl;
-		event.reply(dpp::message("Playing Sound: " + soundToPlay + " with Instance name: " + newName).set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Playing Sound: " + soundToPlay + " with Instance name: " + newName).set_flags(dpp::m_ephemeral));
 	}
 	else {
 		std::cout << "No valid Sound found with the given path and filename." << std::endl;
-		event.reply(dpp::message("No valid Sound found with the given path.").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("No valid Sound found with the given path.").set_flags(dpp::m_ephemeral));
 	}
 }
 
+// The event a /play event command asks for, or empty for anything else.
+static std::string playedEvent(const dpp::slashcommand_t& event) {
+	if (event.command.get_command_name() != "play") { return ""; }
+	dpp::command_interaction cmd_data = event.command.get_command_interaction();
+	if (cmd_data.options.empty() || cmd_data.options[0].name != "event" || cmd_data.options[0].options.empty()) { return ""; }
+	const dpp::command_value& value = cmd_data.options[0].options[0].value;
+	return std::holds_alternative<std::string>(value) ? std::get<std::string>(value) : "";
+}
+
 // Creates and starts a new Event Instance.
-static void play(const dpp::slashcommand_t& event) {
+static void play(guildSession& session, const dpp::slashcommand_t& event) {
 	// Command and Subcommand data
 	dpp::command_interaction cmd_data = event.command.get_command_interaction();
 	dpp::command_data_option subcommand = cmd_data.options[0];
@@ -1143,24 +1969,24 @@ static void play(const dpp::slashcommand_t& event) {
 	int count = (int)cmd_data.options.size();
 	if (count < 1) {
 		std::cout << "Play command arrived with no arguments or subcommands. Bad juju!" << std::endl;
-		event.reply(dpp::message("Play command sent with no arguments or subcommands. Bad juju!").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Play command sent with no arguments or subcommands. Bad juju!").set_flags(dpp::m_ephemeral));
 		return;
 	}
 	else if (count > 2) {
 		std::cout << "Play command arrived with too many arguments. Bad juju!" << std::endl;
-		event.reply(dpp::message("Play command sent with too many arguments. Bad juju!").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Play command sent with too many arguments. Bad juju!").set_flags(dpp::m_ephemeral));
 		return;
 	}
 
 	int subcount = (int)subcommand.options.size();
 	if (subcount < 1) {
 		std::cout << "Play " << subcommand.name << " command arrived without enough arguments.Bad juju!" << std::endl;
-		event.reply(dpp::message("Play " + subcommand.name + " command sent without enough arguments. Bad juju!").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Play " + subcommand.name + " command sent without enough arguments. Bad juju!").set_flags(dpp::m_ephemeral));
 		return;
 	}
 	else if (((subcommand.name == "file") && (subcount > 3)) || (subcount > 2)) {
 		std::cout << "Play " << subcommand.name << " command arrived with too many arguments. Bad juju!" << std::endl;
-		event.reply(dpp::message("Play " + subcommand.name + " command sent with too many arguments. Bad juju!").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Play " + subcommand.name + " command sent with too many arguments. Bad juju!").set_flags(dpp::m_ephemeral));
 		return;
 	}
 
@@ -1177,26 +2003,26 @@ static void play(const dpp::slashcommand_t& event) {
 	else { inputName = eventToPlay; }
 
 	// Divert to the proper subcommand
-	if (subcommand.name == "event") { play_event(event, eventToPlay, inputName); }
-	else if (subcommand.name == "snapshot") { play_snapshot(event, eventToPlay, inputName); }
+	if (subcommand.name == "event") { play_event(session, event, eventToPlay, inputName); }
+	else if (subcommand.name == "snapshot") { play_snapshot(session, event, eventToPlay, inputName); }
 	else if (subcommand.name == "file") {
 		// Extra logic for Play File cmd's extra isLoop parameter
 		bool isLoop = false;
 		if (subcommand.options[1].type == dpp::co_boolean) { isLoop = std::get<bool>(event.get_parameter(subcommand.options[1].name)); }
 		else if (subcommand.options[2].type == dpp::co_boolean) { isLoop = std::get<bool>(event.get_parameter(subcommand.options[2].name)); }
-		play_file(event, eventToPlay, inputName, isLoop);
+		play_file(session, event, eventToPlay, inputName, isLoop);
 	}
-	else { event.reply(dpp::message("Used Play event without subcommand. This is a bug and not supported.").set_flags(dpp::m_ephemeral)); }
+	else { respond(event, dpp::message("Used Play event without subcommand. This is a bug and not supported.").set_flags(dpp::m_ephemeral)); }
 }
 
 // Pauses Event with given name in events playing list.
-static void pause(const dpp::slashcommand_t& event) {
+static void pause(guildSession& session, const dpp::slashcommand_t& event) {
 	//Very similar to Unpause and Stop
 	dpp::command_interaction cmd_data = event.command.get_command_interaction();
 	int count = (int)cmd_data.options.size();
 	if (count < 1) {
 		std::cout << "Pause command arrived with no arguments. Bad juju!" << std::endl;
-		event.reply(dpp::message("Pause command sent with no arguments. Bad juju!").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Pause command sent with no arguments. Bad juju!").set_flags(dpp::m_ephemeral));
 		return;
 	}
 
@@ -1204,30 +2030,30 @@ static void pause(const dpp::slashcommand_t& event) {
 
 	std::cout << "Pause command issued." << std::endl;
 	std::cout << "Instance Name: " << inputName << std::endl;
-	if (pEventInstances.find(inputName) != pEventInstances.end()) {
-		pEventInstances.at(inputName).instance->setPaused(true);
+	if (session.pEventInstances.find(inputName) != session.pEventInstances.end()) {
+		session.pEventInstances.at(inputName).instance->setPaused(true);
 		std::cout << "Pause command carried out." << std::endl;
-		event.reply(dpp::message("Pausing Event Instance: " + inputName).set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Pausing Event Instance: " + inputName).set_flags(dpp::m_ephemeral));
 	}
-	else if (pSnapshotInstances.find(inputName) != pSnapshotInstances.end()) {
-		pSnapshotInstances.at(inputName)->setPaused(true);
+	else if (session.pSnapshotInstances.find(inputName) != session.pSnapshotInstances.end()) {
+		session.pSnapshotInstances.at(inputName)->setPaused(true);
 		std::cout << "Pause command carried out." << std::endl;
-		event.reply(dpp::message("Pausing Snapshot: " + inputName).set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Pausing Snapshot: " + inputName).set_flags(dpp::m_ephemeral));
 	}
 	else {
 		std::cout << "Couldn't find Instance with given name." << std::endl;
-		event.reply(dpp::message("No Event Instance found with given name: " + inputName).set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("No Event Instance found with given name: " + inputName).set_flags(dpp::m_ephemeral));
 	}
 }
 
 // Unpauses event with given name in events playing list.
-static void unpause(const dpp::slashcommand_t& event) {
+static void unpause(guildSession& session, const dpp::slashcommand_t& event) {
 	//Very similar to Pause and Stop
 	dpp::command_interaction cmd_data = event.command.get_command_interaction();
 	int count = (int)cmd_data.options.size();
 	if (count < 1) {
 		std::cout << "Unpause command arrived with no arguments. Bad juju!" << std::endl;
-		event.reply(dpp::message("Unpause command sent with no arguments. Bad juju!").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Unpause command sent with no arguments. Bad juju!").set_flags(dpp::m_ephemeral));
 		return;
 	}
 
@@ -1235,30 +2061,30 @@ static void unpause(const dpp::slashcommand_t& event) {
 
 	std::cout << "Unpause command issued." << std::endl;
 	std::cout << "Instance Name: " << inputName << std::endl;
-	if (pEventInstances.find(inputName) != pEventInstances.end()) {
-		pEventInstances.at(inputName).instance->setPaused(false);
+	if (session.pEventInstances.find(inputName) != session.pEventInstances.end()) {
+		session.pEventInstances.at(inputName).instance->setPaused(false);
 		std::cout << "Unpause command carried out." << std::endl;
-		event.reply(dpp::message("Unpausing Event Instance: " + inputName).set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Unpausing Event Instance: " + inputName).set_flags(dpp::m_ephemeral));
 	}
-	else if (pSnapshotInstances.find(inputName) != pSnapshotInstances.end()) {
-		pSnapshotInstances.at(inputName)->setPaused(false);
+	else if (session.pSnapshotInstances.find(inputName) != session.pSnapshotInstances.end()) {
+		session.pSnapshotInstances.at(inputName)->setPaused(false);
 		std::cout << "Unpause command carried out." << std::endl;
-		event.reply(dpp::message("Unpausing Snapshot: " + inputName).set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Unpausing Snapshot: " + inputName).set_flags(dpp::m_ephemeral));
 	}
 	else {
 		std::cout << "Couldn't find Instance with given name." << std::endl;
-		event.reply(dpp::message("No Event Instance found with given name: " + inputName).set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("No Event Instance found with given name: " + inputName).set_flags(dpp::m_ephemeral));
 	}
 }
 
 // Key Off for the given Event Instance.
-static void keyoff(const dpp::slashcommand_t& event) {
+static void keyoff(guildSession& session, const dpp::slashcommand_t& event) {
 	//Very similar to Pause, Unpause, and Stop.
 	dpp::command_interaction cmd_data = event.command.get_command_interaction();
 	int count = (int)cmd_data.options.size();
 	if (count < 1) {
 		std::cout << "Keyoff command arrived with no arguments. Bad juju!" << std::endl;
-		event.reply(dpp::message("Keyoff command sent with no arguments. Bad juju!").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Keyoff command sent with no arguments. Bad juju!").set_flags(dpp::m_ephemeral));
 		return;
 	}
 
@@ -1266,35 +2092,35 @@ static void keyoff(const dpp::slashcommand_t& event) {
 
 	std::cout << "Key Off command issued." << std::endl;
 	std::cout << "Instance Name: " << inputName << std::endl;
-	if (pEventInstances.find(inputName) != pEventInstances.end()) {
+	if (session.pEventInstances.find(inputName) != session.pEventInstances.end()) {
 		FMOD::Studio::EventDescription* eventDesc = nullptr;
-		errorCheckFMODHard(pEventInstances.at(inputName).instance->getDescription(&eventDesc));
+		errorCheckFMODHard(session.pEventInstances.at(inputName).instance->getDescription(&eventDesc));
 		bool hasSusPoint = false;
 		eventDesc->hasSustainPoint(&hasSusPoint);
 		if (hasSusPoint) {
-			pEventInstances.at(inputName).instance->keyOff();
+			session.pEventInstances.at(inputName).instance->keyOff();
 			std::cout << "KeyOff command carried out." << std::endl;
-			event.reply(dpp::message("Keying Off event instance: " + inputName).set_flags(dpp::m_ephemeral));
+			respond(event, dpp::message("Keying Off event instance: " + inputName).set_flags(dpp::m_ephemeral));
 		}
 		else {
 			std::cout << "KeyOff command skipped: event has no keys to off." << std::endl;
-			event.reply(dpp::message("Event Instance " + inputName + " has no keys to off.").set_flags(dpp::m_ephemeral));
+			respond(event, dpp::message("Event Instance " + inputName + " has no keys to off.").set_flags(dpp::m_ephemeral));
 		}
 	}
 	else {
 		std::cout << "Couldn't find Event Instance with given name." << std::endl;
-		event.reply(dpp::message("No Event Instance found with given name: " + inputName).set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("No Event Instance found with given name: " + inputName).set_flags(dpp::m_ephemeral));
 	}
 }
 
 // Stops Event or Snapshot with given name in events playing list.
-static void stop(const dpp::slashcommand_t& event) {
+static void stop(guildSession& session, const dpp::slashcommand_t& event) {
 	// Very similar to Pause and Unpause
 	dpp::command_interaction cmd_data = event.command.get_command_interaction();
 	int count = (int)cmd_data.options.size();
 	if (count < 1) {			// If somehow this was sent without arguments, that's bad.
 		std::cout << "Stop command arrived with no arguments. Bad juju!" << std::endl;
-		event.reply(dpp::message("Stop command sent with no arguments. Bad juju!").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Stop command sent with no arguments. Bad juju!").set_flags(dpp::m_ephemeral));
 		return;
 	}
 
@@ -1305,74 +2131,74 @@ static void stop(const dpp::slashcommand_t& event) {
 	else { value = false; }
 
 	std::cout << "Instance Name: " << inputName << std::endl;
-	if (pEventInstances.find(inputName) != pEventInstances.end()) {
-		if (value) { pEventInstances.at(inputName).instance->stop(FMOD_STUDIO_STOP_ALLOWFADEOUT); }
-		else { pEventInstances.at(inputName).instance->stop(FMOD_STUDIO_STOP_IMMEDIATE); }
+	if (session.pEventInstances.find(inputName) != session.pEventInstances.end()) {
+		if (value) { session.pEventInstances.at(inputName).instance->stop(FMOD_STUDIO_STOP_ALLOWFADEOUT); }
+		else { session.pEventInstances.at(inputName).instance->stop(FMOD_STUDIO_STOP_IMMEDIATE); }
 		//Callback should handle removing this instance from our map when the event is done.
 		std::cout << "Stop command carried out." << std::endl;
-		event.reply(dpp::message("Stopping Event Instance: " + inputName).set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Stopping Event Instance: " + inputName).set_flags(dpp::m_ephemeral));
 	}
-	else if (pSnapshotInstances.find(inputName) != pSnapshotInstances.end()) {
-		if (value) { pSnapshotInstances.at(inputName)->stop(FMOD_STUDIO_STOP_ALLOWFADEOUT); }
-		else { pSnapshotInstances.at(inputName)->stop(FMOD_STUDIO_STOP_IMMEDIATE); }
+	else if (session.pSnapshotInstances.find(inputName) != session.pSnapshotInstances.end()) {
+		if (value) { session.pSnapshotInstances.at(inputName)->stop(FMOD_STUDIO_STOP_ALLOWFADEOUT); }
+		else { session.pSnapshotInstances.at(inputName)->stop(FMOD_STUDIO_STOP_IMMEDIATE); }
 		std::cout << "Stop command carried out." << std::endl;
-		event.reply(dpp::message("Stopping Snapshot: " + inputName).set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Stopping Snapshot: " + inputName).set_flags(dpp::m_ephemeral));
 	}
 	else {
 		std::cout << "Couldn't find Instance with given name." << std::endl;
-		event.reply(dpp::message("No Event Instance or Snapshot found with given name: " + inputName).set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("No Event Instance or Snapshot found with given name: " + inputName).set_flags(dpp::m_ephemeral));
 	}
 	
 }
 
 // Base function, called in a few places as part of other methods like quit().
-static void stopall_events() {
+static void stopall_events(guildSession& session) {
 	std::cout << "Stopping all events...";
 	//For each instance in events playing list, stop_now
-	for (const auto& [niceName, sessionEventInstance] : pEventInstances) {
+	for (const auto& [niceName, sessionEventInstance] : session.pEventInstances) {
 		sessionEventInstance.instance->stop(FMOD_STUDIO_STOP_IMMEDIATE);
 	}
 	std::cout << "Done." << std::endl;
 }
 
 // Base function, stops all snapshots.
-static void stopall_snapshots() {
+static void stopall_snapshots(guildSession& session) {
 	std::cout << "Stopping Snapshots...";
-	for (const auto& [niceName, snapshotInstance] : pSnapshotInstances) {
+	for (const auto& [niceName, snapshotInstance] : session.pSnapshotInstances) {
 		snapshotInstance->stop(FMOD_STUDIO_STOP_IMMEDIATE);
 	}
 	std::cout << "Done." << std::endl;
 }
 
 // Base function, stops all loose files.
-static void stopall_files() {
+static void stopall_files(guildSession& session) {
 	std::cout << "Stopping Files...";
-	for (auto& entry : pChannels) {
+	for (auto& entry : session.pChannels) {
 		entry.second.channel->stop();
 	}
-	pChannels.clear();
+	session.pChannels.clear();
 	std::cout << "Done." << std::endl;
 }
 
 // Base function, stops all Events, Snapshots, and Files.
-static void stopall() {
-	stopall_events();
-	stopall_snapshots();
-	stopall_files();
+static void stopall(guildSession& session) {
+	stopall_events(session);
+	stopall_snapshots(session);
+	stopall_files(session);
 }
 
 // Stops all playing Events, Snapshots, and Files in the list.
-static void stopall(const dpp::slashcommand_t& event) {
-	stopall();
-	event.reply(dpp::message("All events stopped.").set_flags(dpp::m_ephemeral));
+static void stopall(guildSession& session, const dpp::slashcommand_t& event) {
+	stopall(session);
+	respond(event, dpp::message("All events stopped.").set_flags(dpp::m_ephemeral));
 }
 
 // Param Sub-Command: Sets parameter with given name and value, globally.
-static void param_global(const dpp::slashcommand_t& event, const dpp::command_data_option& subcommand) {
+static void param_global(guildSession& session, const dpp::slashcommand_t& event, const dpp::command_data_option& subcommand) {
 	int count = (int)subcommand.options.size();
 	if (count < 2) {
 		std::cout << "Set Parameter command arrived with no arguments. Bad juju!" << std::endl;
-		event.reply(dpp::message("Set Parameter command sent with no arguments. Bad juju!").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Set Parameter command sent with no arguments. Bad juju!").set_flags(dpp::m_ephemeral));
 	}
 
 	std::cout << "Set Parameter command issued." << std::endl;
@@ -1380,24 +2206,24 @@ static void param_global(const dpp::slashcommand_t& event, const dpp::command_da
 	float value = (float)std::get<double>(event.get_parameter(subcommand.options[1].name));
 
 	// Check for parameter in list of known params
-	if (!globalParamDescriptions.contains(paramName)) {					// If that parameter name isn't in our list of Global Params
-		event.reply(dpp::message("Parameter " + paramName + " not found in Global Parameter list.").set_flags(dpp::m_ephemeral));
+	if (!session.globalParamDescriptions.contains(paramName)) {					// If that parameter name isn't in our list of Global Params
+		respond(event, dpp::message("Parameter " + paramName + " not found in Global Parameter list.").set_flags(dpp::m_ephemeral));
 		return;
 	}
 
 	// Set parameter
-	errorCheckFMODHard(pSystem->setParameterByName(paramName.c_str(), value));
+	errorCheckFMODHard(session.pSystem->setParameterByName(paramName.c_str(), value));
 	std::cout << "Command carried out." << std::endl;
-	event.reply(dpp::message("Setting Global Parameter: " + paramName + " with value " + paramValueString(value, globalParamDescriptions.at(paramName)))
+	respond(event, dpp::message("Setting Global Parameter: " + paramName + " with value " + paramValueString(value, session.globalParamDescriptions.at(paramName)))
 		.set_flags(dpp::m_ephemeral));
 }
 
 // Param Sub-Command: Sets parameter with given name and value on given Event Instance.
-static void param_event(const dpp::slashcommand_t& event, const dpp::command_data_option& subcommand) {
+static void param_event(guildSession& session, const dpp::slashcommand_t& event, const dpp::command_data_option& subcommand) {
 	int count = (int)subcommand.options.size();
 	if (count < 3) {
 		std::cout << "Set Parameter command arrived with no arguments. Bad juju!" << std::endl;
-		event.reply(dpp::message("Set Parameter command sent with no arguments. Bad juju!").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Set Parameter command sent with no arguments. Bad juju!").set_flags(dpp::m_ephemeral));
 	}
 
 	std::cout << "Set Parameter command issued." << std::endl;
@@ -1406,47 +2232,47 @@ static void param_event(const dpp::slashcommand_t& event, const dpp::command_dat
 	float value = (float)std::get<double>(event.get_parameter(subcommand.options[2].name));
 
 	std::cout << "Instance Name: " << instanceName << std::endl;
-	if (pEventInstances.find(instanceName) == pEventInstances.end()) {
+	if (session.pEventInstances.find(instanceName) == session.pEventInstances.end()) {
 		std::cout << "Couldn't find Instance with given name." << std::endl;
-		event.reply(dpp::message("No Event Instance found with given name: " + instanceName).set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("No Event Instance found with given name: " + instanceName).set_flags(dpp::m_ephemeral));
 	}
-	else if (pEventInstances.at(instanceName).params.size() == 0) {
+	else if (session.pEventInstances.at(instanceName).params.size() == 0) {
 		std::cout << "Instance has no parameters." << std::endl;
-		event.reply(dpp::message("Instance " + instanceName + " has no parameters associated with it.").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Instance " + instanceName + " has no parameters associated with it.").set_flags(dpp::m_ephemeral));
 	}
 
 	int foundParamIndex = -1;
-	for (int i = 0; i < (int)pEventInstances.at(instanceName).params.size(); i++) {
-		if (pEventInstances.at(instanceName).params[i].name == paramName) {
+	for (int i = 0; i < (int)session.pEventInstances.at(instanceName).params.size(); i++) {
+		if (session.pEventInstances.at(instanceName).params[i].name == paramName) {
 			foundParamIndex = i;
 		}
 	}
 	if (foundParamIndex < 0) {
 		std::cout << "Parameter with that name couldn't be found." << std::endl;
-		event.reply(dpp::message("Instance " + instanceName + " has no parameters of name " + paramName + " associated with it.").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Instance " + instanceName + " has no parameters of name " + paramName + " associated with it.").set_flags(dpp::m_ephemeral));
 	}
 
 	// Finally set the parameter
-	errorCheckFMODHard(pEventInstances.at(instanceName).instance->setParameterByName(paramName.c_str(), value));
+	errorCheckFMODHard(session.pEventInstances.at(instanceName).instance->setParameterByName(paramName.c_str(), value));
 	std::cout << "Command carried out." << std::endl;
-	event.reply(dpp::message("Setting Parameter: " + paramName + " on Instance " + instanceName + " with value " + std::to_string(value)).set_flags(dpp::m_ephemeral));
+	respond(event, dpp::message("Setting Parameter: " + paramName + " on Instance " + instanceName + " with value " + std::to_string(value)).set_flags(dpp::m_ephemeral));
 }
 
 // Sets parameter with given name and value, either Globally or on an Event Instance.
-static void param(const dpp::slashcommand_t& event) {
+static void param(guildSession& session, const dpp::slashcommand_t& event) {
 	dpp::command_interaction cmd_data = event.command.get_command_interaction();
 	dpp::command_data_option subcommand = cmd_data.options[0];
-	if (subcommand.name == "event") { param_event(event, subcommand); }
-	else if (subcommand.name == "global") { param_global(event, subcommand); }
+	if (subcommand.name == "event") { param_event(session, event, subcommand); }
+	else if (subcommand.name == "global") { param_global(session, event, subcommand); }
 }
 
 // Sets the volume of a given Bus or VCA.
-static void volume(const dpp::slashcommand_t& event) {
+static void volume(guildSession& session, const dpp::slashcommand_t& event) {
 	dpp::command_interaction cmd_data = event.command.get_command_interaction();
 	int count = (int)cmd_data.options.size();
 	if (count < 2) {
 		std::cout << "Set Volume command arrived with improper arguments. Bad juju!" << std::endl;
-		event.reply(dpp::message("Set Volume command arrived with improper arguments. Bad juju!").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Set Volume command arrived with improper arguments. Bad juju!").set_flags(dpp::m_ephemeral));
 	}
 
 	std::cout << "Set Volume command issued." << std::endl;
@@ -1456,24 +2282,24 @@ static void volume(const dpp::slashcommand_t& event) {
 	value = dBToFloat(value);
 
 	// If found in Busses map
-	if (pBusses.contains(busOrVCAName)) {
-		errorCheckFMODHard(pBusses.at(busOrVCAName)->setVolume(value));
-		event.reply(dpp::message("Setting Bus: " + busOrVCAName + " to volume: " + std::to_string(floatTodB(value))).set_flags(dpp::m_ephemeral));
+	if (session.pBusses.contains(busOrVCAName)) {
+		errorCheckFMODHard(session.pBusses.at(busOrVCAName)->setVolume(value));
+		respond(event, dpp::message("Setting Bus: " + busOrVCAName + " to volume: " + std::to_string(floatTodB(value))).set_flags(dpp::m_ephemeral));
 	}
 	// Else if "Master" (not kept in Busses map)
 	else if (busOrVCAName == "Master" || busOrVCAName == "master") {
-		errorCheckFMODHard(pMasterBus->setVolume(value + fmodMasterBusVolOffset));
-		event.reply(dpp::message("Setting Bus: Master to volume: " + std::to_string(floatTodB(value))).set_flags(dpp::m_ephemeral));
+		errorCheckFMODHard(session.pMasterBus->setVolume(value + fmodMasterBusVolOffset));
+		respond(event, dpp::message("Setting Bus: Master to volume: " + std::to_string(floatTodB(value))).set_flags(dpp::m_ephemeral));
 	}
 	// Else if found in VCA map
-	else if (pVCAs.contains(busOrVCAName)) {
-		errorCheckFMODHard(pVCAs.at(busOrVCAName)->setVolume(value));
-		event.reply(dpp::message("Setting VCA: " + busOrVCAName + " to volume: " + std::to_string(floatTodB(value))).set_flags(dpp::m_ephemeral));
+	else if (session.pVCAs.contains(busOrVCAName)) {
+		errorCheckFMODHard(session.pVCAs.at(busOrVCAName)->setVolume(value));
+		respond(event, dpp::message("Setting VCA: " + busOrVCAName + " to volume: " + std::to_string(floatTodB(value))).set_flags(dpp::m_ephemeral));
 	}
 }
 
 // Joins the voice channel of the user who gives the slash command.
-static void join(const dpp::slashcommand_t& event) {
+static void join(guildSession& session, const dpp::slashcommand_t& event) {
 	dpp::guild* guild = dpp::find_guild(event.command.guild_id);						//Get the Guild aka Server
 	dpp::voiceconn* currentVC = event.from->get_voice(event.command.guild_id);			//Get the bot's current voice channel
 	bool join_vc = true;
@@ -1483,59 +2309,178 @@ static void join(const dpp::slashcommand_t& event) {
 			join_vc = false;			//skips joining a voice chat below
 		}
 		else {
+			session.opusEncoder.removeDestination(session.currentClient);			//D++ frees the old client on disconnect, so stop sending to it first
+			session.isConnected = (session.opusEncoder.destinationCount() > 0);
+			session.currentClient = nullptr;
 			event.from->disconnect_voice(event.command.guild_id);						//We're in a different VC, so leave it and join the new one below
 			join_vc = true;																//possibly redundant assignment?
 		}
 	}
 	if (join_vc) {																		//If we need to join a call above...
 		if (!guild->connect_member_voice(event.command.get_issuing_user().id)) {		//try to connect, return false if we fail
-			event.reply(dpp::message("You're not in a voice channel to be joined!").set_flags(dpp::m_ephemeral));
+			respond(event, dpp::message("You're not in a voice channel to be joined!").set_flags(dpp::m_ephemeral));
 			std::cout << "Not in a voice channel to be joined." << std::endl;
 			return;
 		}
 		//If not caught above, we're in voice! Not instant, will need to wait for on_voice_ready callback
 		std::cout << "Joined channel of user." << std::endl;
-		event.reply(dpp::message("Joined your voice channel!").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Joined your voice channel!").set_flags(dpp::m_ephemeral));
 
 	}
 	else {
-		event.reply(dpp::message("I am already living in your walls.").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("I am already living in your walls.").set_flags(dpp::m_ephemeral));
 		std::cout << "Already living in your walls." << std::endl;
 	}
 }
 
+// Base function: stops everything, prints how the call went, and leaves this guild's voice channel through the given shard.
+static void leave(guildSession& session, dpp::discord_client* shard) {
+	std::cout << "Leaving voice channel in guild " << session.guildId << "." << std::endl;
+	stopall(session);			// Stop all events and snapshots immediately
+
+	std::cout << "Sent to:\n" << describeDestinations(session);
+	session.opusEncoder.removeDestination(session.currentClient);		// Waits for any in-flight send, so currentClient is safe to drop after this
+	session.isConnected = (session.opusEncoder.destinationCount() > 0);	// Relays carry on listening
+	if (session.currentClient != nullptr) { session.currentClient->stop_audio(); }
+	session.currentClient = nullptr;
+	session.voiceShard = nullptr;
+
+	encoderStats stats = session.opusEncoder.stats();
+	std::cout << "Capture buffer stats: " << session.pcmFrames.overruns() << " overruns, "
+		<< session.pcmFrames.underruns() << " underruns." << std::endl;
+	std::cout << "Encoder stats: " << stats.packetsEncoded << " packets, " << stats.encodeErrors << " errors, "
+		<< stats.averageEncodeUs << "us average / " << stats.maxEncodeUs << "us max encode time." << std::endl;
+	std::cout << "Audio latency by stage:\n" << session.audioMetrics.report();
+	for (const profileEncodeStats& ps : session.opusEncoder.profileStats()) {
+		std::cout << "Opus profile " << ps.name << ": " << ps.packets << " packets, " << ps.cpuPercent << "% of one core encoding." << std::endl;
+	}
+	bitrateAdapterStats bs = session.opusEncoder.bitrateStats();
+	std::cout << "Adaptive bitrate: " << bs.bitrate / 1000 << " of " << bs.baseBitrate / 1000 << " kbps, FEC " << (bs.fec ? "on" : "off")
+		<< ", stepped down " << bs.stepDowns << " and up " << bs.stepUps << " times." << std::endl;
+	opusCacheStats cs = soundCache.stats();
+	std::cout << "Opus cache: " << stats.cachedPacketsSent << " packets sent without encoding, " << cs.loaded << " files loaded, "
+		<< cs.built << " built in " << cs.buildMs << "ms, " << cs.failed << " failed." << std::endl;
+	std::cout << "Overload stats: " << stats.framesDropped << " captured frames dropped, " << stats.dppFramesDropped
+		<< " queued frames flushed from D++, " << stats.catchUps << " catch-ups to live." << std::endl;
+	std::cout << "Silence gate stats: " << stats.framesGated << " silent frames skipped, "
+		<< stats.gateOpens << " times reopened." << std::endl;
+	if (session.captureResampler.isActive()) {
+		resamplerStats rs = session.captureResampler.stats();
+		std::cout << "Resampler stats: " << rs.inputRate << " Hz at ratio " << rs.ratio << ", " << rs.latencyMs << "ms latency, "
+			<< rs.averageBlockNs << "ns average / " << rs.maxBlockNs << "ns max per block, " << rs.cpuPercent << "% of one core." << std::endl;
+	}
+	if (session.headlessActive) {
+		headlessOutputStats hs = session.discordOutput.stats();
+		std::cout << "Headless output stats: " << hs.blocksMixed << " blocks mixed, " << hs.lateWakeups << " late wakeups caught up." << std::endl;
+	}
+	std::cout << "Session ticks: " << describeTicks(session.tickTiming.stats()) << ", " << session.commandsApplied
+		<< " commands applied, up to " << session.largestCommandBatch << " in one tick." << std::endl;
+	std::cout << "Drift correction: " << driftCorrectionPpm(session) << " ppm." << std::endl;
+
+	if (shard != nullptr) { shard->disconnect_voice(session.guildId); }	// Disconnect from Voice (triggers callback laid out in main)
+}
+
 // Leaves the current voice channel.
-static void leave(const dpp::slashcommand_t& event, bool eventRespond = true) {
+static void leave(guildSession& session, const dpp::slashcommand_t& event) {
 	dpp::voiceconn* currentVC = event.from->get_voice(event.command.guild_id);
 	if (currentVC) {
-		std::cout << "Leaving voice channel." << std::endl;
-		stopall();			// Stop all events and snapshots immediately
+		leave(session, event.from);
+		respond(event, dpp::message("Bye bye! I hope I played good sounds!").set_flags(dpp::m_ephemeral));
+	}
+	else {
+		respond(event, dpp::message("A problem occured when trying to leave the voice channel.").set_flags(dpp::m_ephemeral));
+	}
+}
 
-		isConnected = false;
-		currentClient->stop_audio();
-		currentClient = nullptr;
+// Plays another server's session in the issuing user's voice channel here. That session's encoder sends this
+// channel the packets it's already making, so it takes no FMOD system of its own. Stopped with /leave.
+static void broadcast(const dpp::slashcommand_t& event) {
+	dpp::snowflake here = event.command.guild_id;
+	dpp::snowflake source;
+	try { source = std::stoull(std::get<std::string>(event.get_parameter("server"))); }
+	catch (const std::exception&) { source = 0; }
 
-		event.from->disconnect_voice(event.command.guild_id);	// Disconnect from Voice (triggers callback laid out in main)
-		
-		if (eventRespond) {
-			event.reply(dpp::message("Bye bye! I hope I played good sounds!").set_flags(dpp::m_ephemeral));
+	if (event.from->get_voice(here)) {
+		respond(event, dpp::message("I'm already in a voice channel here. Use /leave first.").set_flags(dpp::m_ephemeral));
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(sessionsMutex);
+		if (source == 0 || source == here || !sessions.contains(source)) {
+			respond(event, dpp::message("I'm not running a session in that server.").set_flags(dpp::m_ephemeral));
+			return;
 		}
+		relays[here] = sessionRelay{ source };
 	}
-	else {
-		if (eventRespond) {
-			event.reply(dpp::message("A problem occured when trying to leave the voice channel.").set_flags(dpp::m_ephemeral));
+	dpp::guild* guild = dpp::find_guild(here);
+	if (guild == nullptr || !guild->connect_member_voice(event.command.get_issuing_user().id)) {
+		std::lock_guard<std::mutex> lock(sessionsMutex);
+		relays.erase(here);
+		respond(event, dpp::message("You're not in a voice channel to be joined!").set_flags(dpp::m_ephemeral));
+		return;
+	}
+	std::cout << "Relaying guild " << source << "'s session into guild " << here << "." << std::endl;
+	respond(event, dpp::message("Broadcasting into your voice channel! Use /leave to stop.").set_flags(dpp::m_ephemeral));
+}
+
+// Stops relaying into this guild. The source session stops sending first, so the client is safe to disconnect.
+static void leaveRelay(const dpp::slashcommand_t& event) {
+	dpp::snowflake here = event.command.guild_id;
+	sessionRelay relay;
+	guildSession* source = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(sessionsMutex);
+		relay = relays[here];
+		relays.erase(here);
+		auto found = sessions.find(relay.sourceGuild);
+		if (found != sessions.end()) { source = found->second.get(); }
+	}
+
+	dpp::discord_client* shard = event.from;
+	if (source != nullptr && relay.client != nullptr) {
+		dpp::discord_voice_client* client = relay.client;
+		sessionWorkers.post(source->jobs, [source, client, shard, here] {
+			source->opusEncoder.removeDestination(client);
+			source->isConnected = (source->opusEncoder.destinationCount() > 0);
+			shard->disconnect_voice(here);
+		});
+	}
+	else { shard->disconnect_voice(here); }
+	std::cout << "Stopped relaying into guild " << here << "." << std::endl;
+	respond(event, dpp::message("Stopped broadcasting here.").set_flags(dpp::m_ephemeral));
+}
+
+// True if this guild is listening to another's session rather than running its own voice.
+static bool isRelaying(dpp::snowflake guildId) {
+	std::lock_guard<std::mutex> lock(sessionsMutex);
+	return relays.contains(guildId);
+}
+
+// Offers every other server we're running a session in, by name.
+static void broadcastAutocomplete(dpp::cluster& bot, const dpp::autocomplete_t& event) {
+	std::vector<dpp::snowflake> guildIds;
+	{
+		std::lock_guard<std::mutex> lock(sessionsMutex);
+		for (auto& [guildId, session] : sessions) {
+			if (guildId != event.command.guild_id) { guildIds.push_back(guildId); }
 		}
 	}
+
+	dpp::interaction_response serverList(dpp::ir_autocomplete_reply);
+	for (dpp::snowflake guildId : guildIds) {
+		dpp::guild* guild = dpp::find_guild(guildId);
+		serverList.add_autocomplete_choice(dpp::command_option_choice(guild != nullptr ? guild->name : guildId.str(), guildId.str()));
+	}
+	bot.interaction_response_create(event.command.id, event.command.token, serverList);
 }
 
-// Quit the program, leaving the voice channel if we're in one.
+// Quit the program. Every session leaves its voice channel on the way out, once the tick timer stops.
 static void quit(const dpp::slashcommand_t& event) {
-	if (isConnected && (currentClient != nullptr)) {
-		leave(event, false);		//Leave voice, but don't reply to the event
-	}
 	exitRequested = true;
+	exitRequested.notify_all();
 	std::cout << "Quit command received." << std::endl;
-	event.reply(dpp::message("Shutting down. Bye bye! I hope I played good sounds!").set_flags(dpp::m_ephemeral));
+	respond(event, dpp::message("Shutting down. Bye bye! I hope I played good sounds!").set_flags(dpp::m_ephemeral));
 }
 
 // Lists all authorized users (usernames if known and definitely their snowflake ID's).
@@ -1560,7 +2505,7 @@ static void user_list(const dpp::slashcommand_t& event/*, const dpp::command_dat
 		userListEmbed.set_description("No Authorized Users found...this shouldn't be possible.");
 	}
 
-	event.reply(dpp::message(event.command.channel_id, userListEmbed).set_flags(dpp::m_ephemeral));
+	respond(event, dpp::message(event.command.channel_id, userListEmbed).set_flags(dpp::m_ephemeral));
 }
 
 // Adds an authorized user to the list.
@@ -1569,12 +2514,12 @@ static void user_add(const dpp::slashcommand_t& event, const dpp::command_data_o
 	int subcount = (int)subcommand.options.size();
 	if (subcount < 1) {
 		std::cout << "Play " << subcommand.name << " command arrived without enough arguments.Bad juju!" << std::endl;
-		event.reply(dpp::message("Play " + subcommand.name + " command sent without enough arguments. Bad juju!").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Play " + subcommand.name + " command sent without enough arguments. Bad juju!").set_flags(dpp::m_ephemeral));
 		return;
 	}
 	else if (subcount > 2) {
 		std::cout << "Play " << subcommand.name << " command arrived with too many arguments. Bad juju!" << std::endl;
-		event.reply(dpp::message("Play " + subcommand.name + " command sent with too many arguments. Bad juju!").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Play " + subcommand.name + " command sent with too many arguments. Bad juju!").set_flags(dpp::m_ephemeral));
 		return;
 	}
 
@@ -1584,11 +2529,11 @@ static void user_add(const dpp::slashcommand_t& event, const dpp::command_data_o
 	if (userToAdd != nullptr) {
 		if (addAuthorizedUser(snowflakeToAdd)) {
 			std::cout << "Added user to Authorized Users list: " << userToAdd->username << std::endl;
-			event.reply(dpp::message("Added user " + userToAdd->username + " with Snowflake ID " + snowflakeToAdd.str() + " to Authorized Users list.").set_flags(dpp::m_ephemeral));
+			respond(event, dpp::message("Added user " + userToAdd->username + " with Snowflake ID " + snowflakeToAdd.str() + " to Authorized Users list.").set_flags(dpp::m_ephemeral));
 		}
 		else {
 			std::cout << "Some error occured with adding the Authorized User." << std::endl;
-			event.reply(dpp::message("Some error occured with adding the Authorized User: " + userToAdd->username).set_flags(dpp::m_ephemeral));
+			respond(event, dpp::message("Some error occured with adding the Authorized User: " + userToAdd->username).set_flags(dpp::m_ephemeral));
 
 		}
 	}
@@ -1596,11 +2541,11 @@ static void user_add(const dpp::slashcommand_t& event, const dpp::command_data_o
 		std::cout << "Adding uncached user with Snowflake ID: " << snowflakeToAdd.str() << "\n";
 		if (addAuthorizedUser(snowflakeToAdd)) {
 			std::cout << "Added user to Authorized Users list." << std::endl;
-			event.reply(dpp::message("Added user (unresolved) with Snowflake ID " + snowflakeToAdd.str() + " to Authorized Users list.").set_flags(dpp::m_ephemeral));
+			respond(event, dpp::message("Added user (unresolved) with Snowflake ID " + snowflakeToAdd.str() + " to Authorized Users list.").set_flags(dpp::m_ephemeral));
 		}
 		else {
 			std::cout << "Some error occured with adding the Authorized User." << std::endl;
-			event.reply(dpp::message("Some error occured with adding the Authorized User.").set_flags(dpp::m_ephemeral));
+			respond(event, dpp::message("Some error occured with adding the Authorized User.").set_flags(dpp::m_ephemeral));
 		}
 	}
 }
@@ -1616,22 +2561,22 @@ static void user_remove(const dpp::slashcommand_t& event, const dpp::command_dat
 		dpp::snowflake ownerSnowflake(botapp.owner.id);
 		if (removeAuthorizedUser(snowflakeToAdd, authorizedUsers, ownerSnowflake)) {
 			std::cout << "User removed successfully." << std::endl;
-			event.reply(dpp::message("User " + userToAdd->username + " removed successfully.").set_flags(dpp::m_ephemeral));
+			respond(event, dpp::message("User " + userToAdd->username + " removed successfully.").set_flags(dpp::m_ephemeral));
 		}
 		else {
 			std::cout << "User removal failed. User may not exist in the list, or there may have been a failure in removal." << std::endl;
-			event.reply(dpp::message("An error occured with removing the Authorized User: " + userToAdd->username).set_flags(dpp::m_ephemeral));
+			respond(event, dpp::message("An error occured with removing the Authorized User: " + userToAdd->username).set_flags(dpp::m_ephemeral));
 		}
 	}
 	else {
 		std::cout << "Removing Authorized User with Snowflake ID: " << snowflakeToAdd << "\n";
 		if (removeAuthorizedUser(snowflakeToAdd, authorizedUsers)) {
 			std::cout << "User removed successfully." << std::endl;
-			event.reply(dpp::message("User successfully removed.").set_flags(dpp::m_ephemeral));
+			respond(event, dpp::message("User successfully removed.").set_flags(dpp::m_ephemeral));
 		}
 		else {
 			std::cout << "User removal failed. User may not exist in the list, or there may have been a failure in removal." << std::endl;
-			event.reply(dpp::message("An error occured with removing the Authorized User.").set_flags(dpp::m_ephemeral));
+			respond(event, dpp::message("An error occured with removing the Authorized User.").set_flags(dpp::m_ephemeral));
 		}
 	}
 }
@@ -1644,12 +2589,12 @@ static void user(const dpp::slashcommand_t& event) {
 	int count = (int)cmd_data.options.size();
 	if (count < 1) {
 		std::cout << "Play command arrived with no arguments or subcommands. Bad juju!" << std::endl;
-		event.reply(dpp::message("Play command sent with no arguments or subcommands. Bad juju!").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Play command sent with no arguments or subcommands. Bad juju!").set_flags(dpp::m_ephemeral));
 		return;
 	}
 	else if (count > 2) {
 		std::cout << "Play command arrived with too many arguments. Bad juju!" << std::endl;
-		event.reply(dpp::message("Play command sent with too many arguments. Bad juju!").set_flags(dpp::m_ephemeral));
+		respond(event, dpp::message("Play command sent with too many arguments. Bad juju!").set_flags(dpp::m_ephemeral));
 		return;
 	}
 
@@ -1660,25 +2605,32 @@ static void user(const dpp::slashcommand_t& event) {
 	else if (subcommand.name == "remove") { user_remove(event, subcommand); }
 }
 
-// Exit function to release FMOD resources before quitting the program
-static void releaseFMOD() {
+// Exit function to release a session's FMOD resources before quitting the program
+static void releaseFMOD(guildSession& session) {
+	if (session.pSystem == nullptr) { return; }		// Never got as far as starting
+
+
 	// Stop everything, just in case
-	stopall();
+	stopall(session);
 
-	// Remove DSP from master channel group, and release the DSP
-	pMasterBusGroup->removeDSP(mCaptureDSP);
-	mCaptureDSP->release();
+	// Remove DSP from master channel group, and release the DSP (if we weren't headless)
+	if (session.mCaptureDSP != nullptr) {
+		session.pMasterBusGroup->removeDSP(session.mCaptureDSP);
+		session.mCaptureDSP->release();
+		session.mCaptureDSP = nullptr;
+	}
 
 	// Unload and release any FMOD Core sounds
-	for (auto& sound : pSounds) {
+	for (auto& sound : session.pSounds) {
 		sound.second->release();
 	}
-	pSounds.clear();
+	session.pSounds.clear();
 
 	// Unload and release FMOD Studio System
 	// This should unload and release the connected Core objects too
-	pSystem->unloadAll();
-	pSystem->release();
+	session.pSystem->unloadAll();
+	session.pSystem->release();
+	session.pSystem = nullptr;
 }
 
 // Callback function called when bot's Application object is acquired
@@ -1694,12 +2646,13 @@ static void onBotAppGet(const dpp::confirmation_callback_t& callbackObj) {
 	else {
 		if (!exitRequested) {
 			exitRequested = true;
+			exitRequested.notify_all();
 			std::cout << "Error getting bot application object: " << callbackObj.get_error().human_readable << std::endl;
 		}
 	}
 }
 
-// Initialize FMOD, DSP, and filepaths for later reference
+// Initialize filepaths and anything else every session shares
 static void init() {
 	std::cout << "###########################" << "\n";
 	std::cout << "###                     ###" << "\n";
@@ -1715,41 +2668,102 @@ static void init() {
 	banksDirPath = exePath / ("soundbanks") / ("Desktop");
 	soundsDirPath = exePath / ("soundfiles");
 
+	// Pick SIMD kernels before anything starts mixing
+	initKernels();
+	std::cout << "Capture sample kernels: " << kernelSetName() << std::endl;
+}
+
+// Initialize a session's own FMOD system, DSP, and Master banks. Runs on the session's strand.
+static void initFMOD(guildSession& session, bool liveUpdate) {
+	std::cout << "###########################\n\n";
+	std::cout << "Starting session for guild " << session.guildId << std::endl;
+
 	// FMOD Init
 	std::cout << "Initializing FMOD...";
-	errorCheckFMODHard(FMOD::Studio::System::create(&pSystem));
-	errorCheckFMODHard(pSystem->getCoreSystem(&pCoreSystem));
-	errorCheckFMODHard(pSystem->initialize(128, FMOD_STUDIO_INIT_LIVEUPDATE, FMOD_INIT_NORMAL, nullptr));
-	std::cout << "Done." << std::endl;
+	errorCheckFMODHard(FMOD::Studio::System::create(&session.pSystem));
+	errorCheckFMODHard(session.pSystem->getCoreSystem(&session.pCoreSystem));
+	// Discord wants 48 kHz, so ask the mixer for it up front. Keeps FMOD's default speaker mode.
+	// The defaults are kept in case the headless output has to be backed out again.
+	int defaultRate; FMOD_SPEAKERMODE defaultSpeakerMode; int defaultRawSpeakers;
+	errorCheckFMODHard(session.pCoreSystem->getSoftwareFormat(&defaultRate, &defaultSpeakerMode, &defaultRawSpeakers));
+	errorCheckFMODSoft(session.pCoreSystem->setSoftwareFormat((int)frameSampleRate, defaultSpeakerMode, defaultRawSpeakers));
+	unsigned int defaultBufferLength; int defaultNumBuffers;
+	errorCheckFMODHard(session.pCoreSystem->getDSPBufferSize(&defaultBufferLength, &defaultNumBuffers));
+
+	// Headless, FMOD mixes on our clock straight into the frame buffer, 20ms (one Opus frame) at a time, with no sound card
+	void* outputDriverData = nullptr;
+	if (useHeadlessOutput) {
+		unsigned int outputHandle = 0;
+		FMOD_RESULT result = session.pCoreSystem->registerOutput(headlessOutput::description(), &outputHandle);
+		if (result == FMOD_OK) { result = session.pCoreSystem->setOutputByPlugin(outputHandle); }
+		if (result == FMOD_OK) {
+			errorCheckFMODSoft(session.pCoreSystem->setSoftwareFormat((int)frameSampleRate, FMOD_SPEAKERMODE_STEREO, 0));
+			errorCheckFMODSoft(session.pCoreSystem->setDSPBufferSize((unsigned int)frameSamplesPerChannel, 2));
+			outputDriverData = &session.discordOutput;		// How the plugin's callbacks find it
+			session.headlessActive = true;
+		}
+		else {
+			errorCheckFMODSoft(result);
+			std::cout << "Headless output unavailable, falling back to the sound card...";
+		}
+	}
+	FMOD_STUDIO_INITFLAGS studioFlags = liveUpdate ? FMOD_STUDIO_INIT_LIVEUPDATE : FMOD_STUDIO_INIT_NORMAL;
+	FMOD_RESULT initResult = session.pSystem->initialize(128, studioFlags, FMOD_INIT_NORMAL, outputDriverData);
+	if (initResult != FMOD_OK && session.headlessActive) {
+		// The plugin registered but wouldn't start, so put FMOD's defaults back and try the sound card instead
+		errorCheckFMODSoft(initResult);
+		std::cout << "Headless output failed to start, falling back to the sound card...";
+		session.headlessActive = false;
+		errorCheckFMODSoft(session.pCoreSystem->setOutput(FMOD_OUTPUTTYPE_AUTODETECT));
+		errorCheckFMODSoft(session.pCoreSystem->setSoftwareFormat((int)frameSampleRate, defaultSpeakerMode, defaultRawSpeakers));
+		errorCheckFMODSoft(session.pCoreSystem->setDSPBufferSize(defaultBufferLength, defaultNumBuffers));
+		initResult = session.pSystem->initialize(128, studioFlags, FMOD_INIT_NORMAL, nullptr);
+	}
+	errorCheckFMODHard(initResult);
+
 
-	// Load Master Bank and Master Strings
-	std::cout << "Loading Master banks...";
-	std::string basePath = banksDirPath.string() + "\\";
-	errorCheckFMODHard(pSystem->loadBankFile((basePath + masterBankFile).c_str(), FMOD_STUDIO_LOAD_BANK_NORMAL, &pMasterBank));
-	errorCheckFMODHard(pSystem->loadBankFile((basePath + masterStringsFile).c_str(), FMOD_STUDIO_LOAD_BANK_NORMAL, &pMasterStringsBank));
+	// The capture path always resamples: to 48 kHz if the mixer didn't take it, and by a few ppm either way to track drift.
+	// Capture only starts once we're in voice, long after this.
+	{
+		errorCheckFMODHard(session.pCoreSystem->getSoftwareFormat(&session.mixerRate, nullptr, nullptr));
+		session.captureResampler.configure(session.mixerRate, (int)frameSampleRate, true);
+	}
 	std::cout << "Done." << std::endl;
 
+	// Load Master Bank and Master Strings, along with every other bank in the folder so they all load together.
+	// With a memory budget, the others wait until something in them is played
+	std::cout << "Loading banks...\n";
+	findBanks(session);
+	std::vector<std::filesystem::path> bankFiles = { banksDirPath / masterBankFile, banksDirPath / masterStringsFile };
+	if (bankMemoryBudgetMB == 0) { bankFiles.insert(bankFiles.end(), session.bankPaths.begin(), session.bankPaths.end()); }
+	std::vector<bankLoad> loads = loadBanks(session, bankFiles);
+	errorCheckFMODHard(loads[0].result);
+	errorCheckFMODHard(loads[1].result);
+	session.pMasterBank = loads[0].bank;
+	session.pMasterStringsBank = loads[1].bank;
+	adoptBanks(session, loads, 2);
+
 	// Also get the Master Bus, set volume, and get the related Channel Group
 	std::cout << "Getting Busses and Channel Groups...";
-	errorCheckFMODHard(pSystem->getBus("bus:/", &pMasterBus));
-	errorCheckFMODHard(pMasterBus->setVolume(dBToFloat(fmodMasterBusVolOffset)));
-	errorCheckFMODHard(pMasterBus->lockChannelGroup());			// Tell the Master Channel Group to always exist even when events arn't playing...
-	errorCheckFMODHard(pSystem->flushCommands());				// And wait until all previous commands are done (ensuring Channel Group exists)...
-	errorCheckFMODHard(pMasterBus->getChannelGroup(&pMasterBusGroup));	// Or else this fails immediately and we'll have DSP problems.
+	errorCheckFMODHard(session.pSystem->getBus("bus:/", &session.pMasterBus));
+	errorCheckFMODHard(session.pMasterBus->setVolume(dBToFloat(fmodMasterBusVolOffset)));
+	errorCheckFMODHard(session.pMasterBus->lockChannelGroup());			// Tell the Master Channel Group to always exist even when events arn't playing...
+	errorCheckFMODHard(session.pSystem->flushCommands());				// And wait until all previous commands are done (ensuring Channel Group exists)...
+	errorCheckFMODHard(session.pMasterBus->getChannelGroup(&session.pMasterBusGroup));	// Or else this fails immediately and we'll have DSP problems.
 	
 	FMOD::Studio::Bus* pCoreBus = nullptr;
-	pSystem->getBus("bus:/SubMaster/Files", &pCoreBus);
+	session.pSystem->getBus("bus:/SubMaster/Files", &pCoreBus);
 	pCoreBus->lockChannelGroup();
-	pSystem->flushCommands();
-	pCoreBus->getChannelGroup(&pCoreGroup);
+	session.pSystem->flushCommands();
+	pCoreBus->getChannelGroup(&session.pCoreGroup);
 
 	std::cout << "Done." << std::endl;
 	
 
-	// Define and create our capture DSP on the Master Channel Group.
-	// Copied from FMOD's examples. Unsure why this specifically must be in brackets?
-	std::cout << "Setting up Capture DSP...";
-	{
+	// Define and create our capture DSP on the Master Channel Group. Not needed headless, as the output gets the mix directly.
+	// Copied from FMOD's examples.
+	if (!session.headlessActive) {
+		std::cout << "Setting up Capture DSP...";
 		FMOD_DSP_DESCRIPTION dspdesc;
 		memset(&dspdesc, 0, sizeof(dspdesc));
 		strncpy_s(dspdesc.name, "LH_captureDSP", sizeof(dspdesc.name));
@@ -1757,13 +2771,15 @@ static void init() {
 		dspdesc.numinputbuffers = 1;
 		dspdesc.numoutputbuffers = 1;
 		// Important: "Read" must point to an appropriate F_CALL function that's always valid (not bound).
-		// Since it also needs program data (isConnected and pcmDataBuffer), this is tough to refactor.
+		// It finds the session it's capturing for through the description's userdata.
 		dspdesc.read = captureDSPReadCallback;
-		errorCheckFMODHard(pCoreSystem->createDSP(&dspdesc, &mCaptureDSP));
+		dspdesc.userdata = &session;
+		errorCheckFMODHard(session.pCoreSystem->createDSP(&dspdesc, &session.mCaptureDSP));
+
+		// Adds the newly defined dsp
+		errorCheckFMODHard(session.pMasterBusGroup->addDSP(FMOD_CHANNELCONTROL_DSP_TAIL, session.mCaptureDSP));
+		std::cout << "Done." << std::endl;
 	}
-	// Adds the newly defined dsp
-	errorCheckFMODHard(pMasterBusGroup->addDSP(FMOD_CHANNELCONTROL_DSP_TAIL, mCaptureDSP));
-	std::cout << "Done." << std::endl;
 
 	// Setting Listener positioning for 3D, in case it's used 
 	std::cout << "Setting up Listener...";
@@ -1771,41 +2787,431 @@ static void init() {
 	listenerAttributes.position = { 0.0f, 0.0f, 0.0f };
 	listenerAttributes.forward = { 0.0f, 1.0f, 0.0f };
 	listenerAttributes.up = { 0.0f, 0.0f, 1.0f };
-	errorCheckFMODHard(pSystem->setListenerAttributes(0, &listenerAttributes));
+	errorCheckFMODHard(session.pSystem->setListenerAttributes(0, &listenerAttributes));
 	std::cout << "Done." << std::endl;
 
 	// Debug details
 	int samplerate; FMOD_SPEAKERMODE speakermode; int numrawspeakers;
-	errorCheckFMODHard(pCoreSystem->getSoftwareFormat(&samplerate, &speakermode, &numrawspeakers));
-	errorCheckFMODHard(pSystem->flushCommands());	// Ensure everything above is done before displaying details
+	errorCheckFMODHard(session.pCoreSystem->getSoftwareFormat(&samplerate, &speakermode, &numrawspeakers));
+	errorCheckFMODHard(session.pSystem->flushCommands());	// Ensure everything above is done before displaying details
 	std::cout << "\n###########################\n\n";
 	std::cout << "FMOD System Info:\n  Sample Rate- " << samplerate << "\n  Speaker Mode- " << speakermode
 		<< "\n  Num Raw Speakers- " << numrawspeakers << "\n";
+	std::cout << "  Output- " << (session.headlessActive ? "Headless, straight to Discord" : "Sound card, via capture DSP") << "\n";
+	std::cout << "  Capture Resampling- " << samplerate << " Hz -> " << frameSampleRate << " Hz, correcting drift (+/-"
+		<< maxDriftCorrectionPpm << " ppm)\n";
 	std::cout << std::endl;
 }
 
-// Init function specifically for user-defined needs (loading banks, indexing events & params, etc)
-static void init_session() {
+// Init function specifically for user-defined needs (indexing events & params, etc). Banks are already loaded by initFMOD.
+static void init_session(guildSession& session) {
 	std::cout << "###########################\n\n";
-	std::cout << "Loading and Indexing all other banks...\n\n";
-	banks();
-	std::cout << "...Done!\n" << std::endl;
-
 	std::cout << "Indexing FMOD Studio objects...\n";
-	indexStudio();
+	indexStudio(session);
 	std::cout << "...Done!\n\n";
 
 	std::cout << "Indexing loose sound files...\n";
-	indexCore();
+	indexCore(session);
 	std::cout << "...Done!\n\n";
 	std::cout << "###########################\n";
 	std::cout << std::endl;
 }
 
+// Everything a session does once, before it takes any commands. First job on its strand.
+static void startSession(guildSession& session, bool liveUpdate) {
+	initFMOD(session, liveUpdate);
+	init_session(session);
+
+	/* Start encoding. Frames flow FMOD mixer -> pcmFrames -> opusEncoder thread -> D++ */
+	// D++ sends in live audio mode, so each packet goes out as soon as the mixer's finished it, with nothing queued ahead
+	// to pre-fill. The mixer's clock paces the packets, and the resampler cancels its drift against real time.
+	session.opusEncoder.setQueueLimits(captureDropPolicy, maxQueuedFrames, catchUpThresholdMs);
+	if (const opusProfile* profile = findOpusProfile(opusProfiles, defaultOpusProfile)) { session.opusEncoder.setProfile(*profile); }
+	else { std::cout << "No Opus profile called " << defaultOpusProfile << ", using the built-in balanced settings." << std::endl; }
+	if (!session.opusEncoder.start()) {
+		releaseFMOD(session);
+		endProgram(-1);
+	}
+	session.ready = true;
+}
+
+// Runs a command that works on one server's session. Always from that session's tick.
+static void sessionCommand(guildSession& session, const dpp::slashcommand_t& event) {
+	if (event.command.get_command_name() == "play") { play(session, event); }
+	else if (event.command.get_command_name() == "pause") { pause(session, event); }
+	else if (event.command.get_command_name() == "unpause") { unpause(session, event); }
+	else if (event.command.get_command_name() == "keyoff") { keyoff(session, event); }
+	else if (event.command.get_command_name() == "stop") { stop(session, event); }
+	else if (event.command.get_command_name() == "stopall") { stopall(session, event); }
+	else if (event.command.get_command_name() == "param") { param(session, event); }
+	else if (event.command.get_command_name() == "volume") { volume(session, event); }
+	else if (event.command.get_command_name() == "join") { join(session, event); }
+	else if (event.command.get_command_name() == "leave") { leave(session, event); }
+	else if (event.command.get_command_name() == "metrics") { metrics(session, event); }
+	else if (event.command.get_command_name() == "opus") { opus(session, event); }
+	else {
+		respond(event, dpp::message("Sorry, " + event.command.get_command_name()
+			+ " isn't a command I understand. Apologies.").set_flags(dpp::m_ephemeral));
+	}
+}
+
+// A parameter's value and its formatted text, for a snapshot.
+static snapshotParam describeParam(const FMOD_STUDIO_PARAMETER_DESCRIPTION& param, float value) {
+	snapshotParam out;
+	out.name = param.name;
+	out.value = value;
+	out.valueText = paramValueString(value, param);
+	out.rangeText = paramMinMaxString(param) + paramAttributesString(param);
+	out.readOnly = (param.flags & FMOD_STUDIO_PARAMETER_READONLY) != 0;
+	return out;
+}
+
+// Captures what /list and autocomplete need into a fresh snapshot and swaps it in for readers. Called at the end of each tick,
+// after update(), so anything that finished this tick is already gone. Readers still holding the old one keep it until they let go.
+static void publishSnapshot(guildSession& session) {
+	// The catalog only changes on a re-index, so it's shared until then rather than copied every tick
+	if (session.catalogChanged || session.catalog == nullptr) {
+		auto catalog = std::make_shared<sessionCatalog>();
+		for (const std::string& path : session.eventPaths) { catalog->events.push_back(truncateEventPath(path)); }
+		for (const std::string& path : session.snapshotPaths) { catalog->snapshots.push_back(truncateSnapshotPath(path)); }
+		for (const auto& [name, sound] : session.pSounds) { catalog->sounds.push_back(name); }
+		catalog->globalParams = session.globalParamNames;
+		for (const std::string& path : session.busPaths) { catalog->busses.push_back(truncateBusPath(path)); }
+		for (const std::string& path : session.vcaPaths) { catalog->vcas.push_back(truncateVCAPath(path)); }
+		session.catalog = catalog;
+		session.catalogChanged = false;
+	}
+
+	auto snapshot = std::make_shared<sessionSnapshot>();
+	snapshot->tick = ++session.ticks;
+	snapshot->catalog = session.catalog;
+
+	// Values that can't be read (an instance that's just been stopped, say) show as 0 until the next tick drops them
+	for (const auto& [name, inst] : session.pEventInstances) {
+		snapshotEventInstance& out = snapshot->events.emplace_back();
+		out.name = name;
+		out.sourceEvent = inst.sourceEvent;
+		for (const FMOD_STUDIO_PARAMETER_DESCRIPTION& param : inst.params) {
+			float value = 0.0f;
+			inst.instance->getParameterByID(param.id, &value);
+			out.params.push_back(describeParam(param, value));
+		}
+	}
+	for (const auto& [name, instance] : session.pSnapshotInstances) { snapshot->snapshots.push_back(name); }
+	for (const auto& [name, sound] : session.pChannels) { snapshot->sounds.push_back({ name, sound.soundNiceName }); }
+	for (const auto& [name, param] : session.globalParamDescriptions) {
+		float value = 0.0f;
+		session.pSystem->getParameterByID(param.id, &value);
+		snapshot->globalParams.push_back(describeParam(param, value));
+	}
+	for (const auto& [name, bus] : session.pBusses) {
+		float value = 0.0f;
+		bus->getVolume(&value);
+		snapshot->busses.push_back({ name, floatTodB(value) });
+	}
+	for (const auto& [name, vca] : session.pVCAs) {
+		float value = 0.0f;
+		vca->getVolume(&value);
+		snapshot->vcas.push_back({ name, floatTodB(value) });
+	}
+
+	session.snapshot.store(std::move(snapshot));
+}
+
+// One pass of a session's housekeeping, queued by sessionTicker every fmodUpdateInterval.
+static void tickSession(guildSession& session, tickTimer::clock::time_point deadline, bool writeMetrics, bool rotateMetrics) {
+	tickTimer::clock::time_point started = tickTimer::clock::now();
+
+	// Apply every command that's come in since the last tick as one batch, ahead of update(),
+	// so a burst of them reaches FMOD's mixer together rather than spread across blocks
+	dpp::slashcommand_t command;
+	uint64_t batch = 0;
+	while (session.commands.pop(command)) {
+		sessionCommand(session, command);
+		batch++;
+	}
+	session.commandsApplied += batch;
+	session.largestCommandBatch = std::max(session.largestCommandBatch, batch);
+
+	// Tell the encoder's silence gate whether anything could still be making sound.
+	// It stops sending once the output is silent, sooner if nothing is playing at all.
+	session.opusEncoder.setMixIdle(session.pEventInstances.empty() && session.pSnapshotInstances.empty() && session.pChannels.empty());
+
+	// Packets leave as fast as the mixer makes them, so run capture at real time whatever the mixer's clock is doing
+	session.captureResampler.setRatioAdjustPpm(driftCorrectionPpm(session));
+
+	// Skip encoding entirely while a lone sound file can come straight from the cache
+	if (useOpusCache) { updateOpusCache(session); }
+
+	// Keep the metrics file fresh, and the histograms about recent audio
+	if (writeMetrics) {
+		std::string fileName = metricsFilePrefix + session.guildId.str() + ".txt";
+		if (!session.audioMetrics.writeFile(exePath / fileName)) { std::cout << "Couldn't write " << fileName << std::endl; }
+	}
+	if (rotateMetrics) { session.audioMetrics.rotate(); }
+
+	// Update FMOD processes, then show readers the result
+	session.pSystem->update();
+	publishSnapshot(session);
+
+	auto late = std::chrono::duration_cast<std::chrono::microseconds>(started - deadline).count();
+	auto took = std::chrono::duration_cast<std::chrono::microseconds>(tickTimer::clock::now() - started).count();
+	session.tickTiming.record((uint64_t)std::max<int64_t>(late, 0), (uint64_t)took);
+	session.tickPending = false;
+}
+
+// Returns the session for a guild, or nullptr if it doesn't have one yet.
+static guildSession* findSession(dpp::snowflake guildId) {
+	std::lock_guard<std::mutex> lock(sessionsMutex);
+	auto found = sessions.find(guildId);
+	return (found != sessions.end()) ? found->second.get() : nullptr;
+}
+
+// Returns the session for a guild, creating it and queueing its startup the first time. Returns nullptr if we're full.
+static guildSession* getSession(dpp::snowflake guildId) {
+	std::lock_guard<std::mutex> lock(sessionsMutex);
+	auto found = sessions.find(guildId);
+	if (found != sessions.end()) { return found->second.get(); }
+	if (sessions.size() >= maxGuildSessions) { return nullptr; }
+
+	bool liveUpdate = sessions.empty();			// Live Update listens on a fixed port, so only the first session's system can have it
+	guildSession* session = sessions.emplace(guildId, std::make_unique<guildSession>(guildId)).first->second.get();
+	sessionWorkers.post(session->jobs, [session, liveUpdate] { startSession(*session, liveUpdate); });
+	return session;
+}
+
+// Handles Auto-Complete for relevant commands, from a server's last published snapshot. Safe on any thread.
+static void autocomplete(const sessionSnapshot& snapshot, dpp::cluster& bot, const dpp::autocomplete_t& event) {
+	const sessionCatalog& catalog = *snapshot.catalog;
+
+	// First because it's likely the most often used
+	if (event.name == "play") {
+		// Determine between the sub-commands to determine which list to pull from
+		auto& subcmd = event.options[0];
+
+		if (subcmd.name == "event") {
+			for (auto& opt : subcmd.options) {
+				// For each Event Description in our list, if the user's typed text exists in the name,
+				// add it as an autocomplete option. Probably some clever way to cache this?
+				if (opt.focused) {
+					std::string uservalue = std::get<std::string>(opt.value);
+					dpp::interaction_response eventDescList(dpp::ir_autocomplete_reply);
+					// Add all the events in the prepared list
+					for (const std::string& pathOption : catalog.events) {
+						// Only list matching event names; if empty, list all
+						if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
+							eventDescList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
+						}
+					}
+					bot.interaction_response_create(event.command.id, event.command.token, eventDescList);
+				}
+			}
+		}
+		else if (subcmd.name == "snapshot") {
+			for (auto& opt : subcmd.options) {
+				// Same but for Snapshot Descriptions
+				if (opt.focused) {
+					std::string uservalue = std::get<std::string>(opt.value);
+					dpp::interaction_response snapshotDescList(dpp::ir_autocomplete_reply);
+					for (const std::string& pathOption : catalog.snapshots) {
+						if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
+							snapshotDescList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
+						}
+					}
+					bot.interaction_response_create(event.command.id, event.command.token, snapshotDescList);
+				}
+			}
+		}
+		else if (subcmd.name == "file") {
+			for (auto& opt : subcmd.options) {
+				// Similar for Files
+				if (opt.focused) {
+					std::string uservalue = std::get<std::string>(opt.value);
+					dpp::interaction_response soundsList(dpp::ir_autocomplete_reply);
+					for (const std::string& pathOption : catalog.sounds) {
+						if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
+							soundsList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
+						}
+					}
+					bot.interaction_response_create(event.command.id, event.command.token, soundsList);
+				}
+			}
+		}
+	}
+
+	// Pause, Unpause, and KeyOff all use the same list of Event Instances
+	else if (event.name == "pause" || event.name == "unpause") {
+		for (auto& opt : event.options) {
+			if (opt.focused) {
+				std::string uservalue = std::get<std::string>(opt.value);
+				dpp::interaction_response eventInstanceList(dpp::ir_autocomplete_reply);
+
+				// For each Event Instance (Events, not Snapshots)
+				for (const snapshotEventInstance& instance : snapshot.events) {
+					const std::string& pathOption = instance.name;
+					if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
+						eventInstanceList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
+					}
+				}
+
+				// For each File Instance
+				for (const auto& [pathOption, soundName] : snapshot.sounds) {
+					if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
+						eventInstanceList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
+					}
+				}
+
+				bot.interaction_response_create(event.command.id, event.command.token, eventInstanceList);
+			}
+		}
+	}
+
+	// Keyoff is very similar to Pause/Unpause, but only applies to Event Instances
+	else if (event.name == "keyoff") {
+		for (auto& opt : event.options) {
+			if (opt.focused) {
+				std::string uservalue = std::get<std::string>(opt.value);
+				dpp::interaction_response eventInstanceList(dpp::ir_autocomplete_reply);
+
+				// For each Event Instance (Events, not Snapshots)
+				for (const snapshotEventInstance& instance : snapshot.events) {
+					const std::string& pathOption = instance.name;
+					if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
+						eventInstanceList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
+					}
+				}
+
+				bot.interaction_response_create(event.command.id, event.command.token, eventInstanceList);
+			}
+		}
+	}
+
+	// Stop applies to both Event, Snapshot, and File Instances
+	else if (event.name == "stop") {
+		for (auto& opt : event.options) {
+			if (opt.focused) {
+				std::string uservalue = std::get<std::string>(opt.value);
+				dpp::interaction_response stoppableList(dpp::ir_autocomplete_reply);
+
+				// For each Event Instance (Events, not Snapshots)
+				for (const snapshotEventInstance& instance : snapshot.events) {
+					const std::string& pathOption = instance.name;
+					if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
+						stoppableList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
+					}
+				}
+				// and For each Snapshot Instance
+				for (const std::string& pathOption : snapshot.snapshots) {
+					if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
+						stoppableList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
+					}
+				}
+				// and For each File instance
+				for (const auto& [pathOption, soundName] : snapshot.sounds) {
+					if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
+						stoppableList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
+					}
+				}
+
+				bot.interaction_response_create(event.command.id, event.command.token, stoppableList);
+			}
+		}
+	}
+
+	// Param covers both Global (in a list) and Local (dependent on the Event Instance)
+	else if (event.name == "param") {
+		auto& subcmd = event.options[0];
+		bool isGlobal = (subcmd.name == "global") ? true : false;
+		// Covering both possible subcommands in one swoop, since they're so similar
+		for (auto& opt : subcmd.options) {
+			// Don't autocomplete options the user isn't looking at
+			if (!opt.focused) { continue; }
+
+			// Instance Name only applies to Local parameters
+			if (opt.name == "instance-name" && !isGlobal) {
+				std::string uservalue = std::get<std::string>(opt.value);
+				dpp::interaction_response eventInstanceList(dpp::ir_autocomplete_reply);
+
+				// For each Event Instance (Events, not Snapshots)
+				for (const snapshotEventInstance& instance : snapshot.events) {
+					const std::string& pathOption = instance.name;
+					if (pathOption.find(uservalue, 0) != 0) {
+						eventInstanceList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
+					}
+				}
+				bot.interaction_response_create(event.command.id, event.command.token, eventInstanceList);
+			}
+			else if (opt.name == "parameter-name") {
+				std::string uservalue = std::get<std::string>(opt.value);
+				dpp::interaction_response paramList(dpp::ir_autocomplete_reply);
+
+				// If Parameter is Global, simply pull from the Global list, otherwise if Local dig deeper from that instance's list
+				if (isGlobal) {
+					for (const std::string& pathOption : catalog.globalParams) {
+						if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
+							paramList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
+						}
+					}
+				}
+				else {
+					// Should probably find a more robust way to make sure we're getting the value of instance-name specifically
+					auto& instanceNameCmdOption = subcmd.options.at(0);
+					std::string instanceName = std::holds_alternative<std::string>(instanceNameCmdOption.value) ? std::get<std::string>(instanceNameCmdOption.value) : "";
+
+					bool found = false;
+					for (const snapshotEventInstance& instance : snapshot.events) {
+						if (instance.name != instanceName) { continue; }
+						found = true;
+						for (const snapshotParam& param : instance.params) {
+							const std::string& pathOption = param.name;
+							if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
+								paramList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
+							}
+						}
+					}
+					if (!found) {
+						std::cout << "No event found in pEventInstances with the name: " << instanceName << std::endl;
+					}
+				}
+				bot.interaction_response_create(event.command.id, event.command.token, paramList);
+			}
+		}
+	}
+
+	// Volume uniquely covers all Busses and VCAs from a list, similar to Stop
+	else if (event.name == "volume") {
+		for (auto& opt : event.options) {
+			if (opt.focused) {
+				std::string uservalue = std::get<std::string>(opt.value);
+				dpp::interaction_response busVcaList(dpp::ir_autocomplete_reply);
+				for (const std::string& pathOption : catalog.busses) {
+					if ((pathOption.find(uservalue, 0) != 0) || (uservalue == "")) {
+						busVcaList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
+					}
+				}
+				for (const std::string& pathOption : catalog.vcas) {
+					if ((pathOption.find(uservalue, 0) != 0) || (uservalue == "")) {
+						busVcaList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
+					}
+				}
+				bot.interaction_response_create(event.command.id, event.command.token, busVcaList);
+			}
+		}
+	}
+}
+
 int main() {
 
 	init();
-	init_session();
+
+	// Needed before the bot starts, so /opus can offer them as choices
+	opusProfiles = loadOpusProfiles(opusProfilesFile);
+	std::cout << "Opus profiles: " << opusProfiles.size() << " available, starting with " << defaultOpusProfile << ".\n" << std::endl;
+
+	// Shared by every session, so these start before any of them can
+	if (useOpusCache && !soundCache.start(exePath / opusCacheFolder)) { std::cout << "Opus cache unavailable, always encoding the live mix." << std::endl; }
+	sessionWorkers.start(sessionWorkerThreads);
+	std::cout << "Session workers: " << sessionWorkers.threadCount() << " threads, for up to " << maxGuildSessions << " servers at once.\n" << std::endl;
 
 	std::cout << "Starting Bot...\n" << std::endl;
 
@@ -1850,7 +3256,10 @@ int main() {
 				{ "leave", "Leave the current voice channel.", bot.me.id},
 				{ "quit", "Leave voice and exit the program.", bot.me.id},
 				{ "user", "Add or Remove user permissions.", bot.me.id},
-				{ "help", "List available commands and other info.", bot.me.id}
+				{ "help", "List available commands and other info.", bot.me.id},
+				{ "metrics", "Show how long audio is taking to reach Discord.", bot.me.id},
+				{ "opus", "List Opus encoding profiles, or switch to one.", bot.me.id},
+				{ "broadcast", "Play another server's session in your voice channel here.", bot.me.id}
 			};
 
 			// Playable options
@@ -1955,6 +3364,18 @@ int main() {
 					"Whether to post the help message for everyone in the channel, or just for you.", false)
 			);
 
+			// Opus options
+			dpp::command_option opusProfileOption = dpp::command_option(dpp::co_string, "profile", "The encoding profile to switch to. Leave out to list them.", false);
+			for (const opusProfile& profile : opusProfiles) {
+				opusProfileOption.add_choice(dpp::command_option_choice(profile.name, profile.name));
+			}
+			commands[18].add_option(opusProfileOption);
+
+			// Broadcast options
+			commands[19].add_option(
+				dpp::command_option(dpp::co_string, "server", "The server whose session you want to hear.", true).set_auto_complete(true)
+			);
+
 			// Permissions. Show commands for only those who can use slash commands in a server.
 			// Permission to _run_ the commands will be checked locally at runtime.
 			for (unsigned int i = 0; i > commands.size(); i++) {
@@ -1966,7 +3387,8 @@ int main() {
 	});
 
 	/* Handle slash commands */
-	bot.on_slashcommand([&bot](const dpp::slashcommand_t& event) {
+	// A coroutine, so heavy commands can defer and wait for their session without tying up this thread
+	bot.on_slashcommand([&bot](const dpp::slashcommand_t& event) -> dpp::task<void> {
 
 		// Filter out non-Owners from enacting commands
 		std::cout << "Command received" << std::endl;
@@ -1977,272 +3399,148 @@ int main() {
 		for (auto& user : authorizedUsers) { std::cout << "   " << user.str() << "\n"; }
 		
 		if (!authorizedUsers.contains(cmdSender.id)) {
-			event.reply(dpp::message("Sorry, only authorized users can run commands for me.").set_flags(dpp::m_ephemeral));
+			respond(event, dpp::message("Sorry, only authorized users can run commands for me.").set_flags(dpp::m_ephemeral));
 		}
 		else {
-			if (event.command.get_command_name() == "playable") { playable(event); }
-			else if (event.command.get_command_name() == "list") { list(event); }
-			else if (event.command.get_command_name() == "play") { play(event); }
-			else if (event.command.get_command_name() == "pause") { pause(event); }
-			else if (event.command.get_command_name() == "unpause") { unpause(event); }
-			else if (event.command.get_command_name() == "keyoff") { keyoff(event); }
-			else if (event.command.get_command_name() == "stop") { stop(event); }
-			else if (event.command.get_command_name() == "stopall") { stopall(event); }
-			else if (event.command.get_command_name() == "param") { param(event); }
-			else if (event.command.get_command_name() == "volume") { volume(event); }
-			else if (event.command.get_command_name() == "ping") { ping(event); }
-			else if (event.command.get_command_name() == "banks") { banks(event); }
-			else if (event.command.get_command_name() == "join") { join(event); }
-			else if (event.command.get_command_name() == "leave") { leave(event); }
+			if (event.command.get_command_name() == "ping") { ping(event); }
 			else if (event.command.get_command_name() == "quit") { quit(event); }
 			else if (event.command.get_command_name() == "user") { user(event); }
 			else if (event.command.get_command_name() == "help") { help(event); }
-			else {
-				event.reply(dpp::message("Sorry, " + event.command.get_command_name()
-					+ " isn't a command I understand. Apologies.").set_flags(dpp::m_ephemeral));
-			}
-		}
-	});
-
-	/* Handle Auto-Complete for relevant commands */
-	bot.on_autocomplete([&bot](const dpp::autocomplete_t& event) {
-		// First because it's likely the most often used
-		if (event.name == "play") {
-			// Determine between the sub-commands to determine which list to pull from
-			auto& subcmd = event.options[0];
-
-			if (subcmd.name == "event") {
-				for (auto& opt : subcmd.options) {
-					// For each Event Description in our list, if the user's typed text exists in the name,
-					// add it as an autocomplete option. Probably some clever way to cache this?
-					if (opt.focused) {
-						std::string uservalue = std::get<std::string>(opt.value);
-						dpp::interaction_response eventDescList(dpp::ir_autocomplete_reply);
-						// Add all the events in the prepared list
-						for (unsigned int i = 0; i < eventPaths.size(); i++) {
-							std::string pathOption = truncateEventPath(eventPaths.at(i));	//Could pre-compute sets of these
-							// Only list matching event names; if empty, list all
-							if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
-								eventDescList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
-							}
-						}
-						bot.interaction_response_create(event.command.id, event.command.token, eventDescList);
-					}
-				}
-			}
-			else if (subcmd.name == "snapshot") {
-				for (auto& opt : subcmd.options) {
-					// Same but for Snapshot Descriptions
-					if (opt.focused) {
-						std::string uservalue = std::get<std::string>(opt.value);
-						dpp::interaction_response snapshotDescList(dpp::ir_autocomplete_reply);
-						for (unsigned int i = 0; i < snapshotPaths.size(); i++) {
-							std::string pathOption = truncateSnapshotPath(snapshotPaths.at(i));		//Could pre-compute sets of these
-							if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
-								snapshotDescList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
-							}
-						}
-						bot.interaction_response_create(event.command.id, event.command.token, snapshotDescList);
-					}
-				}
+			else if (event.command.guild_id == 0) {
+				respond(event, dpp::message("That command only works from inside a server.").set_flags(dpp::m_ephemeral));
 			}
-			else if (subcmd.name == "file") {
-				for (auto& opt : subcmd.options) {
-					// Similar for Files
-					if (opt.focused) {
-						std::string uservalue = std::get<std::string>(opt.value);
-						dpp::interaction_response soundsList(dpp::ir_autocomplete_reply);
-						for (auto& entry : pSounds) {
-							std::string pathOption = entry.first;
-							if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
-								soundsList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
-							}
-						}
-						bot.interaction_response_create(event.command.id, event.command.token, soundsList);
-					}
-				}
+			else if (event.command.get_command_name() == "broadcast") { broadcast(event); }
+			else if (isRelaying(event.command.guild_id) && event.command.get_command_name() == "leave") { leaveRelay(event); }
+			else if (isRelaying(event.command.guild_id) && event.command.get_command_name() == "join") {
+				respond(event, dpp::message("I'm broadcasting another server's session here. Use /leave first.").set_flags(dpp::m_ephemeral));
 			}
-		}
-
-		// Pause, Unpause, and KeyOff all use the same list of Event Instances
-		else if (event.name == "pause" || event.name == "unpause") {
-			for (auto& opt : event.options) {
-				if (opt.focused) {
-					std::string uservalue = std::get<std::string>(opt.value);
-					dpp::interaction_response eventInstanceList(dpp::ir_autocomplete_reply);
-
-					// For each Event Instance (Events, not Snapshots)
-					for (std::map<std::string, sessionEventInstance>::iterator it = pEventInstances.begin(); it != pEventInstances.end(); ++it) {
-						std::string pathOption = it->first;
-						if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
-							eventInstanceList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
-						}
-					}
-
-					// For each File Instance
-					for (std::map<std::string, sessionSoundInstance>::iterator it = pChannels.begin(); it != pChannels.end(); ++it) {
-						std::string pathOption = it->first;
-						if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
-							eventInstanceList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
-						}
-					}
-
-					bot.interaction_response_create(event.command.id, event.command.token, eventInstanceList);
+			else {
+				// Everything else belongs to this server's session, and is applied at the start of its next tick
+				guildSession* session = getSession(event.command.guild_id);
+				if (session == nullptr) {
+					respond(event, dpp::message("Sorry, I'm already running tables in as many servers as I can.").set_flags(dpp::m_ephemeral));
+					co_return;
 				}
-			}
-		}
-
-		// Keyoff is very similar to Pause/Unpause, but only applies to Event Instances
-		else if (event.name == "keyoff") {
-			for (auto& opt : event.options) {
-				if (opt.focused) {
-					std::string uservalue = std::get<std::string>(opt.value);
-					dpp::interaction_response eventInstanceList(dpp::ir_autocomplete_reply);
-
-					// For each Event Instance (Events, not Snapshots)
-					for (std::map<std::string, sessionEventInstance>::iterator it = pEventInstances.begin(); it != pEventInstances.end(); ++it) {
-						std::string pathOption = it->first;
-						if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
-							eventInstanceList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
+				if (event.command.get_command_name() == "list") { list(*session, event); }		// Only reads the snapshot, so no need to wait
+				else if (event.command.get_command_name() == "banks") { co_await banks(*session, event); }
+				else if (event.command.get_command_name() == "playable") { co_await playable(*session, event); }
+				else {
+					// A new session loads its banks before it takes commands, which can run past Discord's 3 seconds to answer
+					bool deferred = !session->ready;
+					if (deferred) { co_await deferReply(event); }
+
+					// So can a bank an event to play is in, if it isn't loaded. That's loaded here, in a job of its own,
+					// rather than in the middle of the tick that plays it, holding up every other command in the batch
+					std::string eventToPlay = playedEvent(event);
+					if (!eventToPlay.empty()) {
+						std::string bankFile = co_await onStrand<std::string>(*session, [session, eventToPlay] { return unloadedBank(*session, eventToPlay); });
+						if (!bankFile.empty()) {
+							if (!deferred) { co_await deferReply(event); }
+							co_await onStrand<bool>(*session, [session, bankFile] { return makeResident(*session, bankFile); });
 						}
 					}
-
-					bot.interaction_response_create(event.command.id, event.command.token, eventInstanceList);
+					session->commands.push(event);
 				}
-			}
-		}
-
-		// Stop applies to both Event, Snapshot, and File Instances
-		else if (event.name == "stop") {
-			for (auto& opt : event.options) {
-				if (opt.focused) {
-					std::string uservalue = std::get<std::string>(opt.value);
-					dpp::interaction_response stoppableList(dpp::ir_autocomplete_reply);
 
-					// For each Event Instance (Events, not Snapshots)
-					for (std::map<std::string, sessionEventInstance>::iterator it = pEventInstances.begin(); it != pEventInstances.end(); ++it) {
-						std::string pathOption = it->first;
-						if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
-							stoppableList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
-						}
-					}
-					// and For each Snapshot Instance
-					for (std::map<std::string, FMOD::Studio::EventInstance*>::iterator it = pSnapshotInstances.begin(); it != pSnapshotInstances.end(); ++it) {
-						std::string pathOption = it->first;
-						if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
-							stoppableList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
-						}
-					}
-					// and For each File instance
-					for (std::map<std::string, sessionSoundInstance>::iterator it = pChannels.begin(); it != pChannels.end(); ++it) {
-						std::string pathOption = it->first;
-						if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
-							stoppableList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
-						}
-					}
 
-					bot.interaction_response_create(event.command.id, event.command.token, stoppableList);
-				}
 			}
 		}
+	});
 
-		// Param covers both Global (in a list) and Local (dependent on the Event Instance)
-		else if (event.name == "param") {
-			auto& subcmd = event.options[0];
-			bool isGlobal = (subcmd.name == "global") ? true : false;
-			// Covering both possible subcommands in one swoop, since they're so similar
-			for (auto& opt : subcmd.options) {
-				// Don't autocomplete options the user isn't looking at
-				if (!opt.focused) { continue; }
-
-				// Instance Name only applies to Local parameters
-				if (opt.name == "instance-name" && !isGlobal) {
-					std::string uservalue = std::get<std::string>(opt.value);
-					dpp::interaction_response eventInstanceList(dpp::ir_autocomplete_reply);
-
-					// For each Event Instance (Events, not Snapshots)
-					for (std::map<std::string, sessionEventInstance>::iterator it = pEventInstances.begin(); it != pEventInstances.end(); ++it) {
-						std::string pathOption = it->first;
-						if (pathOption.find(uservalue, 0) != 0) {
-							eventInstanceList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
-						}
-					}
-					bot.interaction_response_create(event.command.id, event.command.token, eventInstanceList);
-				}
-				else if (opt.name == "parameter-name") {
-					std::string uservalue = std::get<std::string>(opt.value);
-					dpp::interaction_response paramList(dpp::ir_autocomplete_reply);
-
-					// If Parameter is Global, simply pull from the Global list, otherwise if Local dig deeper from that instance's list
-					if (isGlobal) {
-						for (unsigned int i = 0; i < globalParamNames.size(); i++) {
-							std::string pathOption = globalParamNames.at(i);
-							if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
-								paramList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
-							}
-						}
-					}
-					else {
-						// Should probably find a more robust way to make sure we're getting the value of instance-name specifically
-						auto& instanceNameCmdOption = subcmd.options.at(0);
-
-						try {
-							std::vector<FMOD_STUDIO_PARAMETER_DESCRIPTION>& params = pEventInstances.at(instanceNameCmdOption.name).params;
-							for (unsigned int i = 0; i < params.size(); i++) {
-								std::string pathOption = params.at(i).name;
-								if ((pathOption.find(uservalue, 0) != std::string::npos) || (uservalue == "")) {
-									paramList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
-								}
-							}
-						}
-						catch (std::out_of_range ex) {
-							std::cout << "Out of Range Exception! " << ex.what() << "\n";
-							std::cout << "Most likely caused by no event found in pEventInstances with the name: " << instanceNameCmdOption.name << std::endl;
-						}
-					}
-					bot.interaction_response_create(event.command.id, event.command.token, paramList);
-				}
-			}
+	/* Handle Auto-Complete for relevant commands */
+	bot.on_autocomplete([&bot](const dpp::autocomplete_t& event) {
+		if (event.name == "broadcast") {
+			broadcastAutocomplete(bot, event);
+			return;
 		}
 
-		// Volume uniquely covers all Busses and VCAs from a list, similar to Stop
-		else if (event.name == "volume") {
-			for (auto& opt : event.options) {
-				if (opt.focused) {
-					std::string uservalue = std::get<std::string>(opt.value);
-					dpp::interaction_response busVcaList(dpp::ir_autocomplete_reply);
-					for (unsigned int i = 0; i < busPaths.size(); i++) {
-						std::string pathOption = truncateBusPath(busPaths.at(i));
-						if ((pathOption.find(uservalue, 0) != 0) || (uservalue == "")) {
-							busVcaList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
-						}
-					}
-					for (unsigned int i = 0; i < vcaPaths.size(); i++) {
-						std::string pathOption = truncateVCAPath(vcaPaths.at(i));
-						if ((pathOption.find(uservalue, 0) != 0) || (uservalue == "")) {
-							busVcaList.add_autocomplete_choice(dpp::command_option_choice(pathOption, pathOption));
-						}
-					}
-					bot.interaction_response_create(event.command.id, event.command.token, busVcaList);
+		// Lists come from this server's last snapshot, right here. Nothing to offer if it hasn't ticked yet
+		guildSession* session = findSession(event.command.guild_id);
+		std::shared_ptr<const sessionSnapshot> snapshot = (session != nullptr) ? session->snapshot.load() : nullptr;
+		if (snapshot == nullptr) { return; }
+		autocomplete(*snapshot, bot, event);
+
+		// Once an event's name is typed out in full, start loading its bank so /play doesn't wait on it
+		if (event.name == "play" && !event.options.empty() && event.options[0].name == "event") {
+			for (const auto& opt : event.options[0].options) {
+				if (!opt.focused || !std::holds_alternative<std::string>(opt.value)) { continue; }
+				std::string typed = std::get<std::string>(opt.value);
+				const std::vector<std::string>& events = snapshot->catalog->events;
+				if (std::find(events.begin(), events.end(), typed) != events.end()) {
+					sessionWorkers.post(session->jobs, [session, typed] { prefetchEvent(*session, typed); });
 				}
 			}
 		}
 	});
 	
-	/* Set currentClient and tell the program we're connected */
+	/* Set currentClient and tell the guild's session we're connected. A relay's client goes to the session it's relaying instead */
 	bot.on_voice_ready([&bot](const dpp::voice_ready_t& event) {
 		std::cout << "Voice Ready" << std::endl;
-		currentClient = event.voice_client;							// Get the bot's current voice channel
-		currentClient->set_send_audio_type(dpp::discord_voice_client::satype_live_audio);
-		isConnected = true;											// Tell the rest of the program we've connected
+		if (event.voice_client == nullptr) { return; }
+		dpp::discord_voice_client* client = event.voice_client;
+		dpp::discord_client* shard = event.from;
+		client->set_send_audio_type(dpp::discord_voice_client::satype_live_audio);	// No pacing in D++: the mixer's clock paces the packets
+
+		guildSession* source = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(sessionsMutex);
+			auto relay = relays.find(client->server_id);
+			if (relay != relays.end()) {
+				relay->second.client = client;
+				relay->second.shard = shard;
+				auto found = sessions.find(relay->second.sourceGuild);
+				if (found != sessions.end()) { source = found->second.get(); }
+			}
+		}
+		if (source != nullptr) {
+			source->opusEncoder.addDestination(client);					// Same packets as everyone else, no extra encoding
+			sessionWorkers.post(source->jobs, [source] { source->isConnected = true; });
+
+			return;
+		}
+
+		guildSession* session = findSession(client->server_id);
+		if (session == nullptr) { return; }
+		session->opusEncoder.addDestination(client);					// Replaces this guild's old client now, in case D++ reconnected and freed it
+		sessionWorkers.post(session->jobs, [session, client, shard] {
+			session->currentClient = client;							// Get the bot's voice channel in this guild
+			session->voiceShard = shard;
+			session->isConnected = true;								// Tell the rest of the session we've connected
+		});
+
 	});
 
 	/* Just confirm when we're leaving Voice. Everything is stopped
 	   and null'd before this is called, but it's good to have just in case.
+	   D++ raises this whenever anyone leaves the call, so only the bot itself leaving detaches anything.
 	*/
 	bot.on_voice_client_disconnect([&bot](const dpp::voice_client_disconnect_t& event) {
+		if (event.voice_client == nullptr || event.user_id != bot.me.id) { return; }
 		std::cout << "Voice Disconnecting." << std::endl;
-		isConnected = false;
+		dpp::discord_voice_client* client = event.voice_client;
+
+		// A relay's client lives in its source session's encoder
+		guildSession* session = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(sessionsMutex);
+			auto relay = relays.find(client->server_id);
+			if (relay != relays.end() && relay->second.client == client) {
+				relay->second.client = nullptr;
+				auto found = sessions.find(relay->second.sourceGuild);
+				if (found != sessions.end()) { session = found->second.get(); }
+			}
+			else {
+				auto found = sessions.find(client->server_id);
+				if (found != sessions.end()) { session = found->second.get(); }
+			}
+		}
+		if (session == nullptr) { return; }
+		session->opusEncoder.removeDestination(client);				// Right away, under the encoder's lock, before D++ can free the client
+		sessionWorkers.post(session->jobs, [session, client] {
+			if (session->currentClient == client) { session->currentClient = nullptr; }
+			session->isConnected = (session->opusEncoder.destinationCount() > 0);
+		});
+
 	});
 
 	/* Start the bot */
@@ -2253,38 +3551,66 @@ int main() {
 			std::cout << "    Please also make sure your token.txt file has your Bot Token in it, and that the Token is correct!\n";
 			std::cout << "If you don't have a token, you can follow the directions on the following page to create a bot and token:\n"
 				<< "    https://dpp.dev/creating-a-bot-application.html\n" << std::endl;
-			releaseFMOD();
 			endProgram(ex.code());
 		}
 	}
 
-	/* Program loop */
-	while (!exitRequested) {
-		// Send PCM data to D++, if applicable
-		if (isConnected) {
-			if (pcmDataBuffer.size() > sendAudioThresh) {							// If buffer is full enough
-				while (pcmDataBuffer.size() > sendAudioThresh) {					// Until minimum size we want our buffer
-					currentClient->send_audio_raw((uint16_t*)pcmDataBuffer.data(),
-						dpp::send_audio_raw_max_length);							// Send the buffer (method takes 11520 BYTES, so 5760 samples)
-					pcmDataBuffer.erase(pcmDataBuffer.begin(),
-						pcmDataBuffer.begin() + (int)(dpp::send_audio_raw_max_length * 0.5));	// Trim our main buffer of the data just sent
-				}
+	/* Session ticks */
+	// Sessions do their own work on the pool, and only their own strand ever calls into their Studio system.
+	// Every fmodUpdateInterval, sessionTicker queues a tick for each one that's started, unless the last one hasn't finished,
+	// so a session stuck loading banks doesn't pile them up or hold up the rest.
+	auto nextMetricsWrite = tickTimer::clock::now() + metricsWriteInterval;
+	auto nextMetricsRotate = tickTimer::clock::now() + metricsWindow;
+	sessionTicker.start(fmodUpdateInterval, [&nextMetricsWrite, &nextMetricsRotate](tickTimer::clock::time_point deadline) {
+		bool writeMetrics = (deadline >= nextMetricsWrite);
+		bool rotateMetrics = (deadline >= nextMetricsRotate);
+		if (writeMetrics) { nextMetricsWrite += metricsWriteInterval; }
+		if (rotateMetrics) { nextMetricsRotate += metricsWindow; }
+
+		std::lock_guard<std::mutex> lock(sessionsMutex);
+		for (auto& [guildId, entry] : sessions) {
+			guildSession* session = entry.get();
+			if (!session->ready) { continue; }
+			if (session->tickPending.exchange(true)) {
+				session->tickTiming.recordSkipped(1);
+				continue;
 			}
-			// Todo: what if the audio ends? Or if completely silent? We should stop trying to transmit normally, right? Probably would go here.
-			// Possible approach: !eventsPlaying && output is silent, fromSilence = true.
+			sessionWorkers.post(session->jobs, [session, deadline, writeMetrics, rotateMetrics] { tickSession(*session, deadline, writeMetrics, rotateMetrics); });
 		}
-		// Update FMOD processes. Just before "Sleep" which gives FMOD some time to process without main thread interference.
-		pSystem->update();
-		Sleep(20);
+	});
+
+	/* Bank hot reloading */
+	// When a build lands in the soundbanks folder, each session swaps in just the banks that changed, on its own strand
+	if (watchBanks) {
+		bankWatcher.start(banksDirPath, ".bank", bankWatchInterval, bankWatchSettle, [](const folderChanges& changes) {
+			std::lock_guard<std::mutex> lock(sessionsMutex);
+			for (auto& [guildId, entry] : sessions) {
+				guildSession* session = entry.get();
+				sessionWorkers.post(session->jobs, [session, changes] { reloadBanks(*session, changes); });
+			}
+		});
 	}
 
+	// Nothing for this thread to do until someone asks to quit
+	exitRequested.wait(false);
+
 	// Quitting program.
 	std::cout << "Quitting program. Releasing resources...";
+	bankWatcher.stop();
+	sessionTicker.stop();
+	std::cout << "\nTick timer at " << fmodTickRateHz << " Hz: " << describeTicks(sessionTicker.stats()) << "." << std::endl;
 
-	// Todo: If in voice, leave chat before dying?
-
-	// Release FMOD and the bot cluster
-	releaseFMOD();
+	// Let running jobs finish, after which this thread owns every session. Leave voice, stop encoding, then release FMOD and the bot cluster
+	sessionWorkers.stop();
+	for (auto& [guildId, session] : sessions) {
+		if (session->isConnected && (session->currentClient != nullptr)) { leave(*session, session->voiceShard); }
+		session->opusEncoder.stop();
+		releaseFMOD(*session);
+	}
+	for (auto& [guildId, relay] : relays) {
+		if (relay.shard != nullptr) { relay.shard->disconnect_voice(guildId); }
+	}
+	soundCache.stop();
 	//bot.~cluster();
 
 	std::cout << std::endl;
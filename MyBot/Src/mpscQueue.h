@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+//---MPSC QUEUE---//
+
+namespace trbdrUtils {
+	// Unbounded, lock-free multi-producer/single-consumer queue (Vyukov's linked-list design).
+	// push() is wait-free from any number of threads: one exchange and one store. pop() belongs to a single consumer.
+	// A push that's halfway through hides anything pushed after it until it finishes, so a drain can stop a few items short;
+	// they're simply picked up by the next one. Each item costs one allocation.
+	template<typename T>
+	class mpscQueue {
+	public:
+		mpscQueue() : head(new node()), tail(head.load(std::memory_order_relaxed)) {}
+		~mpscQueue() {
+			T discarded;
+			while (pop(discarded)) {}
+			delete tail;
+		}
+
+		mpscQueue(const mpscQueue&) = delete;
+		mpscQueue& operator=(const mpscQueue&) = delete;
+
+		// Safe from any thread.
+		void push(T value) {
+			node* added = new node(std::move(value));
+			node* previous = head.exchange(added, std::memory_order_acq_rel);
+			previous->next.store(added, std::memory_order_release);
+		}
+
+		// Consumer only. Moves the oldest item into "out", or returns false if there's nothing (visible) yet.
+		bool pop(T& out) {
+			node* next = tail->next.load(std::memory_order_acquire);
+			if (next == nullptr) { return false; }
+			out = std::move(next->value);
+			delete tail;
+			tail = next;		// The popped node becomes the new stub
+			return true;
+		}
+
+	private:
+		struct node {
+			node() = default;
+			explicit node(T&& item) : value(std::move(item)) {}
+			std::atomic<node*> next = nullptr;
+			T value{};
+		};
+
+		std::atomic<node*> head;								// Newest node. Producers swap themselves in here
+		node* tail;												// Consumer's stub; the oldest item is its next
+	};
+}
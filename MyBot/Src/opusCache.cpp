@@ -0,0 +1,415 @@
+#include "opusCache.h"
+#include "frameBuffer.h"
+#include "pcmKernels.h"
+#include "resampler.h"
+
+#include "fmod.hpp"
+#include <opus/opus.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+//---OPUS CACHE---//
+
+namespace trbdrAudio {
+	// Start of every cache file, ahead of the version, format, packet count and data size.
+	static constexpr char cacheMagic[4] = { 'T', 'O', 'P', 'C' };
+
+	// Largest packet a cache file may hold. Opus' own limit, and it fits the length field.
+	static constexpr size_t maxCachedPacketBytes = 4000;
+
+	// FNV-1a over the file's contents. Not cryptographic, just enough that an edited file misses the cache.
+	static bool hashFile(const std::filesystem::path& file, uint64_t& hash) {
+		std::ifstream in(file, std::ios::binary);
+		if (!in.is_open()) { return false; }
+		hash = 14695981039346656037ull;
+		char buffer[65536];
+		while (in) {
+			in.read(buffer, sizeof(buffer));
+			std::streamsize got = in.gcount();
+			for (std::streamsize i = 0; i < got; i++) {
+				hash = (hash ^ (uint8_t)buffer[i]) * 1099511628211ull;
+			}
+		}
+		return true;
+	}
+
+	// A file's size and modified time, to tell whether its hash still holds. Returns false if it isn't there.
+	static bool fileStamp(const std::filesystem::path& file, uintmax_t& size, int64_t& modified) {
+		std::error_code error;
+		size = std::filesystem::file_size(file, error);
+		if (error) { return false; }
+		auto writeTime = std::filesystem::last_write_time(file, error);
+		if (error) { return false; }
+		modified = (int64_t)writeTime.time_since_epoch().count();
+		return true;
+	}
+
+	// Names a cached sound by the contents it was built from, its gain and its format. Doubles as its cache file's name,
+	// so two paths to the same file, or a file put back as it was, share one build.
+	static std::string contentKey(uint64_t hash, int gainTenthsDb, const cachedOpusFormat& format) {
+		char name[96];
+		snprintf(name, sizeof(name), "%016llx_%d_%dms_%d_%d_%d.opus", (unsigned long long)hash, gainTenthsDb, format.frameMs,
+			format.bitrate, format.fec ? 1 : 0, format.packetLossPercent);
+		return name;
+	}
+
+	// Converts FMOD's decoded samples to float, the format the PCM kernels take.
+	static bool decodedToFloat(const uint8_t* in, FMOD_SOUND_FORMAT format, size_t samples, float* out) {
+		switch (format) {
+		case FMOD_SOUND_FORMAT_PCM8:
+			for (size_t i = 0; i < samples; i++) { out[i] = (int8_t)in[i] / 128.0f; }
+			return true;
+		case FMOD_SOUND_FORMAT_PCM16:
+			for (size_t i = 0; i < samples; i++) { int16_t s; memcpy(&s, in + i * 2, 2); out[i] = s / 32768.0f; }
+			return true;
+		case FMOD_SOUND_FORMAT_PCM24:
+			for (size_t i = 0; i < samples; i++) {
+				int32_t s = (int32_t)((uint32_t)in[i * 3] << 8 | (uint32_t)in[i * 3 + 1] << 16 | (uint32_t)in[i * 3 + 2] << 24) >> 8;
+				out[i] = s / 8388608.0f;
+			}
+			return true;
+		case FMOD_SOUND_FORMAT_PCM32:
+			for (size_t i = 0; i < samples; i++) { int32_t s; memcpy(&s, in + i * 4, 4); out[i] = (float)(s / 2147483648.0); }
+			return true;
+		case FMOD_SOUND_FORMAT_PCMFLOAT:
+			memcpy(out, in, samples * sizeof(float));
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	static size_t bytesPerSample(FMOD_SOUND_FORMAT format) {
+		switch (format) {
+		case FMOD_SOUND_FORMAT_PCM8: return 1;
+		case FMOD_SOUND_FORMAT_PCM16: return 2;
+		case FMOD_SOUND_FORMAT_PCM24: return 3;
+		case FMOD_SOUND_FORMAT_PCM32: return 4;
+		case FMOD_SOUND_FORMAT_PCMFLOAT: return 4;
+		default: return 0;
+		}
+	}
+
+	// Reads a cache file back in. Returns nullptr if it's missing, from another version or format, or damaged.
+	static std::shared_ptr<cachedOpusSound> loadCacheFile(const std::filesystem::path& path, const cachedOpusFormat& format) {
+		std::ifstream in(path, std::ios::binary);
+		if (!in.is_open()) { return nullptr; }
+
+		char magic[4];
+		uint32_t version = 0, packetCount = 0, dataBytes = 0;
+		int32_t frameMs = 0, bitrate = 0, fec = 0, packetLossPercent = 0;
+		in.read(magic, sizeof(magic));
+		in.read((char*)&version, sizeof(version));
+		in.read((char*)&frameMs, sizeof(frameMs));
+		in.read((char*)&bitrate, sizeof(bitrate));
+		in.read((char*)&fec, sizeof(fec));
+		in.read((char*)&packetLossPercent, sizeof(packetLossPercent));
+		in.read((char*)&packetCount, sizeof(packetCount));
+		in.read((char*)&dataBytes, sizeof(dataBytes));
+		if (!in || memcmp(magic, cacheMagic, sizeof(magic)) != 0 || version != opusCacheVersion) { return nullptr; }
+		if (frameMs != format.frameMs || bitrate != format.bitrate || (fec != 0) != format.fec || packetLossPercent != format.packetLossPercent) { return nullptr; }
+
+		// The counts size everything below, so a truncated or damaged file has to fail here rather than ask for gigabytes
+		const uint64_t headerBytes = sizeof(magic) + sizeof(version) + sizeof(frameMs) + sizeof(bitrate) + sizeof(fec)
+			+ sizeof(packetLossPercent) + sizeof(packetCount) + sizeof(dataBytes);
+		std::error_code sizeError;
+		uint64_t fileBytes = (uint64_t)std::filesystem::file_size(path, sizeError);
+		if (sizeError || fileBytes != headerBytes + (uint64_t)packetCount * sizeof(uint16_t) + dataBytes) { return nullptr; }
+
+		std::vector<uint16_t> lengths(packetCount);
+		in.read((char*)lengths.data(), (std::streamsize)(packetCount * sizeof(uint16_t)));
+		auto sound = std::make_shared<cachedOpusSound>();
+		sound->format = format;
+		sound->data.resize(dataBytes);
+		in.read((char*)sound->data.data(), dataBytes);
+		if (!in) { return nullptr; }
+
+		sound->offsets.reserve(packetCount + 1);
+		uint32_t offset = 0;
+		sound->offsets.push_back(0);
+		for (uint16_t length : lengths) {
+			offset += length;
+			sound->offsets.push_back(offset);
+		}
+		if (offset != dataBytes) { return nullptr; }
+		return sound;
+	}
+
+	// Writes a cache file, via a temporary so a crash never leaves half of one behind.
+	static bool writeCacheFile(const std::filesystem::path& path, const cachedOpusSound& sound) {
+		std::filesystem::path temp = path;
+		temp += ".tmp";
+		{
+			std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+			if (!out.is_open()) { return false; }
+			uint32_t version = opusCacheVersion, packetCount = (uint32_t)sound.packetCount(), dataBytes = (uint32_t)sound.data.size();
+			int32_t frameMs = sound.format.frameMs, bitrate = sound.format.bitrate, fec = sound.format.fec ? 1 : 0;
+			int32_t packetLossPercent = sound.format.packetLossPercent;
+			out.write(cacheMagic, sizeof(cacheMagic));
+			out.write((const char*)&version, sizeof(version));
+			out.write((const char*)&frameMs, sizeof(frameMs));
+			out.write((const char*)&bitrate, sizeof(bitrate));
+			out.write((const char*)&fec, sizeof(fec));
+			out.write((const char*)&packetLossPercent, sizeof(packetLossPercent));
+			out.write((const char*)&packetCount, sizeof(packetCount));
+			out.write((const char*)&dataBytes, sizeof(dataBytes));
+			for (size_t i = 0; i < sound.packetCount(); i++) {
+				uint16_t length = (uint16_t)(sound.offsets[i + 1] - sound.offsets[i]);
+				out.write((const char*)&length, sizeof(length));
+			}
+			out.write((const char*)sound.data.data(), (std::streamsize)sound.data.size());
+			if (!out) { return false; }
+		}
+		std::error_code error;
+		std::filesystem::rename(temp, path, error);
+		return !error;
+	}
+
+	opusCache::~opusCache() {
+		stop();
+	}
+
+	// Starts the worker, which reads and writes cache files in "folder".
+	bool opusCache::start(const std::filesystem::path& cacheFolder) {
+		if (running) { return true; }
+		folder = cacheFolder;
+		std::error_code error;
+		std::filesystem::create_directories(folder, error);
+		if (error) {
+			std::cout << "Opus cache: couldn't create " << folder.string() << ": " << error.message() << std::endl;
+			return false;
+		}
+
+		// Its own system with no output, so decoding files never takes the live mixer's locks
+		if (FMOD::System_Create(&decoder) != FMOD_OK || decoder->setOutput(FMOD_OUTPUTTYPE_NOSOUND_NRT) != FMOD_OK
+			|| decoder->init(1, FMOD_INIT_NORMAL, nullptr) != FMOD_OK) {
+			std::cout << "Opus cache: couldn't start an FMOD decoder." << std::endl;
+			if (decoder != nullptr) { decoder->release(); decoder = nullptr; }
+			return false;
+		}
+
+		running = true;
+		thread = std::thread(&opusCache::run, this);
+		return true;
+	}
+
+	// Stops and joins the worker.
+	void opusCache::stop() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			running = false;
+		}
+		wakeWorker.notify_all();
+		if (thread.joinable()) { thread.join(); }
+		if (decoder != nullptr) {
+			decoder->release();
+			decoder = nullptr;
+		}
+	}
+
+	// Returns the file's packets at this gain and format if they're ready, otherwise queues them.
+	std::shared_ptr<const cachedOpusSound> opusCache::find(const std::filesystem::path& file, float gain, const cachedOpusFormat& format) {
+		// Tenths of a dB is finer than anyone can hear, and coarse enough that float noise in the gain still hits
+		int gainTenthsDb = (int)std::lround(200.0 * std::log10(std::max(gain, 0.00001f)));
+		uintmax_t size = 0;
+		int64_t modified = 0;
+		if (!fileStamp(file, size, modified)) { return nullptr; }
+		std::string key = file.string() + "|" + std::to_string(gainTenthsDb) + "|" + std::to_string(format.frameMs) + "|"
+			+ std::to_string(format.bitrate) + "|" + std::to_string(format.fec) + "|" + std::to_string(format.packetLossPercent);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		// Only trust the hash while the file's as it was when it was taken
+		auto hashed = fileHashes.find(file.string());
+		if (hashed != fileHashes.end() && hashed->second.size == size && hashed->second.modified == modified) {
+			auto found = sounds.find(contentKey(hashed->second.hash, gainTenthsDb, format));
+			if (found != sounds.end()) { return found->second; }
+		}
+		if (!running || pending.contains(key)) { return nullptr; }
+		auto failure = failures.find(key);
+		if (failure != failures.end()) {
+			if (std::chrono::steady_clock::now() - failure->second < opusCacheRetryInterval) { return nullptr; }
+			failures.erase(failure);
+		}
+		pending.insert(key);
+		queue.push_back({ file, gainTenthsDb, format, key });
+		wakeWorker.notify_one();
+		return nullptr;
+	}
+
+	opusCacheStats opusCache::stats() const {
+		opusCacheStats out;
+		out.loaded = loaded.load(std::memory_order_relaxed);
+		out.built = built.load(std::memory_order_relaxed);
+		out.failed = failed.load(std::memory_order_relaxed);
+		out.buildMs = buildMs.load(std::memory_order_relaxed);
+		return out;
+	}
+
+	void opusCache::run() {
+		while (true) {
+			request job;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wakeWorker.wait(lock, [this] { return !running || !queue.empty(); });
+				if (!running) { return; }
+				job = queue.front();
+				queue.pop_front();
+			}
+
+			std::string builtKey;
+			std::shared_ptr<const cachedOpusSound> sound = build(job, builtKey);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			pending.erase(job.key);
+			if (sound != nullptr) { sounds[builtKey] = sound; }
+			else {
+				failed.fetch_add(1, std::memory_order_relaxed);
+				failures[job.key] = std::chrono::steady_clock::now();		// So it isn't tried again every tick
+			}
+		}
+	}
+
+	// Loads the cache file for a request, building it first if there isn't one yet. "builtKey" is set to its content key.
+	std::shared_ptr<const cachedOpusSound> opusCache::build(const request& job, std::string& builtKey) {
+		// Stamped before hashing, so a file that changes part way through is hashed again next time it's asked for
+		uintmax_t size = 0;
+		int64_t modified = 0;
+		uint64_t hash = 0;
+		if (!fileStamp(job.file, size, modified) || !hashFile(job.file, hash)) { return nullptr; }
+		builtKey = contentKey(hash, job.gainTenthsDb, job.format);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			fileHashes[job.file.string()] = { size, modified, hash };
+			auto found = sounds.find(builtKey);
+			if (found != sounds.end()) { return found->second; }		// Same contents under another path
+		}
+		std::filesystem::path path = folder / builtKey;
+
+		if (std::shared_ptr<cachedOpusSound> sound = loadCacheFile(path, job.format)) {
+			loaded.fetch_add(1, std::memory_order_relaxed);
+			return sound;
+		}
+
+		auto startTime = std::chrono::steady_clock::now();
+		std::shared_ptr<cachedOpusSound> sound = encodeFile(job.file, (float)std::pow(10.0, job.gainTenthsDb / 200.0), job.format);
+		if (sound == nullptr) {
+			std::cout << "Opus cache: couldn't encode " << job.file.string() << std::endl;
+			return nullptr;
+		}
+		uint64_t ms = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+		built.fetch_add(1, std::memory_order_relaxed);
+		buildMs.fetch_add(ms, std::memory_order_relaxed);
+		std::cout << "Opus cache: encoded " << job.file.filename().string() << " (" << sound->packetCount() << " packets) in " << ms << "ms." << std::endl;
+
+		if (!writeCacheFile(path, *sound)) {
+			std::cout << "Opus cache: couldn't write " << path.string() << ", keeping it in memory only." << std::endl;
+		}
+		return sound;
+	}
+
+	// Decodes a file with FMOD, converts it to 48 kHz stereo at the given gain, and encodes it in "opusFormat"'s packets.
+	std::shared_ptr<cachedOpusSound> opusCache::encodeFile(const std::filesystem::path& file, float gain, const cachedOpusFormat& opusFormat) {
+		FMOD::Sound* sound = nullptr;
+		if (decoder->createSound(file.string().c_str(), FMOD_OPENONLY | FMOD_ACCURATETIME, nullptr, &sound) != FMOD_OK) { return nullptr; }
+
+		FMOD_SOUND_FORMAT format = FMOD_SOUND_FORMAT_NONE;
+		int channels = 0;
+		float rate = 0.0f;
+		sound->getFormat(nullptr, &format, &channels, nullptr);
+		sound->getDefaults(&rate, nullptr);
+		size_t sampleBytes = bytesPerSample(format);
+		if (sampleBytes == 0 || rate <= 0.0f || (channels != 1 && channels != 2 && !canDownmixToStereo(channels))) {
+			sound->release();
+			return nullptr;
+		}
+
+		int error = OPUS_OK;
+		OpusEncoder* encoder = opus_encoder_create((opus_int32)frameSampleRate, (int)frameChannels, OPUS_APPLICATION_AUDIO, &error);
+		if (error != OPUS_OK || encoder == nullptr) {
+			sound->release();
+			return nullptr;
+		}
+		opus_encoder_ctl(encoder, OPUS_SET_SIGNAL(OPUS_SIGNAL_MUSIC));
+		opus_encoder_ctl(encoder, OPUS_SET_BITRATE(opusFormat.bitrate));
+		opus_encoder_ctl(encoder, OPUS_SET_INBAND_FEC(opusFormat.fec ? 1 : 0));
+		opus_encoder_ctl(encoder, OPUS_SET_PACKET_LOSS_PERC(opusFormat.packetLossPercent));
+		opus_encoder_ctl(encoder, OPUS_SET_COMPLEXITY(10));		// Built once, played many times, so spend the CPU here
+
+		polyphaseResampler resampler;
+		resampler.configure((int)rate, (int)frameSampleRate, true);
+		pcmFrameBuffer frames(16);
+
+		std::vector<uint8_t> decoded(resamplerBlockFrames * channels * sampleBytes);
+		std::vector<float> samples(resamplerBlockFrames * channels);
+		std::vector<int16_t> stereo(resamplerBlockFrames * frameChannels);
+		auto out = std::make_shared<cachedOpusSound>();
+		out->format = opusFormat;
+		out->offsets.push_back(0);
+		pcmFrame frame;
+		uint8_t packet[maxCachedPacketBytes];
+		bool ok = true;
+
+		// Frames are gathered until there's a packet's worth, or split if a packet's shorter than a frame
+		const size_t packetSampleCount = out->packetSamples() * frameChannels;
+		std::vector<int16_t> gathered;
+		gathered.reserve(packetSampleCount + frameSampleCount);
+		auto encodeGathered = [&]() {
+			size_t done = 0;
+			while (ok && gathered.size() - done >= packetSampleCount) {
+				opus_int32 length = opus_encode(encoder, gathered.data() + done, (int)out->packetSamples(), packet, (opus_int32)maxCachedPacketBytes);
+				if (length < 0) { ok = false; return; }
+				out->data.insert(out->data.end(), packet, packet + length);
+				out->offsets.push_back((uint32_t)out->data.size());
+				done += packetSampleCount;
+			}
+			gathered.erase(gathered.begin(), gathered.begin() + done);
+		};
+
+		// Encodes every whole frame the resampler has finished
+		auto drain = [&]() {
+			while (ok && frames.framesAvailable() > 0 && frames.pop(frame)) {
+				gathered.insert(gathered.end(), frame.samples, frame.samples + frameSampleCount);
+				encodeGathered();
+			}
+		};
+
+		while (ok) {
+			unsigned int read = 0;
+			FMOD_RESULT result = sound->readData(decoded.data(), (unsigned int)decoded.size(), &read);
+			size_t got = read / (sampleBytes * channels);
+			if (got > 0) {
+				decodedToFloat(decoded.data(), format, got * channels, samples.data());
+				for (size_t i = 0; i < got * channels; i++) { samples[i] *= gain; }
+				if (channels == 1) { floatMonoToPCMStereo(samples.data(), stereo.data(), got); }
+				else if (channels == 2) { floatStereoToPCM(samples.data(), stereo.data(), got); }
+				else { downmixToPCMStereo(samples.data(), channels, stereo.data(), got); }
+				resampler.process(stereo.data(), got, frames);
+				drain();
+			}
+			if (result != FMOD_OK || got == 0) { break; }		// FMOD_ERR_FILE_EOF once it's all read
+		}
+
+		// Push the filter's tail and the last partial frame out with silence
+		std::fill(stereo.begin(), stereo.end(), (int16_t)0);
+		size_t padFrames = (size_t)((frameSamplesPerChannel + resamplerTaps) * rate / frameSampleRate) + resamplerTaps;
+		while (ok && padFrames > 0) {
+			size_t chunk = std::min(padFrames, resamplerBlockFrames);
+			resampler.process(stereo.data(), chunk, frames);
+			drain();
+			padFrames -= chunk;
+		}
+		if (ok && !gathered.empty()) {		// A last packet that's only partly sound
+			gathered.resize(packetSampleCount, 0);
+			encodeGathered();
+		}
+
+		opus_encoder_destroy(encoder);
+		sound->release();
+		return (ok && out->packetCount() > 0) ? out : nullptr;
+	}
+}
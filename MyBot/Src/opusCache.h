@@ -0,0 +1,123 @@
+#pragma once
+
+#include "frameBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace FMOD { class System; }
+
+//---OPUS CACHE---//
+
+namespace trbdrAudio {
+	// Bump if the cache file layout or the encoding changes, so old cache files get rebuilt.
+	inline constexpr uint32_t opusCacheVersion = 2;
+
+	// How long a file that failed to build is left before find() queues it again.
+	inline constexpr std::chrono::seconds opusCacheRetryInterval{ 30 };
+
+	// The encoder settings a sound is cached with, which have to match the live encoder's for its packets to stand in.
+	// Each format is cached separately, so switching profiles builds the file again rather than sending the wrong packets.
+	struct cachedOpusFormat {
+		int frameMs = 20;										// Packet length: 10, 20, 40 or 60
+		int bitrate = 128000;									// Bits per second, as libopus settled on for the profile
+		bool fec = false;
+		int packetLossPercent = 0;
+
+		bool operator==(const cachedOpusFormat&) const = default;
+	};
+
+	// A sound file encoded ahead of time, as Opus packets of format.frameMs back to back.
+	struct cachedOpusSound {
+		cachedOpusFormat format;
+		std::vector<uint8_t> data;
+		std::vector<uint32_t> offsets;							// Where each packet starts in data, plus one past the last
+
+		size_t packetCount() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+		size_t packetSamples() const { return (size_t)format.frameMs * frameSampleRate / 1000; }	// Per channel
+		const uint8_t* packet(size_t index, size_t& length) const {
+			length = offsets[index + 1] - offsets[index];
+			return data.data() + offsets[index];
+		}
+	};
+
+	// Snapshot of the cache, for the logs.
+	struct opusCacheStats {
+		uint64_t loaded = 0;									// Found on disk
+		uint64_t built = 0;										// Decoded and encoded this run
+		uint64_t failed = 0;
+		uint64_t buildMs = 0;									// Total time spent building
+	};
+
+	// On-disk cache of loose sound files pre-encoded to Opus at 48 kHz, keyed by a hash of the file's contents, the gain
+	// and the format it was encoded at. Lets a file that's playing on its own skip FMOD-to-Opus encoding entirely.
+	// Files are decoded by a separate, silent FMOD system on a worker thread, so building never touches the live mixer.
+	// find() can be called from any session; the worker owns everything else.
+	class opusCache {
+	public:
+		opusCache() = default;
+		~opusCache();
+
+		opusCache(const opusCache&) = delete;
+		opusCache& operator=(const opusCache&) = delete;
+
+		// Starts the worker, which reads and writes cache files in "folder". Returns false if it can't.
+		bool start(const std::filesystem::path& folder);
+
+		// Stops and joins the worker. Anything still queued is left for next time.
+		void stop();
+
+		// Returns the file's packets at this gain and format if they're ready. If not, queues them to be loaded or built and
+		// returns nullptr. Checks the file's size and modified time on every call, so an edited file is hashed and built again.
+		std::shared_ptr<const cachedOpusSound> find(const std::filesystem::path& file, float gain, const cachedOpusFormat& format);
+
+		opusCacheStats stats() const;
+
+	private:
+		struct request {
+			std::filesystem::path file;
+			int gainTenthsDb = 0;
+			cachedOpusFormat format;
+			std::string key;									// File path, gain and format, as find() sees it
+		};
+
+		// The contents hash of a file, and the size and time it was taken at.
+		struct fileHash {
+			uintmax_t size = 0;
+			int64_t modified = 0;
+			uint64_t hash = 0;
+		};
+
+		void run();
+		std::shared_ptr<const cachedOpusSound> build(const request& job, std::string& builtKey);
+		std::shared_ptr<cachedOpusSound> encodeFile(const std::filesystem::path& file, float gain, const cachedOpusFormat& opusFormat);
+
+		std::filesystem::path folder;
+		FMOD::System* decoder = nullptr;						// Worker thread only
+		std::thread thread;
+		bool running = false;
+
+		std::mutex mutex;										// Guards everything below
+		std::condition_variable wakeWorker;
+		std::deque<request> queue;
+		std::set<std::string> pending;							// Queued, by request key, so find() doesn't ask twice
+		std::map<std::string, std::chrono::steady_clock::time_point> failures;	// Request keys that failed, and when
+		std::map<std::string, fileHash> fileHashes;				// By path
+		std::map<std::string, std::shared_ptr<const cachedOpusSound>> sounds;	// By content key: hash, gain and format
+
+		std::atomic<uint64_t> loaded = 0;
+		std::atomic<uint64_t> built = 0;
+		std::atomic<uint64_t> failed = 0;
+		std::atomic<uint64_t> buildMs = 0;
+	};
+}
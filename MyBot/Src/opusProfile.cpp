@@ -0,0 +1,119 @@
+#include "opusProfile.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+//---OPUS PROFILES---//
+
+namespace trbdrAudio {
+	// The built-in profiles. Balanced is what the encoder did before profiles existed.
+	std::vector<opusProfile> defaultOpusProfiles() {
+		opusProfile lowCpu;
+		lowCpu.name = "lowcpu";
+		lowCpu.bitrate = 64000;
+		lowCpu.complexity = 3;
+		lowCpu.frameMs = 60;									// A third as many encoder calls and packets
+		lowCpu.monoWhenMono = true;
+
+		opusProfile balanced;
+
+		opusProfile lowLatency;
+		lowLatency.name = "lowlatency";
+		lowLatency.bitrate = 96000;
+		lowLatency.complexity = 8;
+		lowLatency.frameMs = 10;
+		lowLatency.fec = true;
+		lowLatency.packetLossPercent = 10;
+
+		return { lowCpu, balanced, lowLatency };
+	}
+
+	// Reads "key=value" into a profile. Returns false if the key or value is no good.
+	static bool parseProfileSetting(const std::string& setting, opusProfile& profile) {
+		size_t split = setting.find('=');
+		if (split == std::string::npos) { return false; }
+		std::string key = setting.substr(0, split);
+		int value = 0;
+		try { value = std::stoi(setting.substr(split + 1)); }
+		catch (...) { return false; }
+
+		if (key == "bitrate") {
+			if (value != 0 && (value < 6000 || value > 510000)) { return false; }
+			profile.bitrate = value;
+		}
+		else if (key == "complexity") {
+			if (value < 0 || value > 10) { return false; }
+			profile.complexity = value;
+		}
+		else if (key == "frame") {
+			if (value != 10 && value != 20 && value != 40 && value != 60) { return false; }
+			profile.frameMs = value;
+		}
+		else if (key == "fec") { profile.fec = (value != 0); }
+		else if (key == "loss") {
+			if (value < 0 || value > 100) { return false; }
+			profile.packetLossPercent = value;
+		}
+		else if (key == "mono") { profile.monoWhenMono = (value != 0); }
+		else { return false; }
+		return true;
+	}
+
+	// Returns the built-in profiles, overridden and added to by the lines of a config file.
+	std::vector<opusProfile> loadOpusProfiles(const std::string& configFile) {
+		std::vector<opusProfile> profiles = defaultOpusProfiles();
+
+		std::ifstream myfile(configFile);
+		if (!myfile.is_open()) { return profiles; }
+
+		std::string line;
+		unsigned int currentLine = 0;
+		while (std::getline(myfile, line)) {
+			currentLine++;
+			std::istringstream words(line);
+			std::string name;
+			if (!(words >> name) || name[0] == '#') { continue; }
+
+			// Start from the existing profile of the same name, if there is one
+			opusProfile profile;
+			if (const opusProfile* existing = findOpusProfile(profiles, name)) { profile = *existing; }
+			profile.name = name;
+
+			bool isValid = true;
+			std::string setting;
+			while (words >> setting) {
+				if (!parseProfileSetting(setting, profile)) {
+					isValid = false;
+					std::cout << "Invalid setting: " << setting << " in " << configFile << " at line: " << currentLine << "\n";
+				}
+			}
+			if (!isValid) { continue; }
+
+			bool replaced = false;
+			for (opusProfile& p : profiles) {
+				if (p.name == name) { p = profile; replaced = true; }
+			}
+			if (!replaced) { profiles.push_back(profile); }
+		}
+		myfile.close();
+		return profiles;
+	}
+
+	// Finds a profile by name.
+	const opusProfile* findOpusProfile(const std::vector<opusProfile>& profiles, const std::string& name) {
+		for (const opusProfile& p : profiles) {
+			if (p.name == name) { return &p; }
+		}
+		return nullptr;
+	}
+
+	// One line describing a profile's settings.
+	std::string describeOpusProfile(const opusProfile& profile) {
+		std::string out = profile.name + ": " + (profile.bitrate > 0 ? std::to_string(profile.bitrate / 1000) + " kbps" : std::string("auto bitrate"))
+			+ ", complexity " + std::to_string(profile.complexity) + ", " + std::to_string(profile.frameMs) + "ms frames";
+		if (profile.fec) { out += ", FEC at " + std::to_string(profile.packetLossPercent) + "% loss"; }
+		if (profile.monoWhenMono) { out += ", mono when possible"; }
+		return out;
+	}
+}
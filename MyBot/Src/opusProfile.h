@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//---OPUS PROFILES---//
+
+namespace trbdrAudio {
+	// A named set of Opus encoder settings, switchable while streaming.
+	struct opusProfile {
+		std::string name = "balanced";
+		int bitrate = 0;										// Bits per second, or 0 to let libopus pick
+		int complexity = 10;									// 0-10, trading encode CPU for quality
+		int frameMs = 20;										// Packet length: 10, 20, 40 or 60
+		bool fec = false;										// In-band forward error correction
+		int packetLossPercent = 0;								// Loss libopus plans for. FEC does nothing while this is 0
+		bool monoWhenMono = false;								// Encode mono whenever both channels are identical
+	};
+
+	// The built-in profiles: lowcpu, balanced and lowlatency.
+	std::vector<opusProfile> defaultOpusProfiles();
+
+	// Returns the built-in profiles, overridden and added to by the lines of a config file.
+	// Each line is a profile name followed by any of: bitrate=, complexity=, frame=, fec=, loss=, mono=
+	// Lines starting with # are ignored, as are bad lines, with a warning. A missing file just means the defaults.
+	std::vector<opusProfile> loadOpusProfiles(const std::string& configFile);
+
+	// Finds a profile by name. Returns nullptr if there isn't one.
+	const opusProfile* findOpusProfile(const std::vector<opusProfile>& profiles, const std::string& name);
+
+	// One line describing a profile's settings, for lists and logs.
+	std::string describeOpusProfile(const opusProfile& profile);
+}
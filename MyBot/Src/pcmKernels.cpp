@@ -0,0 +1,606 @@
+#include "pcmKernels.h"
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define TRBDR_KERNELS_X86
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#endif
+#elif defined(_M_ARM64) || defined(__aarch64__)
+	#define TRBDR_KERNELS_NEON
+	#include <arm_neon.h>
+#endif
+
+// MSVC lets any function use AVX2 intrinsics; GCC and Clang need to be told per-function.
+#if defined(TRBDR_KERNELS_X86) && !defined(_MSC_VER)
+	#define TRBDR_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define TRBDR_TARGET_AVX2
+#endif
+
+//---PCM CONVERSION KERNELS---//
+
+namespace trbdrAudio {
+	// Same scale as trbdrUtils::floatToPCM, so +1.0 and -1.0 land on +/-32767.
+	static constexpr float pcmScale = 32767.0f;
+
+	// ITU-R BS.775 downmix gain (-3 dB) for the centre and surround channels. LFE is left out, as the standard says.
+	static constexpr float downmixGain = 0.70710678f;
+
+	// Left and right gains for each input channel, in FMOD's speaker order.
+	// Quad: FL FR SL SR. 5.1: FL FR C LFE SL SR. 7.1: FL FR C LFE SL SR BL BR.
+	struct downmixMatrix {
+		size_t channels;
+		float left[8];
+		float right[8];
+	};
+
+	static constexpr downmixMatrix quadMatrix = { 4,
+		{ 1.0f, 0.0f, downmixGain, 0.0f },
+		{ 0.0f, 1.0f, 0.0f, downmixGain } };
+	static constexpr downmixMatrix surround51Matrix = { 6,
+		{ 1.0f, 0.0f, downmixGain, 0.0f, downmixGain, 0.0f },
+		{ 0.0f, 1.0f, downmixGain, 0.0f, 0.0f, downmixGain } };
+	static constexpr downmixMatrix surround71Matrix = { 8,
+		{ 1.0f, 0.0f, downmixGain, 0.0f, downmixGain, 0.0f, downmixGain, 0.0f },
+		{ 0.0f, 1.0f, downmixGain, 0.0f, 0.0f, downmixGain, 0.0f, downmixGain } };
+
+	//---Scalar---//
+	// Also used for the leftover samples at the end of each SIMD run.
+
+	static inline int16_t scalarToPCM(float inSample) {
+		if (!(inSample > -1.0f)) { inSample = -1.0f; }		// Also catches NaN
+		else if (inSample > 1.0f) { inSample = 1.0f; }
+		return (int16_t)lrintf(inSample * pcmScale);		// Round-to-nearest-even, same as the SIMD conversions
+	}
+
+	static void floatStereoToPCMScalar(const float* in, int16_t* out, size_t frames) {
+		for (size_t i = 0; i < frames * 2; i++) {
+			out[i] = scalarToPCM(in[i]);
+		}
+	}
+
+	static void floatMonoToPCMStereoScalar(const float* in, int16_t* out, size_t frames) {
+		for (size_t i = 0; i < frames; i++) {
+			int16_t sample = scalarToPCM(in[i]);
+			out[(i * 2)] = sample;
+			out[(i * 2) + 1] = sample;
+		}
+	}
+
+	static void downmixToPCMScalar(const downmixMatrix& matrix, const float* in, int16_t* out, size_t frames) {
+		for (size_t i = 0; i < frames; i++) {
+			const float* frame = in + (i * matrix.channels);
+			float left = 0.0f;
+			float right = 0.0f;
+			for (size_t ch = 0; ch < matrix.channels; ch++) {
+				left += frame[ch] * matrix.left[ch];
+				right += frame[ch] * matrix.right[ch];
+			}
+			out[(i * 2)] = scalarToPCM(left);
+			out[(i * 2) + 1] = scalarToPCM(right);
+		}
+	}
+
+	static void quadToPCMStereoScalar(const float* in, int16_t* out, size_t frames) {
+		downmixToPCMScalar(quadMatrix, in, out, frames);
+	}
+
+	static void surround51ToPCMStereoScalar(const float* in, int16_t* out, size_t frames) {
+		downmixToPCMScalar(surround51Matrix, in, out, frames);
+	}
+
+	static void surround71ToPCMStereoScalar(const float* in, int16_t* out, size_t frames) {
+		downmixToPCMScalar(surround71Matrix, in, out, frames);
+	}
+
+	static void dotProductStereoScalar(const float* left, const float* right, const float* taps, size_t count, float& outLeft, float& outRight) {
+		float sumLeft = 0.0f;
+		float sumRight = 0.0f;
+		for (size_t i = 0; i < count; i++) {
+			sumLeft += left[i] * taps[i];
+			sumRight += right[i] * taps[i];
+		}
+		outLeft = sumLeft;
+		outRight = sumRight;
+	}
+
+	static int16_t peakPCMScalar(const int16_t* in, size_t count, int16_t peak = 0) {
+		for (size_t i = 0; i < count; i++) {
+			int16_t magnitude = (in[i] == INT16_MIN) ? INT16_MAX : (int16_t)((in[i] < 0) ? -in[i] : in[i]);
+			if (magnitude > peak) { peak = magnitude; }
+		}
+		return peak;
+	}
+
+#if defined(TRBDR_KERNELS_X86)
+	//---SSE2---//
+	// Baseline on x64, and on any x86 CPU that can run Windows 10.
+
+	static inline __m128i sse2ToInt32(__m128 samples) {
+		samples = _mm_max_ps(samples, _mm_set1_ps(-1.0f));	// NaN becomes -1.0 here, as max returns the second operand
+		samples = _mm_min_ps(samples, _mm_set1_ps(1.0f));
+		return _mm_cvtps_epi32(_mm_mul_ps(samples, _mm_set1_ps(pcmScale)));
+	}
+
+	static void floatStereoToPCMSSE2(const float* in, int16_t* out, size_t frames) {
+		size_t count = frames * 2;
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m128i lo = sse2ToInt32(_mm_loadu_ps(in + i));
+			__m128i hi = sse2ToInt32(_mm_loadu_ps(in + i + 4));
+			_mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(lo, hi));		// Saturating pack to 16-bit
+		}
+		floatStereoToPCMScalar(in + i, out + i, (count - i) / 2);
+	}
+
+	static void floatMonoToPCMStereoSSE2(const float* in, int16_t* out, size_t frames) {
+		size_t i = 0;
+		for (; i + 8 <= frames; i += 8) {
+			__m128i packed = _mm_packs_epi32(sse2ToInt32(_mm_loadu_ps(in + i)), sse2ToInt32(_mm_loadu_ps(in + i + 4)));
+			_mm_storeu_si128((__m128i*)(out + (i * 2)), _mm_unpacklo_epi16(packed, packed));			// Duplicate into L/R pairs
+			_mm_storeu_si128((__m128i*)(out + (i * 2) + 8), _mm_unpackhi_epi16(packed, packed));
+		}
+		floatMonoToPCMStereoScalar(in + i, out + (i * 2), frames - i);
+	}
+
+	// The downmixes below each turn two frames into an L R L R vector, by shuffling
+	// matching channels of both frames together and summing them with the ITU gains.
+
+	static inline __m128 sse2DownmixQuad(const float* in) {
+		__m128 frame0 = _mm_loadu_ps(in);
+		__m128 frame1 = _mm_loadu_ps(in + 4);
+		__m128 fronts = _mm_movelh_ps(frame0, frame1);						// FL0 FR0 FL1 FR1
+		__m128 surrounds = _mm_movehl_ps(frame1, frame0);					// SL0 SR0 SL1 SR1
+		return _mm_add_ps(fronts, _mm_mul_ps(surrounds, _mm_set1_ps(downmixGain)));
+	}
+
+	static inline __m128 sse2Downmix51(const float* in) {
+		__m128 a = _mm_loadu_ps(in);										// FL0 FR0 C0 LFE0
+		__m128 b = _mm_loadu_ps(in + 4);									// SL0 SR0 FL1 FR1
+		__m128 c = _mm_loadu_ps(in + 8);									// C1 LFE1 SL1 SR1
+		__m128 fronts = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 2, 1, 0));		// FL0 FR0 FL1 FR1
+		__m128 surrounds = _mm_shuffle_ps(b, c, _MM_SHUFFLE(3, 2, 1, 0));	// SL0 SR0 SL1 SR1
+		__m128 centres = _mm_shuffle_ps(a, c, _MM_SHUFFLE(0, 0, 2, 2));		// C0 C0 C1 C1
+		return _mm_add_ps(fronts, _mm_mul_ps(_mm_add_ps(centres, surrounds), _mm_set1_ps(downmixGain)));
+	}
+
+	static inline __m128 sse2Downmix71(const float* in) {
+		__m128 a0 = _mm_loadu_ps(in);										// FL FR C LFE
+		__m128 b0 = _mm_loadu_ps(in + 4);									// SL SR BL BR
+		__m128 a1 = _mm_loadu_ps(in + 8);
+		__m128 b1 = _mm_loadu_ps(in + 12);
+		__m128 fronts = _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(1, 0, 1, 0));
+		__m128 centres = _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 2, 2, 2));
+		__m128 sides = _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(1, 0, 1, 0));
+		__m128 backs = _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 2, 3, 2));
+		__m128 surrounds = _mm_add_ps(centres, _mm_add_ps(sides, backs));
+		return _mm_add_ps(fronts, _mm_mul_ps(surrounds, _mm_set1_ps(downmixGain)));
+	}
+
+	// Runs a two-frame downmix over the block, four frames (8 output samples) per store.
+	template <__m128 (*downmix)(const float*), size_t channels>
+	static inline size_t sse2DownmixToPCM(const float* in, int16_t* out, size_t frames) {
+		size_t i = 0;
+		for (; i + 4 <= frames; i += 4) {
+			__m128i lo = sse2ToInt32(downmix(in + (i * channels)));
+			__m128i hi = sse2ToInt32(downmix(in + ((i + 2) * channels)));
+			_mm_storeu_si128((__m128i*)(out + (i * 2)), _mm_packs_epi32(lo, hi));
+		}
+		return i;
+	}
+
+	static void quadToPCMStereoSSE2(const float* in, int16_t* out, size_t frames) {
+		size_t i = sse2DownmixToPCM<sse2DownmixQuad, 4>(in, out, frames);
+		quadToPCMStereoScalar(in + (i * 4), out + (i * 2), frames - i);
+	}
+
+	static void surround51ToPCMStereoSSE2(const float* in, int16_t* out, size_t frames) {
+		size_t i = sse2DownmixToPCM<sse2Downmix51, 6>(in, out, frames);
+		surround51ToPCMStereoScalar(in + (i * 6), out + (i * 2), frames - i);
+	}
+
+	static void surround71ToPCMStereoSSE2(const float* in, int16_t* out, size_t frames) {
+		size_t i = sse2DownmixToPCM<sse2Downmix71, 8>(in, out, frames);
+		surround71ToPCMStereoScalar(in + (i * 8), out + (i * 2), frames - i);
+	}
+
+	static inline float sse2HorizontalSum(__m128 sums) {
+		sums = _mm_add_ps(sums, _mm_movehl_ps(sums, sums));
+		sums = _mm_add_ss(sums, _mm_shuffle_ps(sums, sums, _MM_SHUFFLE(1, 1, 1, 1)));
+		return _mm_cvtss_f32(sums);
+	}
+
+	static void dotProductStereoSSE2(const float* left, const float* right, const float* taps, size_t count, float& outLeft, float& outRight) {
+		__m128 sumLeft = _mm_setzero_ps();
+		__m128 sumRight = _mm_setzero_ps();
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128 coefs = _mm_loadu_ps(taps + i);
+			sumLeft = _mm_add_ps(sumLeft, _mm_mul_ps(_mm_loadu_ps(left + i), coefs));
+			sumRight = _mm_add_ps(sumRight, _mm_mul_ps(_mm_loadu_ps(right + i), coefs));
+		}
+		float tailLeft, tailRight;
+		dotProductStereoScalar(left + i, right + i, taps + i, count - i, tailLeft, tailRight);
+		outLeft = sse2HorizontalSum(sumLeft) + tailLeft;
+		outRight = sse2HorizontalSum(sumRight) + tailRight;
+	}
+
+	// Folds 8 lanes of 16-bit maximums down to one.
+	static inline int16_t sse2HorizontalMax(__m128i peaks) {
+		peaks = _mm_max_epi16(peaks, _mm_srli_si128(peaks, 8));
+		peaks = _mm_max_epi16(peaks, _mm_srli_si128(peaks, 4));
+		peaks = _mm_max_epi16(peaks, _mm_srli_si128(peaks, 2));
+		return (int16_t)_mm_cvtsi128_si32(peaks);
+	}
+
+	static int16_t peakPCMSSE2(const int16_t* in, size_t count) {
+		__m128i peaks = _mm_setzero_si128();
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m128i samples = _mm_loadu_si128((const __m128i*)(in + i));
+			__m128i negated = _mm_subs_epi16(_mm_setzero_si128(), samples);		// Saturating, so -32768 becomes 32767
+			peaks = _mm_max_epi16(peaks, _mm_max_epi16(samples, negated));
+		}
+		return peakPCMScalar(in + i, count - i, sse2HorizontalMax(peaks));
+	}
+
+	//---AVX2---//
+
+	TRBDR_TARGET_AVX2 static inline __m256i avx2ToInt32(__m256 samples) {
+		samples = _mm256_max_ps(samples, _mm256_set1_ps(-1.0f));
+		samples = _mm256_min_ps(samples, _mm256_set1_ps(1.0f));
+		return _mm256_cvtps_epi32(_mm256_mul_ps(samples, _mm256_set1_ps(pcmScale)));
+	}
+
+	// 256-bit packs work per 128-bit lane, so the two middle quarters come out swapped. This puts them back.
+	TRBDR_TARGET_AVX2 static inline __m256i avx2Pack(__m256i lo, __m256i hi) {
+		return _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+	}
+
+	TRBDR_TARGET_AVX2 static void floatStereoToPCMAVX2(const float* in, int16_t* out, size_t frames) {
+		size_t count = frames * 2;
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+			__m256i packed = avx2Pack(avx2ToInt32(_mm256_loadu_ps(in + i)), avx2ToInt32(_mm256_loadu_ps(in + i + 8)));
+			_mm256_storeu_si256((__m256i*)(out + i), packed);
+		}
+		floatStereoToPCMSSE2(in + i, out + i, (count - i) / 2);
+	}
+
+	TRBDR_TARGET_AVX2 static void floatMonoToPCMStereoAVX2(const float* in, int16_t* out, size_t frames) {
+		size_t i = 0;
+		for (; i + 16 <= frames; i += 16) {
+			__m256i packed = avx2Pack(avx2ToInt32(_mm256_loadu_ps(in + i)), avx2ToInt32(_mm256_loadu_ps(in + i + 8)));
+			__m256i lo = _mm256_unpacklo_epi16(packed, packed);		// Frames 0-3 | 8-11
+			__m256i hi = _mm256_unpackhi_epi16(packed, packed);		// Frames 4-7 | 12-15
+			_mm256_storeu_si256((__m256i*)(out + (i * 2)), _mm256_permute2x128_si256(lo, hi, 0x20));
+			_mm256_storeu_si256((__m256i*)(out + (i * 2) + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+		}
+		floatMonoToPCMStereoSSE2(in + i, out + (i * 2), frames - i);
+	}
+
+	// Same shuffles as the SSE2 downmixes, with frames 0-1 in the low lane and 2-3 in the high lane.
+	// The loads are regrouped first, since AVX shuffles can't cross the 128-bit lanes.
+
+	TRBDR_TARGET_AVX2 static inline __m256 avx2DownmixQuad(const float* in) {
+		__m256 frames01 = _mm256_loadu_ps(in);
+		__m256 frames23 = _mm256_loadu_ps(in + 8);
+		__m256 even = _mm256_permute2f128_ps(frames01, frames23, 0x20);		// Frame 0 | Frame 2
+		__m256 odd = _mm256_permute2f128_ps(frames01, frames23, 0x31);		// Frame 1 | Frame 3
+		__m256 fronts = _mm256_shuffle_ps(even, odd, _MM_SHUFFLE(1, 0, 1, 0));
+		__m256 surrounds = _mm256_shuffle_ps(even, odd, _MM_SHUFFLE(3, 2, 3, 2));
+		return _mm256_add_ps(fronts, _mm256_mul_ps(surrounds, _mm256_set1_ps(downmixGain)));
+	}
+
+	TRBDR_TARGET_AVX2 static inline __m256 avx2Downmix51(const float* in) {
+		__m256 y0 = _mm256_loadu_ps(in);
+		__m256 y1 = _mm256_loadu_ps(in + 8);
+		__m256 y2 = _mm256_loadu_ps(in + 16);
+		__m256 a = _mm256_permute2f128_ps(y0, y1, 0x30);					// Same a, b and c as SSE2, for frames 0-1 | 2-3
+		__m256 b = _mm256_permute2f128_ps(y0, y2, 0x21);
+		__m256 c = _mm256_permute2f128_ps(y1, y2, 0x30);
+		__m256 fronts = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 2, 1, 0));
+		__m256 surrounds = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(3, 2, 1, 0));
+		__m256 centres = _mm256_shuffle_ps(a, c, _MM_SHUFFLE(0, 0, 2, 2));
+		return _mm256_add_ps(fronts, _mm256_mul_ps(_mm256_add_ps(centres, surrounds), _mm256_set1_ps(downmixGain)));
+	}
+
+	TRBDR_TARGET_AVX2 static inline __m256 avx2Downmix71(const float* in) {
+		__m256 frame0 = _mm256_loadu_ps(in);
+		__m256 frame1 = _mm256_loadu_ps(in + 8);
+		__m256 frame2 = _mm256_loadu_ps(in + 16);
+		__m256 frame3 = _mm256_loadu_ps(in + 24);
+		__m256 a0 = _mm256_permute2f128_ps(frame0, frame2, 0x20);			// FL FR C LFE of frames 0 | 2
+		__m256 a1 = _mm256_permute2f128_ps(frame1, frame3, 0x20);
+		__m256 b0 = _mm256_permute2f128_ps(frame0, frame2, 0x31);			// SL SR BL BR of frames 0 | 2
+		__m256 b1 = _mm256_permute2f128_ps(frame1, frame3, 0x31);
+		__m256 fronts = _mm256_shuffle_ps(a0, a1, _MM_SHUFFLE(1, 0, 1, 0));
+		__m256 centres = _mm256_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 2, 2, 2));
+		__m256 sides = _mm256_shuffle_ps(b0, b1, _MM_SHUFFLE(1, 0, 1, 0));
+		__m256 backs = _mm256_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 2, 3, 2));
+		__m256 surrounds = _mm256_add_ps(centres, _mm256_add_ps(sides, backs));
+		return _mm256_add_ps(fronts, _mm256_mul_ps(surrounds, _mm256_set1_ps(downmixGain)));
+	}
+
+	// Runs a four-frame downmix over the block, eight frames (16 output samples) per store.
+	template <__m256 (*downmix)(const float*), size_t channels>
+	TRBDR_TARGET_AVX2 static inline size_t avx2DownmixToPCM(const float* in, int16_t* out, size_t frames) {
+		size_t i = 0;
+		for (; i + 8 <= frames; i += 8) {
+			__m256i lo = avx2ToInt32(downmix(in + (i * channels)));
+			__m256i hi = avx2ToInt32(downmix(in + ((i + 4) * channels)));
+			_mm256_storeu_si256((__m256i*)(out + (i * 2)), avx2Pack(lo, hi));
+		}
+		return i;
+	}
+
+	TRBDR_TARGET_AVX2 static void quadToPCMStereoAVX2(const float* in, int16_t* out, size_t frames) {
+		size_t i = avx2DownmixToPCM<avx2DownmixQuad, 4>(in, out, frames);
+		quadToPCMStereoSSE2(in + (i * 4), out + (i * 2), frames - i);
+	}
+
+	TRBDR_TARGET_AVX2 static void surround51ToPCMStereoAVX2(const float* in, int16_t* out, size_t frames) {
+		size_t i = avx2DownmixToPCM<avx2Downmix51, 6>(in, out, frames);
+		surround51ToPCMStereoSSE2(in + (i * 6), out + (i * 2), frames - i);
+	}
+
+	TRBDR_TARGET_AVX2 static void surround71ToPCMStereoAVX2(const float* in, int16_t* out, size_t frames) {
+		size_t i = avx2DownmixToPCM<avx2Downmix71, 8>(in, out, frames);
+		surround71ToPCMStereoSSE2(in + (i * 8), out + (i * 2), frames - i);
+	}
+
+	// Called once per output sample, so unlike the block kernels this one doesn't hand its tail to the SSE2 version.
+	// Mixing in legacy SSE code that often costs more than the dot product itself.
+	TRBDR_TARGET_AVX2 static void dotProductStereoAVX2(const float* left, const float* right, const float* taps, size_t count, float& outLeft, float& outRight) {
+		__m256 sumLeft = _mm256_setzero_ps();
+		__m256 sumRight = _mm256_setzero_ps();
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256 coefs = _mm256_loadu_ps(taps + i);
+			sumLeft = _mm256_add_ps(sumLeft, _mm256_mul_ps(_mm256_loadu_ps(left + i), coefs));
+			sumRight = _mm256_add_ps(sumRight, _mm256_mul_ps(_mm256_loadu_ps(right + i), coefs));
+		}
+		__m256 sums = _mm256_hadd_ps(sumLeft, sumRight);				// L01 L23 R01 R23 | L45 L67 R45 R67
+		__m128 halves = _mm_add_ps(_mm256_castps256_ps128(sums), _mm256_extractf128_ps(sums, 1));
+		halves = _mm_hadd_ps(halves, halves);							// L R L R
+		float tailLeft = _mm_cvtss_f32(halves);
+		float tailRight = _mm_cvtss_f32(_mm_shuffle_ps(halves, halves, _MM_SHUFFLE(1, 1, 1, 1)));
+		for (; i < count; i++) {
+			tailLeft += left[i] * taps[i];
+			tailRight += right[i] * taps[i];
+		}
+		outLeft = tailLeft;
+		outRight = tailRight;
+	}
+
+	TRBDR_TARGET_AVX2 static int16_t peakPCMAVX2(const int16_t* in, size_t count) {
+		__m256i peaks = _mm256_setzero_si256();
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+			__m256i samples = _mm256_loadu_si256((const __m256i*)(in + i));
+			peaks = _mm256_max_epi16(peaks, _mm256_abs_epi16(_mm256_max_epi16(samples, _mm256_set1_epi16(-INT16_MAX))));
+		}
+		__m128i halves = _mm_max_epi16(_mm256_castsi256_si128(peaks), _mm256_extracti128_si256(peaks, 1));
+		int16_t peak = sse2HorizontalMax(halves);
+		int16_t tail = peakPCMSSE2(in + i, count - i);
+		return (tail > peak) ? tail : peak;
+	}
+
+	// True if both the CPU and the OS (saving YMM registers) support AVX2.
+	static bool cpuHasAVX2() {
+	#if defined(_MSC_VER)
+		int info[4] = { 0 };
+		__cpuid(info, 0);
+		if (info[0] < 7) { return false; }
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || ((_xgetbv(0) & 0x6) != 0x6)) { return false; }
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+	#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+	#endif
+	}
+#endif
+
+#if defined(TRBDR_KERNELS_NEON)
+	//---NEON---//
+	// Always present on ARM64.
+
+	static inline int32x4_t neonToInt32(float32x4_t samples) {
+		samples = vmaxq_f32(samples, vdupq_n_f32(-1.0f));
+		samples = vminq_f32(samples, vdupq_n_f32(1.0f));
+		return vcvtnq_s32_f32(vmulq_n_f32(samples, pcmScale));		// Round-to-nearest-even
+	}
+
+	static void floatStereoToPCMNEON(const float* in, int16_t* out, size_t frames) {
+		size_t count = frames * 2;
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			int16x8_t packed = vcombine_s16(vqmovn_s32(neonToInt32(vld1q_f32(in + i))), vqmovn_s32(neonToInt32(vld1q_f32(in + i + 4))));
+			vst1q_s16(out + i, packed);
+		}
+		floatStereoToPCMScalar(in + i, out + i, (count - i) / 2);
+	}
+
+	static void floatMonoToPCMStereoNEON(const float* in, int16_t* out, size_t frames) {
+		size_t i = 0;
+		for (; i + 8 <= frames; i += 8) {
+			int16x8_t packed = vcombine_s16(vqmovn_s32(neonToInt32(vld1q_f32(in + i))), vqmovn_s32(neonToInt32(vld1q_f32(in + i + 4))));
+			int16x8x2_t pairs = vzipq_s16(packed, packed);
+			vst1q_s16(out + (i * 2), pairs.val[0]);
+			vst1q_s16(out + (i * 2) + 8, pairs.val[1]);
+		}
+		floatMonoToPCMStereoScalar(in + i, out + (i * 2), frames - i);
+	}
+
+	// Converts four left and four right sums to 16-bit and stores them interleaved.
+	static inline void neonStoreStereo(float32x4_t left, float32x4_t right, int16_t* out) {
+		int16x4x2_t pairs = { { vqmovn_s32(neonToInt32(left)), vqmovn_s32(neonToInt32(right)) } };
+		vst2_s16(out, pairs);
+	}
+
+	static void quadToPCMStereoNEON(const float* in, int16_t* out, size_t frames) {
+		size_t i = 0;
+		for (; i + 4 <= frames; i += 4) {
+			float32x4x4_t ch = vld4q_f32(in + (i * 4));							// FL, FR, SL, SR of four frames
+			neonStoreStereo(vmlaq_n_f32(ch.val[0], ch.val[2], downmixGain), vmlaq_n_f32(ch.val[1], ch.val[3], downmixGain), out + (i * 2));
+		}
+		quadToPCMStereoScalar(in + (i * 4), out + (i * 2), frames - i);
+	}
+
+	// 5.1 and 7.1 don't deinterleave cleanly, so each two-frame load is weighted lane by lane
+	// and adjacent lanes are summed with a pairwise add afterwards.
+
+	static void surround51ToPCMStereoNEON(const float* in, int16_t* out, size_t frames) {
+		static const float frontWeights[4] = { 1.0f, 0.0f, 1.0f, 0.0f };
+		static const float oddWeights[4] = { 0.0f, downmixGain, 0.0f, downmixGain };
+		static const float centreWeights[4] = { downmixGain, 0.0f, downmixGain, 0.0f };
+		float32x4_t front = vld1q_f32(frontWeights), odd = vld1q_f32(oddWeights), centre = vld1q_f32(centreWeights);
+		size_t i = 0;
+		for (; i + 4 <= frames; i += 4) {
+			float32x4_t left[2], right[2];
+			for (int half = 0; half < 2; half++) {
+				float32x4x3_t ch = vld3q_f32(in + ((i + (half * 2)) * 6));		// FL LFE | FR SL | C SR, for two frames
+				left[half] = vmlaq_f32(vmlaq_f32(vmulq_f32(ch.val[0], front), ch.val[1], odd), ch.val[2], centre);
+				right[half] = vmlaq_n_f32(vmulq_f32(ch.val[1], front), ch.val[2], downmixGain);
+			}
+			neonStoreStereo(vpaddq_f32(left[0], left[1]), vpaddq_f32(right[0], right[1]), out + (i * 2));
+		}
+		surround51ToPCMStereoScalar(in + (i * 6), out + (i * 2), frames - i);
+	}
+
+	static void surround71ToPCMStereoNEON(const float* in, int16_t* out, size_t frames) {
+		static const float pairWeights[4] = { 1.0f, downmixGain, 1.0f, downmixGain };
+		static const float evenWeights[4] = { downmixGain, 0.0f, downmixGain, 0.0f };
+		static const float oddWeights[4] = { 0.0f, downmixGain, 0.0f, downmixGain };
+		float32x4_t pair = vld1q_f32(pairWeights), even = vld1q_f32(evenWeights), odd = vld1q_f32(oddWeights);
+		size_t i = 0;
+		for (; i + 4 <= frames; i += 4) {
+			float32x4_t left[2], right[2];
+			for (int half = 0; half < 2; half++) {
+				float32x4x4_t ch = vld4q_f32(in + ((i + (half * 2)) * 8));		// FL SL | FR SR | C BL | LFE BR, for two frames
+				left[half] = vmlaq_n_f32(vmulq_f32(ch.val[0], pair), ch.val[2], downmixGain);
+				right[half] = vmlaq_f32(vmlaq_f32(vmulq_f32(ch.val[1], pair), ch.val[2], even), ch.val[3], odd);
+			}
+			neonStoreStereo(vpaddq_f32(left[0], left[1]), vpaddq_f32(right[0], right[1]), out + (i * 2));
+		}
+		surround71ToPCMStereoScalar(in + (i * 8), out + (i * 2), frames - i);
+	}
+
+	static void dotProductStereoNEON(const float* left, const float* right, const float* taps, size_t count, float& outLeft, float& outRight) {
+		float32x4_t sumLeft = vdupq_n_f32(0.0f);
+		float32x4_t sumRight = vdupq_n_f32(0.0f);
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			float32x4_t coefs = vld1q_f32(taps + i);
+			sumLeft = vmlaq_f32(sumLeft, vld1q_f32(left + i), coefs);
+			sumRight = vmlaq_f32(sumRight, vld1q_f32(right + i), coefs);
+		}
+		float tailLeft, tailRight;
+		dotProductStereoScalar(left + i, right + i, taps + i, count - i, tailLeft, tailRight);
+		outLeft = vaddvq_f32(sumLeft) + tailLeft;
+		outRight = vaddvq_f32(sumRight) + tailRight;
+	}
+
+	static int16_t peakPCMNEON(const int16_t* in, size_t count) {
+		int16x8_t peaks = vdupq_n_s16(0);
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			peaks = vmaxq_s16(peaks, vqabsq_s16(vld1q_s16(in + i)));			// Saturating, so -32768 becomes 32767
+		}
+		return peakPCMScalar(in + i, count - i, vmaxvq_s16(peaks));
+	}
+#endif
+
+	//---Dispatch---//
+
+	static void (*stereoKernel)(const float*, int16_t*, size_t) = floatStereoToPCMScalar;
+	static void (*monoKernel)(const float*, int16_t*, size_t) = floatMonoToPCMStereoScalar;
+	static void (*quadKernel)(const float*, int16_t*, size_t) = quadToPCMStereoScalar;
+	static void (*surround51Kernel)(const float*, int16_t*, size_t) = surround51ToPCMStereoScalar;
+	static void (*surround71Kernel)(const float*, int16_t*, size_t) = surround71ToPCMStereoScalar;
+	static void (*dotStereoKernel)(const float*, const float*, const float*, size_t, float&, float&) = dotProductStereoScalar;
+	static int16_t (*peakKernel)(const int16_t*, size_t) = [](const int16_t* in, size_t count) { return peakPCMScalar(in, count); };
+	static const char* kernelName = "Scalar";
+
+	// Picks the fastest kernels this CPU supports.
+	void initKernels() {
+	#if defined(TRBDR_KERNELS_X86)
+		if (cpuHasAVX2()) {
+			stereoKernel = floatStereoToPCMAVX2;
+			monoKernel = floatMonoToPCMStereoAVX2;
+			quadKernel = quadToPCMStereoAVX2;
+			surround51Kernel = surround51ToPCMStereoAVX2;
+			surround71Kernel = surround71ToPCMStereoAVX2;
+			dotStereoKernel = dotProductStereoAVX2;
+			peakKernel = peakPCMAVX2;
+			kernelName = "AVX2";
+		}
+		else {
+			stereoKernel = floatStereoToPCMSSE2;
+			monoKernel = floatMonoToPCMStereoSSE2;
+			quadKernel = quadToPCMStereoSSE2;
+			surround51Kernel = surround51ToPCMStereoSSE2;
+			surround71Kernel = surround71ToPCMStereoSSE2;
+			dotStereoKernel = dotProductStereoSSE2;
+			peakKernel = peakPCMSSE2;
+			kernelName = "SSE2";
+		}
+	#elif defined(TRBDR_KERNELS_NEON)
+		stereoKernel = floatStereoToPCMNEON;
+		monoKernel = floatMonoToPCMStereoNEON;
+		quadKernel = quadToPCMStereoNEON;
+		surround51Kernel = surround51ToPCMStereoNEON;
+		surround71Kernel = surround71ToPCMStereoNEON;
+		dotStereoKernel = dotProductStereoNEON;
+		peakKernel = peakPCMNEON;
+		kernelName = "NEON";
+	#endif
+	}
+
+	// Name of the kernel set picked by initKernels().
+	const char* kernelSetName() {
+		return kernelName;
+	}
+
+	// Converts interleaved stereo float samples to interleaved stereo 16-bit PCM, saturating at +/-1.0.
+	void floatStereoToPCM(const float* in, int16_t* out, size_t frames) {
+		stereoKernel(in, out, frames);
+	}
+
+	// Converts mono float samples to interleaved stereo 16-bit PCM, duplicating each sample into both channels.
+	void floatMonoToPCMStereo(const float* in, int16_t* out, size_t frames) {
+		monoKernel(in, out, frames);
+	}
+
+	// True if downmixToPCMStereo() has a matrix for this many channels.
+	bool canDownmixToStereo(int channels) {
+		return (channels == 4) || (channels == 6) || (channels == 8);
+	}
+
+	// Downmixes interleaved quad, 5.1 or 7.1 float samples to interleaved stereo 16-bit PCM.
+	void downmixToPCMStereo(const float* in, int channels, int16_t* out, size_t frames) {
+		switch (channels) {
+			case 4: quadKernel(in, out, frames); break;
+			case 6: surround51Kernel(in, out, frames); break;
+			case 8: surround71Kernel(in, out, frames); break;
+			default: break;
+		}
+	}
+
+	// Dots two planar channels against the same set of filter taps.
+	void dotProductStereo(const float* left, const float* right, const float* taps, size_t count, float& outLeft, float& outRight) {
+		dotStereoKernel(left, right, taps, count, outLeft, outRight);
+	}
+
+	// Returns the largest absolute sample value in a run of 16-bit PCM.
+	int16_t peakPCM(const int16_t* in, size_t count) {
+		return peakKernel(in, count);
+	}
+}
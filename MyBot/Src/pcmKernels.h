@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//---PCM CONVERSION KERNELS---//
+
+namespace trbdrAudio {
+	// Picks the fastest kernels this CPU supports (AVX2 or SSE2 on x86, NEON on ARM64).
+	// Call once at startup, before FMOD starts mixing. Scalar kernels are used until then.
+	void initKernels();
+
+	// Name of the kernel set picked by initKernels(), for the startup log.
+	const char* kernelSetName();
+
+	// Converts interleaved stereo float samples to interleaved stereo 16-bit PCM, saturating at +/-1.0.
+	void floatStereoToPCM(const float* in, int16_t* out, size_t frames);
+
+	// Converts mono float samples to interleaved stereo 16-bit PCM, duplicating each sample into both channels.
+	void floatMonoToPCMStereo(const float* in, int16_t* out, size_t frames);
+
+	// True if downmixToPCMStereo() has a matrix for this many channels (quad, 5.1 and 7.1).
+	bool canDownmixToStereo(int channels);
+
+	// Downmixes interleaved float samples in FMOD's speaker order to interleaved stereo 16-bit PCM, using the
+	// ITU-R BS.775 gains: centre and surrounds at -3 dB into their side, LFE dropped. Saturates like the others.
+	void downmixToPCMStereo(const float* in, int channels, int16_t* out, size_t frames);
+
+	// Dots two planar channels against the same set of filter taps, for the resampler.
+	void dotProductStereo(const float* left, const float* right, const float* taps, size_t count, float& outLeft, float& outRight);
+
+	// Returns the largest absolute sample value in a run of 16-bit PCM (-32768 reads as 32767).
+	int16_t peakPCM(const int16_t* in, size_t count);
+}
@@ -0,0 +1,117 @@
+#include "pipelineMetrics.h"
+
+#include <cstdio>
+#include <fstream>
+
+//---PIPELINE METRICS---//
+
+namespace trbdrAudio {
+	// Mixer time the offsets are bucketed over, and the least that's worth reporting a drift from.
+	static constexpr int64_t driftBucketNs = 1000000000;
+	static constexpr double driftMinSeconds = 10.0;
+
+	// Buckets the offset between the two clocks, and once a bucket closes, fits a line through every bucket's minimum so far.
+	void pipelineMetrics::recordClock(uint64_t dspClock, int64_t capturedNs) {
+		// A 48 kHz sample is 62500/3 ns, so whole threes of them convert exactly and without overflowing
+		int64_t clockNs = (int64_t)(dspClock / 3 * 62500 + dspClock % 3 * 62500 / 3);
+		int64_t offsetNs = capturedNs - clockNs;
+
+		// A clock that jumps back is a new mixer, so start measuring again
+		if (dspClock < lastClock) {
+			haveReference = false;
+			bucketStartNs = 0;
+			driftPpm.store(0.0, std::memory_order_relaxed);
+			driftSeconds.store(0.0, std::memory_order_relaxed);
+		}
+		lastClock = dspClock;
+
+		if (bucketStartNs == 0 || capturedNs - bucketStartNs >= driftBucketNs) {
+			if (bucketStartNs != 0) {
+				if (!haveReference) {
+					referenceOffsetNs = bucketMinOffsetNs;
+					referenceClock = bucketMinClock;
+					buckets = sumSeconds = sumOffsetNs = sumSecondsSquared = sumProduct = 0.0;
+					haveReference = true;
+				}
+				double seconds = (double)(bucketMinClock - referenceClock) / 48000.0;
+				double offset = (double)(bucketMinOffsetNs - referenceOffsetNs);
+				buckets += 1.0;
+				sumSeconds += seconds;
+				sumOffsetNs += offset;
+				sumSecondsSquared += seconds * seconds;
+				sumProduct += seconds * offset;
+
+				double spread = buckets * sumSecondsSquared - sumSeconds * sumSeconds;
+				if (seconds >= driftMinSeconds && spread > 0.0) {
+					// Offset growing means steady_clock gets ahead, i.e. the mixer's slow. Nanoseconds a second is ppm times 1000
+					double slope = (buckets * sumProduct - sumSeconds * sumOffsetNs) / spread;
+					driftPpm.store(-slope / 1000.0, std::memory_order_relaxed);
+					driftSeconds.store(seconds, std::memory_order_relaxed);
+				}
+			}
+			bucketStartNs = capturedNs;
+			bucketMinOffsetNs = offsetNs;
+			bucketMinClock = dspClock;
+			return;
+		}
+		if (offsetNs < bucketMinOffsetNs) {
+			bucketMinOffsetNs = offsetNs;
+			bucketMinClock = dspClock;
+		}
+	}
+
+	// Starts a new rolling window.
+	void pipelineMetrics::rotate() {
+		for (auto& stage : stages) { stage.rotate(); }
+	}
+
+	// One line per stage with p50/p95/p99/max in milliseconds, then the DSP clock's drift.
+	std::string pipelineMetrics::report() const {
+		std::string out;
+		char line[160];
+		for (size_t i = 0; i < (size_t)pipelineStage::count; i++) {
+			const rollingLatencyHistogram& stage = stages[i];
+			snprintf(line, sizeof(line), "%-10s p50 %7.2fms  p95 %7.2fms  p99 %7.2fms  max %7.2fms  (%llu frames)\n",
+				stageName((pipelineStage)i), stage.percentile(50) / 1000.0, stage.percentile(95) / 1000.0,
+				stage.percentile(99) / 1000.0, stage.max() / 1000.0, (unsigned long long)stage.count());
+			out += line;
+		}
+
+		double seconds = driftSeconds.load(std::memory_order_relaxed);
+		if (seconds > 0.0) {
+			snprintf(line, sizeof(line), "DSP clock %+.1f ppm against steady_clock, over %.0fs\n", driftPpm.load(std::memory_order_relaxed), seconds);
+		}
+		else {
+			snprintf(line, sizeof(line), "DSP clock drift not measured yet\n");
+		}
+		out += line;
+		return out;
+	}
+
+	// Writes report() to "path" via a temporary file and a rename.
+	bool pipelineMetrics::writeFile(const std::filesystem::path& path) const {
+		std::filesystem::path tempPath = path;
+		tempPath += ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::trunc);
+			if (!file) { return false; }
+			file << report();
+			if (!file) { return false; }
+		}
+		std::error_code error;
+		std::filesystem::rename(tempPath, path, error);
+		return !error;
+	}
+
+	const char* pipelineMetrics::stageName(pipelineStage stage) {
+		switch (stage) {
+			case pipelineStage::fill: return "Fill";
+			case pipelineStage::queue: return "Queue";
+			case pipelineStage::encode: return "Encode";
+			case pipelineStage::send: return "Send";
+			case pipelineStage::dppQueue: return "D++ Queue";
+			case pipelineStage::total: return "Total";
+			default: return "Unknown";
+		}
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "latencyHistogram.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+//---PIPELINE METRICS---//
+
+namespace trbdrAudio {
+	// Stages each frame goes through between FMOD and the network. "Total" runs from capture to when
+	// D++ should actually put the packet on the wire (send time plus what's queued ahead of it).
+	enum class pipelineStage {
+		fill,			// First sample captured -> frame published by the mixer thread
+		queue,			// Published -> picked up by the encoder thread
+		encode,			// opus_encode
+		send,			// Encoded -> send_audio_opus returned
+		dppQueue,		// Audio queued in D++ ahead of this packet
+		total,
+		count
+	};
+
+	// Rolling latency histograms for each pipelineStage. Recording is lock-free and allocation-free;
+	// formatting reports and writing the file allocate, so those stay off the audio threads.
+	class pipelineMetrics {
+	public:
+		void record(pipelineStage stage, uint64_t us) { stages[(size_t)stage].record(us); }
+
+		// Measures how fast the mixer's DSP clock runs against steady_clock, from each frame's two capture stamps.
+		// "dspClock" is in 48 kHz samples. Call from one thread only, in capture order.
+		void recordClock(uint64_t dspClock, int64_t capturedNs);
+
+		// The DSP clock's drift in ppm, positive when the mixer runs fast. 0 until there's enough audio to tell.
+		double clockDriftPpm() const { return driftPpm.load(std::memory_order_relaxed); }
+
+		// Starts a new rolling window. Reports cover the last one to two windows.
+		void rotate();
+
+		// One line per stage with p50/p95/p99/max in milliseconds, then the DSP clock's drift.
+		std::string report() const;
+
+		// Writes report() to "path", replacing it whole so readers never see half a file. Returns false on failure.
+		bool writeFile(const std::filesystem::path& path) const;
+
+		static const char* stageName(pipelineStage stage);
+
+	private:
+		rollingLatencyHistogram stages[(size_t)pipelineStage::count];
+
+		// recordClock()'s thread only. Each bucket keeps the smallest steady_clock-minus-DSP-clock offset it saw, which
+		// strips out most of the mixer callback jitter; drift is the least-squares slope through those minimums.
+		uint64_t lastClock = 0;
+		int64_t bucketStartNs = 0;
+		int64_t bucketMinOffsetNs = 0;
+		uint64_t bucketMinClock = 0;
+		bool haveReference = false;
+		int64_t referenceOffsetNs = 0;							// The first bucket's, which the sums are taken relative to
+		uint64_t referenceClock = 0;
+		double buckets = 0.0, sumSeconds = 0.0, sumOffsetNs = 0.0, sumSecondsSquared = 0.0, sumProduct = 0.0;
+
+		std::atomic<double> driftPpm = 0.0;				// Positive when the mixer runs fast
+		std::atomic<double> driftSeconds = 0.0;			// How much DSP clock the figure is measured over
+	};
+}
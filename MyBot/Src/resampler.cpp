@@ -0,0 +1,139 @@
+#include "resampler.h"
+#include "pcmKernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+//---POLYPHASE RESAMPLER---//
+
+namespace trbdrAudio {
+	static constexpr double pi = 3.14159265358979323846;
+
+	// Passband edge as a fraction of the lower Nyquist frequency. Leaves room for the transition band.
+	static constexpr double resamplerCutoff = 0.92;
+
+	// Builds the filter for this input rate. Call before the mixer thread can call process().
+	void polyphaseResampler::configure(int newInputRate, int newOutputRate, bool alwaysActive) {
+		inputRate = newInputRate;
+		outputRate = newOutputRate;
+		active = (alwaysActive || (inputRate != outputRate)) && (inputRate > 0) && (outputRate > 0);
+		if (!active) { return; }
+
+		baseRatio = (double)inputRate / (double)outputRate;
+
+		// Blackman-windowed sinc, with its cutoff below whichever Nyquist is lower so downsampling doesn't alias.
+		// Row p is the filter shifted by p / resamplerPhases of an input sample. There's one extra row
+		// so interpolating past the last phase doesn't need a special case.
+		double cutoff = resamplerCutoff * std::min(1.0, 1.0 / baseRatio);
+		double halfWidth = resamplerTaps / 2.0;
+		filter.assign((resamplerPhases + 1) * resamplerTaps, 0.0f);
+		for (size_t p = 0; p <= resamplerPhases; p++) {
+			float* row = filter.data() + (p * resamplerTaps);
+			double rowSum = 0.0;
+			for (size_t k = 0; k < resamplerTaps; k++) {
+				double x = (double)k - (halfWidth - 1.0) - ((double)p / resamplerPhases);
+				double sinc = (x == 0.0) ? 1.0 : std::sin(pi * cutoff * x) / (pi * cutoff * x);
+				double w = (x + halfWidth) / (2.0 * halfWidth);
+				double window = (w <= 0.0 || w >= 1.0) ? 0.0 : 0.42 - 0.5 * std::cos(2.0 * pi * w) + 0.08 * std::cos(4.0 * pi * w);
+				row[k] = (float)(sinc * window);
+				rowSum += row[k];
+			}
+			for (size_t k = 0; k < resamplerTaps; k++) {
+				row[k] = (float)(row[k] / rowSum);		// Unity gain at DC for every phase
+			}
+		}
+
+		historyLeft.assign(resamplerTaps + resamplerBlockFrames, 0.0f);
+		historyRight.assign(resamplerTaps + resamplerBlockFrames, 0.0f);
+		reset();
+	}
+
+	// Scales the base conversion ratio by (1 + ppm / 1,000,000).
+	void polyphaseResampler::setRatioAdjustPpm(double ppm) {
+		ratioAdjust.store(1.0 + (ppm / 1000000.0), std::memory_order_relaxed);
+	}
+
+	// Resamples up to resamplerBlockFrames frames of interleaved stereo into "sink".
+	void polyphaseResampler::process(const int16_t* in, size_t frames, pcmFrameBuffer& sink) {
+		auto blockStart = std::chrono::steady_clock::now();
+		frames = std::min(frames, resamplerBlockFrames);
+
+		for (size_t i = 0; i < frames; i++) {
+			historyLeft[historyFrames + i] = (float)in[(i * 2)];
+			historyRight[historyFrames + i] = (float)in[(i * 2) + 1];
+		}
+		historyFrames += frames;
+
+		double step = baseRatio * ratioAdjust.load(std::memory_order_relaxed);
+		uint64_t produced = 0;
+		while ((size_t)position + resamplerTaps <= historyFrames) {
+			size_t base = (size_t)position;
+			double phase = (position - (double)base) * resamplerPhases;
+			size_t row = (size_t)phase;
+			float blend = (float)(phase - (double)row);
+
+			const float* taps = filter.data() + (row * resamplerTaps);
+			float left0, right0, left1, right1;
+			dotProductStereo(historyLeft.data() + base, historyRight.data() + base, taps, resamplerTaps, left0, right0);
+			dotProductStereo(historyLeft.data() + base, historyRight.data() + base, taps + resamplerTaps, resamplerTaps, left1, right1);
+			emit(left0 + ((left1 - left0) * blend), right0 + ((right1 - right0) * blend), sink);
+
+			position += step;
+			produced++;
+		}
+
+		// Slide what's still needed back to the front, ready for the next block
+		size_t consumed = std::min((size_t)position, historyFrames);
+		size_t kept = historyFrames - consumed;
+		memmove(historyLeft.data(), historyLeft.data() + consumed, kept * sizeof(float));
+		memmove(historyRight.data(), historyRight.data() + consumed, kept * sizeof(float));
+		historyFrames = kept;
+		position -= (double)consumed;
+
+		auto blockNs = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - blockStart).count();
+		blocks.fetch_add(1, std::memory_order_relaxed);
+		totalBlockNs.fetch_add(blockNs, std::memory_order_relaxed);
+		if (blockNs > maxBlockNs.load(std::memory_order_relaxed)) {
+			maxBlockNs.store(blockNs, std::memory_order_relaxed);		// Only the mixer thread writes it
+		}
+		framesOut.fetch_add(produced, std::memory_order_relaxed);
+		historyDepth.store(historyFrames, std::memory_order_relaxed);
+	}
+
+	// Forgets buffered history. Starts with half a filter of silence so the first output lines up with the first input.
+	void polyphaseResampler::reset() {
+		std::fill(historyLeft.begin(), historyLeft.end(), 0.0f);
+		std::fill(historyRight.begin(), historyRight.end(), 0.0f);
+		historyFrames = resamplerTaps / 2 - 1;
+		position = 0.0;
+	}
+
+	resamplerStats polyphaseResampler::stats() const {
+		resamplerStats out;
+		out.active = active;
+		out.inputRate = inputRate;
+		if (!active) { return out; }
+
+		out.ratio = baseRatio * ratioAdjust.load(std::memory_order_relaxed);
+		double lookaheadFrames = (double)historyDepth.load(std::memory_order_relaxed) - ((resamplerTaps / 2.0) - 1.0);
+		out.latencyMs = std::max(0.0, lookaheadFrames) * 1000.0 / inputRate;
+		out.blocks = blocks.load(std::memory_order_relaxed);
+		uint64_t totalNs = totalBlockNs.load(std::memory_order_relaxed);
+		out.averageBlockNs = (out.blocks > 0) ? totalNs / out.blocks : 0;
+		out.maxBlockNs = maxBlockNs.load(std::memory_order_relaxed);
+		uint64_t audioNs = framesOut.load(std::memory_order_relaxed) * 1000000000ull / (uint64_t)outputRate;
+		out.cpuPercent = (audioNs > 0) ? (100.0 * (double)totalNs / (double)audioNs) : 0.0;
+		return out;
+	}
+
+	// Converts one output frame back to 16-bit and appends it to the sink.
+	void polyphaseResampler::emit(float left, float right, pcmFrameBuffer& sink) {
+		size_t samplesFree = 0;
+		int16_t* out = sink.writePtr(samplesFree);
+		out[0] = (int16_t)lrintf(std::clamp(left, -32767.0f, 32767.0f));
+		out[1] = (int16_t)lrintf(std::clamp(right, -32767.0f, 32767.0f));
+		sink.commitWrite(frameChannels);
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "frameBuffer.h"
+#include <atomic>
+#include <vector>
+
+//---POLYPHASE RESAMPLER---//
+
+namespace trbdrAudio {
+	// Most input frames process() takes per call. Callers chunk anything bigger.
+	inline constexpr size_t resamplerBlockFrames = 1024;
+
+	// Filter shape. Each output sample is a 32-tap dot product, interpolated between two of 128 filter phases.
+	inline constexpr size_t resamplerTaps = 32;
+	inline constexpr size_t resamplerPhases = 128;
+
+	// Snapshot of what resampling is costing, for the logs.
+	struct resamplerStats {
+		bool active = false;
+		int inputRate = 0;
+		double ratio = 0.0;										// Input frames consumed per output frame
+		double latencyMs = 0.0;									// Input the filter has to wait for before it can produce output
+		uint64_t blocks = 0;
+		uint64_t averageBlockNs = 0;
+		uint64_t maxBlockNs = 0;
+		double cpuPercent = 0.0;								// Processing time as a share of the audio time it produced
+	};
+
+	// Converts interleaved stereo 16-bit PCM from the mixer's rate to 48 kHz, writing into a pcmFrameBuffer.
+	// Needed when FMOD won't mix at 48 kHz itself, and for drift compensation, which nudges the ratio while running.
+	// configure() allocates everything up front, so process() is safe to call from FMOD's mixer thread.
+	class polyphaseResampler {
+	public:
+		// Builds the filter for this input rate. Call before the mixer thread can call process().
+		// With "alwaysActive", runs even when the rates match, so the ratio can still be adjusted.
+		void configure(int inputRate, int outputRate, bool alwaysActive = false);
+
+		// True once configure() has been called with a rate that needs converting, or with "alwaysActive".
+		bool isActive() const { return active; }
+
+		// Scales the base conversion ratio by (1 + ppm / 1,000,000). Safe from any thread.
+		void setRatioAdjustPpm(double ppm);
+
+		// Resamples up to resamplerBlockFrames frames of interleaved stereo into "sink". Mixer thread only.
+		void process(const int16_t* in, size_t frames, pcmFrameBuffer& sink);
+
+		// Forgets buffered history, for when the stream restarts.
+		void reset();
+
+		resamplerStats stats() const;
+
+	private:
+		void emit(float left, float right, pcmFrameBuffer& sink);
+
+		bool active = false;
+		int inputRate = 0;
+		int outputRate = 0;
+		double baseRatio = 1.0;
+		std::atomic<double> ratioAdjust = 1.0;
+
+		std::vector<float> filter;								// (resamplerPhases + 1) rows of resamplerTaps
+		std::vector<float> historyLeft;							// Planar, so the taps can be dotted straight off them
+		std::vector<float> historyRight;
+		size_t historyFrames = 0;
+		double position = 0.0;									// Read position into history, in input frames
+
+		std::atomic<uint64_t> blocks = 0;
+		std::atomic<uint64_t> totalBlockNs = 0;
+		std::atomic<uint64_t> maxBlockNs = 0;
+		std::atomic<uint64_t> framesOut = 0;
+		std::atomic<size_t> historyDepth = 0;
+	};
+}
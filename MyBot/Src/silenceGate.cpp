@@ -0,0 +1,34 @@
+#include "silenceGate.h"
+
+//---SILENCE GATE---//
+
+namespace trbdrAudio {
+	// Feeds one frame's peak level in, along with whether anything is still playing in FMOD.
+	bool silenceGate::update(int16_t peak, bool mixIdle) {
+		if (!open) {
+			if (peak >= gateOpenPeak) {
+				open = true;
+				quietFrames = 0;
+			}
+			return open;
+		}
+
+		if (peak >= gateClosePeak) {
+			quietFrames = 0;
+			return true;
+		}
+
+		quietFrames++;
+		if (quietFrames >= (mixIdle ? gateTailFrames : gateActiveHoldFrames)) {
+			open = false;
+			quietFrames = 0;
+		}
+		return open;
+	}
+
+	// Starts closed, as if nothing had played yet.
+	void silenceGate::reset() {
+		open = false;
+		quietFrames = 0;
+	}
+}
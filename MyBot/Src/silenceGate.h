@@ -0,0 +1,35 @@
+#pragma once
+
+#include "frameBuffer.h"
+
+//---SILENCE GATE---//
+
+namespace trbdrAudio {
+	// Peak levels, in 16-bit sample units, that open and close the gate. Opening is about -60 dBFS,
+	// closing about -66 dBFS, so a signal hovering around one threshold doesn't flap the gate.
+	inline constexpr int16_t gateOpenPeak = 33;
+	inline constexpr int16_t gateClosePeak = 16;
+
+	// How long the mix has to stay quiet before the gate closes. Short once nothing is playing,
+	// so the reverb tail of the last sound still makes it out. Longer while something is still
+	// playing, so quiet passages and gaps between sounds in an event aren't chopped up.
+	inline constexpr size_t gateTailFrames = 500 / frameLengthMs;
+	inline constexpr size_t gateActiveHoldFrames = 3000 / frameLengthMs;
+
+	// Decides per frame whether the voice stream should be transmitting. Only touched by the encoder thread.
+	class silenceGate {
+	public:
+		// Feeds one frame's peak level in, along with whether anything is still playing in FMOD.
+		// Returns true if this frame should be sent.
+		bool update(int16_t peak, bool mixIdle);
+
+		// Starts closed, as if nothing had played yet.
+		void reset();
+
+		bool isOpen() const { return open; }
+
+	private:
+		bool open = false;
+		size_t quietFrames = 0;
+	};
+}
@@ -0,0 +1,81 @@
+#include "tickTimer.h"
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+	#include <timeapi.h>
+#endif
+
+//---TICK TIMER---//
+
+namespace trbdrUtils {
+	static uint64_t elapsedUs(tickTimer::clock::time_point from, tickTimer::clock::time_point to) {
+		if (to <= from) { return 0; }
+		return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+	}
+
+	void tickMetrics::record(uint64_t jitterUs, uint64_t durationUs) {
+		ticks.fetch_add(1, std::memory_order_relaxed);
+		totalJitterUs.fetch_add(jitterUs, std::memory_order_relaxed);
+		totalDurationUs.fetch_add(durationUs, std::memory_order_relaxed);
+		// Only the recording thread writes these
+		if (jitterUs > maxJitterUs.load(std::memory_order_relaxed)) { maxJitterUs.store(jitterUs, std::memory_order_relaxed); }
+		if (durationUs > maxDurationUs.load(std::memory_order_relaxed)) { maxDurationUs.store(durationUs, std::memory_order_relaxed); }
+	}
+
+	void tickMetrics::recordSkipped(uint64_t count) {
+		skipped.fetch_add(count, std::memory_order_relaxed);
+	}
+
+	tickStats tickMetrics::stats() const {
+		tickStats out;
+		out.ticks = ticks.load(std::memory_order_relaxed);
+		out.skipped = skipped.load(std::memory_order_relaxed);
+		out.averageJitterUs = (out.ticks > 0) ? totalJitterUs.load(std::memory_order_relaxed) / out.ticks : 0;
+		out.maxJitterUs = maxJitterUs.load(std::memory_order_relaxed);
+		out.averageDurationUs = (out.ticks > 0) ? totalDurationUs.load(std::memory_order_relaxed) / out.ticks : 0;
+		out.maxDurationUs = maxDurationUs.load(std::memory_order_relaxed);
+		return out;
+	}
+
+	tickTimer::~tickTimer() { stop(); }
+
+	void tickTimer::start(std::chrono::nanoseconds newInterval, std::function<void(clock::time_point deadline)> newOnTick) {
+		if (running) { return; }
+		interval = newInterval;
+		onTick = std::move(newOnTick);
+		running = true;
+#ifdef _WIN32
+		timeBeginPeriod(1);		// Windows sleeps in ~15.6ms steps otherwise, coarser than a tick
+#endif
+		thread = std::thread(&tickTimer::run, this);
+	}
+
+	void tickTimer::stop() {
+		if (!running.exchange(false)) { return; }
+		if (thread.joinable()) { thread.join(); }
+#ifdef _WIN32
+		timeEndPeriod(1);
+#endif
+	}
+
+	void tickTimer::run() {
+		clock::time_point deadline = clock::now();
+		while (running) {
+			clock::time_point started = clock::now();
+			onTick(deadline);
+			clock::time_point finished = clock::now();
+			timing.record(elapsedUs(deadline, started), elapsedUs(started, finished));
+
+			// Stay on the grid. Anything already missed is skipped, not run in a burst to catch up
+			deadline += interval;
+			if (deadline <= finished) {
+				uint64_t missed = (uint64_t)((finished - deadline) / interval) + 1;
+				timing.recordSkipped(missed);
+				deadline += interval * (int64_t)missed;
+			}
+			std::this_thread::sleep_until(deadline);
+		}
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+//---TICK TIMER---//
+
+namespace trbdrUtils {
+	// Snapshot of how punctual a run of ticks has been, for the logs.
+	struct tickStats {
+		uint64_t ticks = 0;
+		uint64_t skipped = 0;									// Deadlines missed outright, because the tick before ran long
+		uint64_t averageJitterUs = 0;							// How late ticks started, after their deadline
+		uint64_t maxJitterUs = 0;
+		uint64_t averageDurationUs = 0;							// How long ticks took to run
+		uint64_t maxDurationUs = 0;
+	};
+
+	// Running totals behind tickStats. record() belongs to one thread at a time; stats() can be read from anywhere.
+	class tickMetrics {
+	public:
+		void record(uint64_t jitterUs, uint64_t durationUs);
+		void recordSkipped(uint64_t count);
+
+		tickStats stats() const;
+
+	private:
+		std::atomic<uint64_t> ticks = 0;
+		std::atomic<uint64_t> skipped = 0;
+		std::atomic<uint64_t> totalJitterUs = 0;
+		std::atomic<uint64_t> maxJitterUs = 0;
+		std::atomic<uint64_t> totalDurationUs = 0;
+		std::atomic<uint64_t> maxDurationUs = 0;
+	};
+
+	// A thread that calls onTick at a fixed rate, against absolute deadlines so a slow tick doesn't push the rest later.
+	// If a tick overruns whole intervals, those deadlines are skipped rather than run back to back, and the cadence stays on its grid.
+	class tickTimer {
+	public:
+		using clock = std::chrono::steady_clock;
+
+		tickTimer() = default;
+		~tickTimer();
+
+		tickTimer(const tickTimer&) = delete;
+		tickTimer& operator=(const tickTimer&) = delete;
+
+		// Starts ticking every "interval". onTick is given the deadline it was due at.
+		void start(std::chrono::nanoseconds interval, std::function<void(clock::time_point deadline)> onTick);
+
+		// Lets the current tick finish, then joins the thread.
+		void stop();
+
+		tickStats stats() const { return timing.stats(); }
+
+	private:
+		void run();
+
+		std::chrono::nanoseconds interval{ 0 };
+		std::function<void(clock::time_point)> onTick;
+		std::thread thread;
+		std::atomic<bool> running = false;
+		tickMetrics timing;
+	};
+}
@@ -4,7 +4,11 @@
 #include <dpp/dpp.h>
 #include "fmod_studio.hpp"
 #include "fmod_errors.h"
+#include <cstring>
 #include <filesystem>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
 
 //---UTILS---//
 
@@ -90,7 +94,9 @@ namespace trbdrUtils {
 
 	// Struct to contain each Event Description and all associated parameters.
 	struct sessionEventDesc {
-		FMOD::Studio::EventDescription* description = nullptr;
+		FMOD::Studio::EventDescription* description = nullptr;	// Null until first used, if it came from the saved index
+		FMOD_GUID id = {};
+		std::string bankFile;										// File name of the bank it's in, so it can be loaded again on demand
 		std::vector<FMOD_STUDIO_PARAMETER_DESCRIPTION> params;
 	};
 
@@ -98,6 +104,7 @@ namespace trbdrUtils {
 	struct sessionEventInstance {
 		FMOD::Studio::EventInstance* instance = nullptr;
 		std::vector<FMOD_STUDIO_PARAMETER_DESCRIPTION> params;
+		std::string sourceEvent;				// Nice name of the Event Description it came from
 	};
 
 	struct sessionSoundInstance {
@@ -105,6 +112,50 @@ namespace trbdrUtils {
 		FMOD::Channel* channel = nullptr;
 	};
 
+	// A parameter as the dashboard shows it, with its value read and everything already formatted.
+	struct snapshotParam {
+		std::string name;
+		float value = 0.0f;
+		std::string valueText;
+		std::string rangeText;					// Min/max and attributes
+		bool readOnly = false;
+	};
+
+	struct snapshotEventInstance {
+		std::string name;
+		std::string sourceEvent;
+		std::vector<snapshotParam> params;
+	};
+
+	struct snapshotFader {
+		std::string name;
+		float volumeDb = 0.0f;
+	};
+
+	// Everything a session can play or set, by the names users type. Only changes when the session re-indexes,
+	// so one copy is shared by every snapshot until then.
+	struct sessionCatalog {
+		std::vector<std::string> events;
+		std::vector<std::string> snapshots;
+		std::vector<std::string> sounds;
+		std::vector<std::string> globalParams;
+		std::vector<std::string> busses;
+		std::vector<std::string> vcas;
+	};
+
+	// Read-only picture of a session, published once per tick. Never changed once published, so any thread can read it
+	// without locks or FMOD calls, and everything in one is from the same tick.
+	struct sessionSnapshot {
+		uint64_t tick = 0;
+		std::shared_ptr<const sessionCatalog> catalog;
+		std::vector<snapshotEventInstance> events;
+		std::vector<std::string> snapshots;					// Playing Snapshot instances
+		std::vector<std::pair<std::string, std::string>> sounds;	// Playing sound instances, and the sound file each is playing
+		std::vector<snapshotParam> globalParams;
+		std::vector<snapshotFader> busses;
+		std::vector<snapshotFader> vcas;
+	};
+
 	// Struct to handle Channel Control objects in callbacks and split between them
 	// Ideally this would be a Union or std::variant, but I can't figure out how to properly use those
 	struct coreCallbackChannelControlObj {
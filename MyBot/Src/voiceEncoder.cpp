@@ -0,0 +1,569 @@
+#include "voiceEncoder.h"
+#include "pcmKernels.h"
+
+#include <dpp/dpp.h>
+#include <opus/opus.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+//---VOICE ENCODER---//
+
+namespace trbdrAudio {
+	// Microseconds from one steady_clock stamp to another, clamped at zero.
+	static uint64_t elapsedUs(int64_t fromNs, int64_t toNs) {
+		return (toNs > fromNs) ? (uint64_t)(toNs - fromNs) / 1000 : 0;
+	}
+
+	static int64_t nowNs() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// True if every left sample matches its right, i.e. the mix is really mono.
+	static bool isMonoPCM(const int16_t* in, size_t frames) {
+		for (size_t i = 0; i < frames; i++) {
+			if (in[i * 2] != in[i * 2 + 1]) { return false; }
+		}
+		return true;
+	}
+
+	voiceEncoder::voiceEncoder(pcmFrameBuffer& source, pipelineMetrics& metrics, double bitrateBackoffMs, double bitrateRecoverMs)
+		: source(source), metrics(metrics), bitrateControl(bitrateBackoffMs, bitrateRecoverMs) {}
+
+	voiceEncoder::~voiceEncoder() {
+		stop();
+	}
+
+	// Creates the libopus encoder and starts the encoder thread.
+	bool voiceEncoder::start() {
+		if (running) { return true; }
+
+		int error = OPUS_OK;
+		encoder = opus_encoder_create((opus_int32)frameSampleRate, (int)frameChannels, OPUS_APPLICATION_AUDIO, &error);
+		if (error != OPUS_OK || encoder == nullptr) {
+			std::cout << "Opus Error! Couldn't create encoder: " << opus_strerror(error) << std::endl;
+			encoder = nullptr;
+			return false;
+		}
+		opus_encoder_ctl(encoder, OPUS_SET_SIGNAL(OPUS_SIGNAL_MUSIC));		// Almost never speech, this bot
+		applyProfile();
+
+		running = true;
+		thread = std::thread(&voiceEncoder::run, this);
+		return true;
+	}
+
+	// Stops and joins the encoder thread, then releases the libopus encoder.
+	void voiceEncoder::stop() {
+		running = false;
+		source.wake();
+		if (thread.joinable()) { thread.join(); }
+		if (encoder != nullptr) {
+			opus_encoder_destroy(encoder);
+			encoder = nullptr;
+		}
+	}
+
+	// Adds somewhere for packets to go. A client already in the list is left alone, and one for a guild
+	// that's already listening takes the old client's place, since D++ has freed or is about to free it.
+	void voiceEncoder::addDestination(dpp::discord_voice_client* client) {
+		if (client == nullptr) { return; }
+		bool first = false;
+		{
+			std::lock_guard<std::mutex> lock(clientMutex);
+			for (auto it = destinations.begin(); it != destinations.end(); ++it) {
+				if (it->client == client) { return; }
+				if (it->stats.serverId == (uint64_t)client->server_id) {
+					destinations.erase(it);
+					break;
+				}
+			}
+			first = destinations.empty();
+			destination added;
+			added.client = client;
+			added.stats.serverId = (uint64_t)client->server_id;
+			destinations.push_back(added);
+			hasDestinations = true;
+		}
+		// Whatever's queued was meant for the old connection, so start the new one from live.
+		// A listener joining mid-stream just starts at the next packet.
+		if (first && policy.load(std::memory_order_relaxed) == dropPolicy::dropToLatest) {
+			catchUpPending.store(true, std::memory_order_relaxed);
+		}
+		source.wake();		// Let the encoder thread see the change even if no frames are coming
+	}
+
+	// Stops sending to a client. Waits for any send in progress before returning.
+	void voiceEncoder::removeDestination(dpp::discord_voice_client* client) {
+		{
+			std::lock_guard<std::mutex> lock(clientMutex);
+			for (auto it = destinations.begin(); it != destinations.end(); ++it) {
+				if (it->client == client) {
+					destinations.erase(it);
+					break;
+				}
+			}
+			hasDestinations = !destinations.empty();
+		}
+		source.wake();
+	}
+
+	size_t voiceEncoder::destinationCount() {
+		std::lock_guard<std::mutex> lock(clientMutex);
+		return destinations.size();
+	}
+
+	std::vector<voiceDestinationStats> voiceEncoder::destinationStats() {
+		std::lock_guard<std::mutex> lock(clientMutex);
+		std::vector<voiceDestinationStats> out;
+		for (const destination& target : destinations) {
+			out.push_back(target.stats);
+		}
+		return out;
+	}
+
+	// Tells the gate whether anything is playing in FMOD.
+	void voiceEncoder::setMixIdle(bool idle) {
+		mixIdle.store(idle, std::memory_order_relaxed);
+	}
+
+	// Bounds the audio allowed to wait ahead of Discord.
+	void voiceEncoder::setQueueLimits(dropPolicy newPolicy, size_t maxFrames, uint32_t catchUpMs) {
+		policy.store(newPolicy, std::memory_order_relaxed);
+		maxQueuedFrames.store(maxFrames, std::memory_order_relaxed);
+		catchUpUs.store(catchUpMs * 1000, std::memory_order_relaxed);
+	}
+
+	// Switches encoder settings at the next packet boundary.
+	void voiceEncoder::setProfile(const opusProfile& newProfile) {
+		std::lock_guard<std::mutex> lock(profileMutex);
+		requestedProfile = newProfile;
+		profileChanged.store(true, std::memory_order_release);
+	}
+
+	std::string voiceEncoder::profileName() {
+		std::lock_guard<std::mutex> lock(profileMutex);
+		return requestedProfile.name;
+	}
+
+	// Encode CPU measured for every profile used so far.
+	std::vector<profileEncodeStats> voiceEncoder::profileStats() {
+		std::lock_guard<std::mutex> lock(profileStatsMutex);
+		std::vector<profileEncodeStats> out;
+		for (const auto& [name, ps] : profileEncodeTimes) {
+			profileEncodeStats copy = ps;
+			copy.cpuPercent = (ps.audioMs > 0) ? (double)ps.encodeUs / (ps.audioMs * 10.0) : 0.0;
+			out.push_back(copy);
+		}
+		return out;
+	}
+
+	encoderStats voiceEncoder::stats() const {
+		encoderStats out;
+		out.packetsEncoded = packetsEncoded.load(std::memory_order_relaxed);
+		out.encodeErrors = encodeErrors.load(std::memory_order_relaxed);
+		out.framesGated = framesGated.load(std::memory_order_relaxed);
+		out.gateOpens = gateOpens.load(std::memory_order_relaxed);
+		out.averageEncodeUs = (out.packetsEncoded > 0) ? totalEncodeUs.load(std::memory_order_relaxed) / out.packetsEncoded : 0;
+		out.maxEncodeUs = maxEncodeUs.load(std::memory_order_relaxed);
+		out.framesDropped = framesDropped.load(std::memory_order_relaxed);
+		out.dppFramesDropped = dppFramesDropped.load(std::memory_order_relaxed);
+		out.catchUps = catchUps.load(std::memory_order_relaxed);
+		out.cachedPacketsSent = cachedPacketsSent.load(std::memory_order_relaxed);
+		return out;
+	}
+
+	void voiceEncoder::run() {
+		while (running) {
+			// Nobody to send to, so anything captured is stale by the time we'd need it
+			if (!hasDestinations) {
+				packetFrames = 0;
+				resetCachedPosition();
+				source.clear();
+				gate.reset();		// Next destination starts from a closed gate, with no silence tail owed
+				source.waitForFrame();
+				continue;
+			}
+
+			if (source.framesAvailable() == 0) {
+				source.waitForFrame();
+				continue;
+			}
+
+			enforceQueueLimits();
+			while (source.framesAvailable() > 0 && source.pop(frame)) {
+				metrics.record(pipelineStage::fill, elapsedUs(frame.capturedNs, frame.publishedNs));
+				metrics.record(pipelineStage::queue, elapsedUs(frame.publishedNs, nowNs()));
+				metrics.recordClock(frame.dspClock, frame.capturedNs);
+
+				bool wasOpen = gate.isOpen();
+				if (gate.update(peakPCM(frame.samples, frameSampleCount), mixIdle.load(std::memory_order_relaxed))) {
+					if (!wasOpen) {
+						// Fresh start after a gap, so don't let the encoder predict from audio the listener never heard the end of
+						opus_encoder_ctl(encoder, OPUS_RESET_STATE);
+						gateOpens.fetch_add(1, std::memory_order_relaxed);
+					}
+					if (!sendCachedPacket(frame, !wasOpen)) { queueForEncode(frame); }
+					enforceQueueLimits();
+					continue;
+				}
+
+				if (wasOpen) {
+					flushPacket();			// Whatever was gathered is the last of the audio
+					sendSilence(silenceTailFrames);
+				}
+				framesGated.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Streams pre-encoded packets instead of encoding the mix, while they line up.
+	void voiceEncoder::setCachedSource(std::shared_ptr<const cachedOpusSound> sound, int64_t originClock) {
+		std::lock_guard<std::mutex> lock(cachedMutex);
+		requestedCached = std::move(sound);
+		requestedCachedOrigin = originClock;
+		cachedGeneration.fetch_add(1, std::memory_order_release);
+	}
+
+	cachedOpusFormat voiceEncoder::cacheFormat() {
+		std::lock_guard<std::mutex> lock(profileMutex);
+		return publishedFormat;
+	}
+
+	// Forgets where the cached packets had got to, so the next frame is live and lines up afresh.
+	void voiceEncoder::resetCachedPosition() {
+		cachedNext = -1;
+		cachedEnd = 0;
+		liveFrom = 0;
+		streamingCached = false;
+	}
+
+	// Sends the cached packets that cover this frame, switching in or out part way through it if that's where a packet
+	// boundary or the end of the last packet falls. Returns false to have the whole frame encoded live instead.
+	bool voiceEncoder::sendCachedPacket(const pcmFrame& pcm, bool restarted) {
+		const int64_t frameStart = (int64_t)pcm.dspClock;
+		const int64_t frameEnd = frameStart + (int64_t)frameSamplesPerChannel;
+		const int64_t step = (int64_t)cachedSwitchStep;
+
+		uint32_t generation = cachedGeneration.load(std::memory_order_acquire);
+		if (generation != cachedSeen) {
+			std::lock_guard<std::mutex> lock(cachedMutex);
+			cached = requestedCached;
+			cachedOrigin = requestedCachedOrigin;
+			cachedSeen = generation;
+			if (streamingCached) {
+				liveFrom = cachedEnd;			// Whatever replaces it picks up where the packets sent so far leave off
+				streamingCached = false;
+				opus_encoder_ctl(encoder, OPUS_RESET_STATE);
+			}
+			cachedNext = -1;
+		}
+		if (restarted) { resetCachedPosition(); }		// Frames were skipped while the gate was shut, so line up again
+		if (packetFrames == 0 && profileChanged.load(std::memory_order_acquire)) { applyProfile(); }		// May stop the packets matching
+
+		// Only stand in for what the encoder would have sent itself
+		bool usable = cached != nullptr && cached->format == activeFormat && !backedOff;
+		if (streamingCached) {
+			while (usable && cachedEnd < frameEnd && cachedNext < (int64_t)cached->packetCount()) {
+				size_t length = 0;
+				const uint8_t* data = cached->packet((size_t)cachedNext++, length);
+				memcpy(packet, data, length);
+				cachedEnd += (int64_t)cached->packetSamples();
+				cachedPacketsSent.fetch_add(1, std::memory_order_relaxed);
+				sendPacket(length, (uint64_t)cached->format.frameMs, pcm.capturedNs, nowNs());
+				usable = !backedOff;
+			}
+			if (cachedEnd >= frameEnd) { return true; }
+
+			// Ran off the end, or stopped lining up. Back to the live mix from a clean encoder state
+			liveFrom = cachedEnd;
+			streamingCached = false;
+			opus_encoder_ctl(encoder, OPUS_RESET_STATE);
+		}
+
+		// Switching back: skip what the packets already covered, to the nearest step, and encode the rest of the frame
+		if (liveFrom > 0) {
+			if (liveFrom >= frameEnd) { return true; }
+			int64_t covered = std::max<int64_t>(liveFrom - frameStart, 0);
+			covered = (covered + step / 2) / step * step;
+			liveFrom = 0;
+			if (covered > 0) {
+				if (covered < frameEnd - frameStart) {
+					encodeSpan(pcm.samples + covered * frameChannels, (size_t)(frameEnd - frameStart - covered), pcm.capturedNs);
+				}
+				return true;
+			}
+		}
+		if (!usable) { return false; }
+
+		// Switching in: find the first packet boundary at or after this frame starts, to within half a step
+		int64_t packetSamples = (int64_t)cached->packetSamples();
+		int64_t soundPosition = frameStart - cachedOrigin;
+		int64_t firstPacket = (soundPosition > step / 2) ? (soundPosition - step / 2 + packetSamples - 1) / packetSamples : 0;
+		if (firstPacket >= (int64_t)cached->packetCount()) { return false; }
+		int64_t head = cachedOrigin + firstPacket * packetSamples - frameStart;
+		int64_t bridge = std::max<int64_t>((head + step / 2) / step * step, 0);
+		if (bridge >= frameEnd - frameStart) { return false; }		// Boundary's in a later frame
+
+		// Live audio gathered before the switch goes out first, then the live mix up to the boundary
+		flushPacket();
+		if (bridge > 0) { encodeSpan(pcm.samples, (size_t)bridge, pcm.capturedNs); }
+		cachedNext = firstPacket;
+		cachedEnd = frameStart + bridge;
+		streamingCached = true;
+		return sendCachedPacket(pcm, false);
+	}
+
+	// Encodes a stretch of live audio shorter than a frame, in whole cachedSwitchSteps, as 10ms packets and then a 5ms one if needed.
+	void voiceEncoder::encodeSpan(const int16_t* pcm, size_t samplesPerChannel, int64_t capturedNs) {
+		for (size_t done = 0; done + cachedSwitchStep <= samplesPerChannel; ) {
+			size_t length = (samplesPerChannel - done >= cachedSwitchStep * 2) ? cachedSwitchStep * 2 : cachedSwitchStep;
+			encodeAndSend(pcm + done * frameChannels, length, length * 1000 / frameSampleRate, capturedNs);
+			done += length;
+		}
+	}
+
+	// Gathers a frame into the next packet, sending it once it's as long as the profile wants.
+	void voiceEncoder::queueForEncode(const pcmFrame& pcm) {
+		// Profiles only change between packets, so a packet is never encoded with two sets of settings
+		if (packetFrames == 0) {
+			if (profileChanged.load(std::memory_order_acquire)) { applyProfile(); }
+			packetCapturedNs = pcm.capturedNs;
+		}
+
+		memcpy(packetPCM + packetFrames * frameSampleCount, pcm.samples, sizeof(pcm.samples));
+		packetFrames++;
+		if (packetFrames * frameLengthMs >= (size_t)profile.frameMs || packetFrames == maxFramesPerPacket) {
+			flushPacket();
+		}
+	}
+
+	// Encodes and sends whatever frames are gathered. Profiles shorter than a frame split it into several packets,
+	// and a partly gathered long packet goes out as 20 or 40ms, both of which Opus allows.
+	void voiceEncoder::flushPacket() {
+		if (packetFrames == 0) { return; }
+
+		size_t totalSamplesPerChannel = packetFrames * frameSamplesPerChannel;
+		size_t packetMs = ((size_t)profile.frameMs < frameLengthMs) ? (size_t)profile.frameMs : packetFrames * frameLengthMs;
+		size_t packetSamplesPerChannel = packetMs * frameSampleRate / 1000;
+
+		if (profile.monoWhenMono) {
+			bool mono = isMonoPCM(packetPCM, totalSamplesPerChannel);
+			if (mono != forcedMono) {
+				opus_encoder_ctl(encoder, OPUS_SET_FORCE_CHANNELS(mono ? 1 : OPUS_AUTO));
+				forcedMono = mono;
+			}
+		}
+
+		for (size_t offset = 0; offset < totalSamplesPerChannel; offset += packetSamplesPerChannel) {
+			encodeAndSend(packetPCM + offset * frameChannels, packetSamplesPerChannel, packetMs, packetCapturedNs);
+		}
+		packetFrames = 0;
+	}
+
+	// Pushes the requested profile's settings into libopus. Encoder thread only, or before it starts.
+	void voiceEncoder::applyProfile() {
+		{
+			std::lock_guard<std::mutex> lock(profileMutex);
+			profile = requestedProfile;
+			profileChanged.store(false, std::memory_order_relaxed);
+		}
+		opus_encoder_ctl(encoder, OPUS_SET_BITRATE(profile.bitrate > 0 ? profile.bitrate : OPUS_AUTO));
+		opus_encoder_ctl(encoder, OPUS_SET_COMPLEXITY(profile.complexity));
+		opus_encoder_ctl(encoder, OPUS_SET_INBAND_FEC(profile.fec ? 1 : 0));
+		opus_encoder_ctl(encoder, OPUS_SET_PACKET_LOSS_PERC(profile.packetLossPercent));
+		opus_encoder_ctl(encoder, OPUS_SET_FORCE_CHANNELS(OPUS_AUTO));
+		forcedMono = false;
+
+		// Adapt from what libopus actually picked, which matters when the profile leaves the bitrate on auto
+		opus_int32 bitrate = 0;
+		opus_encoder_ctl(encoder, OPUS_GET_BITRATE(&bitrate));
+		currentBitrate = (int)bitrate;
+		bitrateControl.reset(currentBitrate, profile.fec, profile.packetLossPercent);
+		backedOff = false;
+		activeFormat = { profile.frameMs, currentBitrate, profile.fec, profile.packetLossPercent };
+		{
+			std::lock_guard<std::mutex> lock(profileMutex);
+			publishedFormat = activeFormat;
+		}
+		std::cout << "Opus profile " << describeOpusProfile(profile) << std::endl;
+	}
+
+	void voiceEncoder::encodeAndSend(const int16_t* pcm, size_t samplesPerChannel, uint64_t durationMs, int64_t capturedNs) {
+		int64_t encodeStartNs = nowNs();
+		opus_int32 length = opus_encode(encoder, pcm, (int)samplesPerChannel, packet, (opus_int32)maxOpusPacketBytes);
+		int64_t encodeEndNs = nowNs();
+		uint64_t encodeUs = elapsedUs(encodeStartNs, encodeEndNs);
+		metrics.record(pipelineStage::encode, encodeUs);
+
+		if (length < 0) {
+			encodeErrors.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		packetsEncoded.fetch_add(1, std::memory_order_relaxed);
+		totalEncodeUs.fetch_add(encodeUs, std::memory_order_relaxed);
+		if (encodeUs > maxEncodeUs.load(std::memory_order_relaxed)) {
+			maxEncodeUs.store(encodeUs, std::memory_order_relaxed);		// Only this thread writes it
+		}
+		{
+			std::lock_guard<std::mutex> lock(profileStatsMutex);
+			profileEncodeStats& ps = profileEncodeTimes[profile.name];
+			ps.name = profile.name;
+			ps.packets++;
+			ps.encodeUs += encodeUs;
+			ps.audioMs += durationMs;
+		}
+
+		sendPacket((size_t)length, durationMs, capturedNs, encodeEndNs);
+	}
+
+	// Hands whatever is in "packet" to every destination, then records how long it all took and lets the bitrate adapter see the queues.
+	// The first destination's timings go in the metrics; the fullest queue drives the bitrate, since they all share one encoder.
+	void voiceEncoder::sendPacket(size_t length, uint64_t durationMs, int64_t capturedNs, int64_t readyNs) {
+		int64_t sentNs = 0;
+		uint64_t worstQueuedUs = 0;
+		{
+			std::lock_guard<std::mutex> lock(clientMutex);
+			if (destinations.empty()) { return; }
+
+			uint32_t limitUs = catchUpUs.load(std::memory_order_relaxed);
+			size_t overLimit = 0;
+			for (size_t i = 0; i < destinations.size(); i++) {
+				destination& target = destinations[i];
+				try {
+					target.client->send_audio_opus(packet, length, durationMs);
+				}
+				catch (const dpp::voice_exception& ex) {
+					std::cout << "Voice Error! Couldn't send Opus packet: " << ex.what() << std::endl;
+					target.stats.sendErrors++;
+					continue;
+				}
+
+				uint64_t dppQueuedUs = (uint64_t)((double)target.client->get_secs_remaining() * 1000000.0);
+				target.stats.packetsSent++;
+				target.stats.queuedMs = dppQueuedUs / 1000.0;
+				target.stats.maxQueuedMs = std::max(target.stats.maxQueuedMs, target.stats.queuedMs);
+				worstQueuedUs = std::max(worstQueuedUs, dppQueuedUs);
+
+				if (i == 0) {
+					sentNs = nowNs();
+					metrics.record(pipelineStage::send, elapsedUs(readyNs, sentNs));
+					metrics.record(pipelineStage::dppQueue, dppQueuedUs);
+					metrics.record(pipelineStage::total, elapsedUs(capturedNs, sentNs) + dppQueuedUs);
+				}
+
+				// D++ has backed up (a stall, or the connection coming back), and everything in it is already late
+				if (limitUs > 0 && dppQueuedUs > limitUs) {
+					target.flushPending = true;
+					overLimit++;
+				}
+			}
+
+			// All of them behind means the whole pipeline is, so catch the lot up from live. One alone just gets its own queue flushed
+			if (overLimit == destinations.size()) {
+				for (destination& target : destinations) { target.flushPending = false; }
+				catchUpPending.store(true, std::memory_order_relaxed);
+			}
+			else if (overLimit > 0) {
+				destinationFlushPending.store(true, std::memory_order_relaxed);
+			}
+		}
+		if (sentNs == 0) { return; }		// First destination's send failed, so there's nothing to measure
+
+		// Outside the client lock, since it may call into libopus
+		uint64_t dppQueuedUs = worstQueuedUs;
+		bitrateDecision decision;
+		if (bitrateControl.update(dppQueuedUs / 1000.0, sentNs, decision)) {
+			opus_encoder_ctl(encoder, OPUS_SET_BITRATE(decision.bitrate));
+			opus_encoder_ctl(encoder, OPUS_SET_INBAND_FEC(decision.fec ? 1 : 0));
+			opus_encoder_ctl(encoder, OPUS_SET_PACKET_LOSS_PERC(decision.packetLossPercent));
+			std::cout << "Opus bitrate " << (decision.bitrate < currentBitrate ? "down" : "up") << " to " << decision.bitrate / 1000
+				<< " kbps, FEC " << (decision.fec ? "on" : "off") << ", with " << dppQueuedUs / 1000 << "ms queued in D++." << std::endl;
+			currentBitrate = decision.bitrate;
+			backedOff = decision.bitrate != activeFormat.bitrate || decision.fec != activeFormat.fec
+				|| decision.packetLossPercent != activeFormat.packetLossPercent;
+		}
+	}
+
+	// Applies the drop policy to whatever has piled up in the capture buffer, and any catch-up that's been asked for.
+	void voiceEncoder::enforceQueueLimits() {
+		if (catchUpPending.exchange(false, std::memory_order_relaxed)) {
+			destinationFlushPending.store(false, std::memory_order_relaxed);
+			catchUp();
+			return;
+		}
+		if (destinationFlushPending.exchange(false, std::memory_order_relaxed)) {
+			std::lock_guard<std::mutex> lock(clientMutex);
+			for (destination& target : destinations) {
+				if (target.flushPending) { flushDestination(target); }
+			}
+		}
+
+		size_t limit = maxQueuedFrames.load(std::memory_order_relaxed);
+		size_t waiting = source.framesAvailable();
+		if (limit == 0 || waiting <= limit) { return; }
+
+		if (policy.load(std::memory_order_relaxed) == dropPolicy::dropOldest) {
+			framesDropped.fetch_add(source.discard(waiting - limit), std::memory_order_relaxed);
+		}
+		else {
+			catchUp();
+		}
+	}
+
+	// Fast-forwards to live: drops all but the newest captured frame and flushes every D++ send queue.
+	void voiceEncoder::catchUp() {
+		framesDropped.fetch_add(packetFrames, std::memory_order_relaxed);		// Half-gathered packet is as stale as the rest
+		packetFrames = 0;
+		resetCachedPosition();
+
+		size_t waiting = source.framesAvailable();
+		if (waiting > 1) {
+			framesDropped.fetch_add(source.discard(waiting - 1), std::memory_order_relaxed);
+		}
+
+		if (gate.isOpen()) {
+			opus_encoder_ctl(encoder, OPUS_RESET_STATE);		// Same as a gate reopening, the listener never hears what came before
+		}
+		{
+			std::lock_guard<std::mutex> lock(clientMutex);
+			for (destination& target : destinations) {
+				target.flushPending = false;
+				flushDestination(target);
+			}
+		}
+		catchUps.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// Empties one destination's D++ send queue. The encoder carries on as it was,
+	// so that listener hears a gap the decoder papers over, and nobody else hears anything. Call with clientMutex held.
+	void voiceEncoder::flushDestination(destination& target) {
+		target.flushPending = false;
+		float queuedSecs = target.client->get_secs_remaining();
+		if (queuedSecs > 0.0f) {
+			uint64_t frames = (uint64_t)(queuedSecs * 1000.0f / frameLengthMs);
+			dppFramesDropped.fetch_add(frames, std::memory_order_relaxed);
+			target.stats.framesFlushed += frames;
+			target.client->stop_audio();
+		}
+		target.stats.flushes++;
+		target.stats.queuedMs = 0.0;
+	}
+
+	// Sends silence frames to every destination, which mark the end of a stretch of audio.
+	void voiceEncoder::sendSilence(int frames) {
+		std::lock_guard<std::mutex> lock(clientMutex);
+		for (destination& target : destinations) {
+			try {
+				for (int i = 0; i < frames; i++) {
+					target.client->send_silence(frameLengthMs);
+				}
+			}
+			catch (const dpp::voice_exception& ex) {
+				std::cout << "Voice Error! Couldn't send silence: " << ex.what() << std::endl;
+			}
+		}
+	}
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include "bitrateAdapter.h"
+#include "frameBuffer.h"
+#include "opusCache.h"
+#include "opusProfile.h"
+#include "pipelineMetrics.h"
+#include "silenceGate.h"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct OpusEncoder;
+namespace dpp { class discord_voice_client; }
+
+//---VOICE ENCODER---//
+
+namespace trbdrAudio {
+	// Largest Opus packet we'll ask libopus for. This is libopus' own recommended maximum.
+	inline constexpr size_t maxOpusPacketBytes = 4000;
+
+	// Silence frames sent when the gate closes, so the listener's decoder fades out instead of
+	// interpolating off the last real packet. Five is what Discord asks for.
+	inline constexpr int silenceTailFrames = 5;
+
+	// Most captured frames one packet can hold: 60ms, the longest Opus frame.
+	inline constexpr size_t maxFramesPerPacket = 3;
+
+	// Finest step the switch between live and cached packets can land on: 5ms, the shortest Opus frame D++ can time,
+	// since it takes durations in whole milliseconds. Live audio either side of a switch goes out in 10 and 5ms packets.
+	inline constexpr size_t cachedSwitchStep = frameSampleRate / 200;
+
+	// What the encoder does when more audio is waiting than it's allowed to hold.
+	enum class dropPolicy {
+		dropOldest,			// Trim the capture buffer back to the limit, oldest frames first, and carry on
+		dropToLatest		// Throw away everything but the newest frame and restart the queue from there. Also done on reconnect
+	};
+
+	// Snapshot of how the encoder thread is doing, in microseconds where it's a time.
+	struct encoderStats {
+		uint64_t packetsEncoded = 0;
+		uint64_t encodeErrors = 0;
+		uint64_t framesGated = 0;								// Silent frames never encoded or sent
+		uint64_t gateOpens = 0;
+		uint64_t averageEncodeUs = 0;							// Per packet, so compare like with like across profiles
+		uint64_t maxEncodeUs = 0;
+		uint64_t framesDropped = 0;								// Captured frames thrown away by the drop policy
+		uint64_t dppFramesDropped = 0;							// Frames' worth of queued packets flushed out of D++
+		uint64_t catchUps = 0;									// Times the stream jumped forward to live
+		uint64_t cachedPacketsSent = 0;							// Sent straight from the Opus cache, with no encoding
+	};
+
+	// How one voice connection is keeping up with the packets it's given.
+	struct voiceDestinationStats {
+		uint64_t serverId = 0;									// Guild the connection is in
+		uint64_t packetsSent = 0;
+		uint64_t sendErrors = 0;
+		double queuedMs = 0.0;									// In its D++ send queue, as of the last packet
+		double maxQueuedMs = 0.0;
+		uint64_t framesFlushed = 0;								// Frames' worth of queued packets flushed out of its D++ queue
+		uint64_t flushes = 0;
+	};
+
+	// Encode time spent under one profile, against the audio it encoded.
+	struct profileEncodeStats {
+		std::string name;
+		uint64_t packets = 0;
+		uint64_t encodeUs = 0;
+		uint64_t audioMs = 0;
+		double cpuPercent = 0.0;								// Of one core, while streaming
+	};
+
+	// Owns a libopus encoder and a thread that pulls whole frames from the capture buffer,
+	// encodes them in packets as long as the current profile asks for, and hands the packets to D++ with send_audio_opus. The thread sleeps until
+	// the capture side publishes a frame, so nothing waits on a polling interval.
+	// Keeps Opus encoding off the thread that updates FMOD, and off D++'s own threads.
+	// Any number of voice connections can listen: each packet is encoded once and handed to all of them, so adding one costs a send, not an encode.
+	// The first destination is the one latency is measured by.
+	class voiceEncoder {
+	public:
+		// Bitrate steps down while D++ has more than "bitrateBackoffMs" queued, and back up under "bitrateRecoverMs".
+		// A backoff of 0 keeps the profile's bitrate no matter what.
+		voiceEncoder(pcmFrameBuffer& source, pipelineMetrics& metrics, double bitrateBackoffMs, double bitrateRecoverMs);
+		~voiceEncoder();
+
+		voiceEncoder(const voiceEncoder&) = delete;
+		voiceEncoder& operator=(const voiceEncoder&) = delete;
+
+		// Creates the libopus encoder and starts the encoder thread. Returns false if libopus refuses.
+		bool start();
+
+		// Stops and joins the encoder thread, then releases the libopus encoder.
+		void stop();
+
+		// Adds a voice connection for packets to go to, joining mid-stream if there's audio already flowing.
+		// A guild only has one connection, so a new client for a guild already in the list replaces its old one.
+		void addDestination(dpp::discord_voice_client* client);
+
+		// Stops sending to a voice connection. Waits for any send in progress, so it's safe to disconnect as soon as this returns.
+		void removeDestination(dpp::discord_voice_client* client);
+
+		size_t destinationCount();
+
+		// Tells the gate whether anything is playing in FMOD. Called from the session's tick.
+		void setMixIdle(bool idle);
+
+		// Bounds the audio allowed to wait ahead of Discord. Past "maxQueuedFrames" in the capture buffer the policy
+		// decides what's dropped. Past "catchUpMs" in a destination's D++ send queue, that queue is flushed and refilled from the
+		// newest audio whatever the policy, since D++ can only drop all of it. Only the destinations that ran over are flushed,
+		// unless they all did. Keep maxQueuedFrames under the buffer's capacity.
+		void setQueueLimits(dropPolicy policy, size_t maxQueuedFrames, uint32_t catchUpMs);
+
+		// Switches encoder settings. Takes effect at the next packet boundary, without touching the connection.
+		void setProfile(const opusProfile& profile);
+
+		// Sends "sound"'s pre-encoded packets in place of encoding the mix, until it runs out or this is called with nullptr.
+		// "originClock" is the DSP clock, in 48 kHz samples like the captured frames', that the sound's first sample played at.
+		// The switch in waits for a packet boundary and the switch out picks up where the packets left off, both to within
+		// half a cachedSwitchStep. Packets only stand in while they're in cacheFormat() and the bitrate isn't backed off.
+		void setCachedSource(std::shared_ptr<const cachedOpusSound> sound, int64_t originClock);
+
+		// The format the current profile encodes in at full rate, for the cache to build in.
+		cachedOpusFormat cacheFormat();
+
+		// True while packets are coming from the cache rather than the encoder.
+		bool isStreamingCached() const { return streamingCached.load(std::memory_order_relaxed); }
+
+		// Name of the profile last asked for.
+		std::string profileName();
+
+		// Encode CPU measured for every profile used so far.
+		std::vector<profileEncodeStats> profileStats();
+
+		encoderStats stats() const;
+
+		bitrateAdapterStats bitrateStats() const { return bitrateControl.stats(); }
+
+		// Queue depth and drops for each destination, in the order they were added.
+		std::vector<voiceDestinationStats> destinationStats();
+
+	private:
+		void run();
+		void queueForEncode(const pcmFrame& frame);
+		void flushPacket();
+		void encodeAndSend(const int16_t* pcm, size_t samplesPerChannel, uint64_t durationMs, int64_t capturedNs);
+		void sendPacket(size_t length, uint64_t durationMs, int64_t capturedNs, int64_t readyNs);
+		bool sendCachedPacket(const pcmFrame& frame, bool restarted);
+		void encodeSpan(const int16_t* pcm, size_t samplesPerChannel, int64_t capturedNs);
+		void resetCachedPosition();
+		void applyProfile();
+		void sendSilence(int frames);
+		void enforceQueueLimits();
+		void catchUp();
+
+		struct destination {
+			dpp::discord_voice_client* client = nullptr;
+			voiceDestinationStats stats;
+			bool flushPending = false;						// Its D++ queue ran over on its own
+		};
+		void flushDestination(destination& target);
+
+		pcmFrameBuffer& source;
+		pipelineMetrics& metrics;
+		OpusEncoder* encoder = nullptr;
+		std::thread thread;
+		std::atomic<bool> running = false;
+
+		std::mutex clientMutex;								// Held by the encoder thread only while it's sending. Guards destinations
+		std::vector<destination> destinations;
+		std::atomic<bool> hasDestinations = false;
+
+		std::atomic<bool> mixIdle = true;
+		silenceGate gate;
+
+		std::atomic<dropPolicy> policy = dropPolicy::dropOldest;
+		std::atomic<size_t> maxQueuedFrames = 0;				// 0 means unbounded, short of the buffer's own capacity
+		std::atomic<uint32_t> catchUpUs = 0;					// 0 means never flush D++
+		std::atomic<bool> catchUpPending = false;				// Set on reconnect, or when every D++ queue ran over
+		std::atomic<bool> destinationFlushPending = false;		// Some destination's D++ queue ran over on its own
+
+		std::mutex profileMutex;
+		opusProfile requestedProfile;
+		std::atomic<bool> profileChanged = false;
+		opusProfile profile;								// Encoder thread's copy of the profile in use
+		bool forcedMono = false;
+		bitrateAdapter bitrateControl;						// Encoder thread only, bar stats
+		int currentBitrate = 0;
+		bool backedOff = false;								// Bitrate adapter has moved off the profile's settings
+		cachedOpusFormat activeFormat;						// Encoder thread's format at full rate, for matching cached packets against
+		cachedOpusFormat publishedFormat;					// ...and a copy for cacheFormat(), guarded by profileMutex
+		std::mutex profileStatsMutex;
+		std::map<std::string, profileEncodeStats> profileEncodeTimes;
+
+		std::mutex cachedMutex;
+		std::shared_ptr<const cachedOpusSound> requestedCached;
+		int64_t requestedCachedOrigin = 0;
+		std::atomic<uint32_t> cachedGeneration = 0;			// Bumped by setCachedSource(), so the encoder thread only locks on a change
+		uint32_t cachedSeen = 0;
+		std::shared_ptr<const cachedOpusSound> cached;		// Encoder thread's copy of the source in use
+		int64_t cachedOrigin = 0;
+		int64_t cachedNext = -1;							// Next packet to send, or -1 to line up from the origin
+		int64_t cachedEnd = 0;								// DSP clock the packets sent so far reach up to
+		int64_t liveFrom = 0;								// After switching back, the DSP clock live audio picks up from
+		std::atomic<bool> streamingCached = false;
+
+		pcmFrame frame;										// Encoder thread's working copy of the frame
+		int16_t packetPCM[maxFramesPerPacket * frameSampleCount];	// Frames gathered for the next packet
+		size_t packetFrames = 0;
+		int64_t packetCapturedNs = 0;
+		uint8_t packet[maxOpusPacketBytes];
+
+		std::atomic<uint64_t> packetsEncoded = 0;
+		std::atomic<uint64_t> encodeErrors = 0;
+		std::atomic<uint64_t> framesGated = 0;
+		std::atomic<uint64_t> gateOpens = 0;
+		std::atomic<uint64_t> totalEncodeUs = 0;
+		std::atomic<uint64_t> maxEncodeUs = 0;
+		std::atomic<uint64_t> framesDropped = 0;
+		std::atomic<uint64_t> dppFramesDropped = 0;
+		std::atomic<uint64_t> catchUps = 0;
+		std::atomic<uint64_t> cachedPacketsSent = 0;
+	};
+}
@@ -0,0 +1,98 @@
+#include "workerPool.h"
+
+#include <algorithm>
+
+//---WORKER POOL---//
+
+namespace trbdrUtils {
+	workerPool::~workerPool() { stop(); }
+
+	void workerPool::start(unsigned int count) {
+		if (count == 0) { count = std::max(1u, std::thread::hardware_concurrency()); }
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (running) { return; }
+			running = true;
+		}
+		for (unsigned int i = 0; i < count; i++) {
+			threads.emplace_back(&workerPool::run, this);
+		}
+	}
+
+	void workerPool::stop() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!running) { return; }
+			running = false;
+		}
+		wakeWorker.notify_all();
+		for (std::thread& thread : threads) { thread.join(); }
+		threads.clear();
+
+		// Every strand still marked scheduled is in the ready queue now. Drop its jobs and unmark it, so nothing's left
+		// holding captures forever and a later post() schedules it again from scratch.
+		std::deque<strand*> dropped;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			dropped.swap(ready);
+		}
+		for (strand* target : dropped) {
+			std::deque<std::function<void()>> jobs;			// Destroyed once the strand lock is released
+			{
+				std::lock_guard<std::mutex> strandLock(target->mutex);
+				jobs.swap(target->jobs);
+				target->scheduled = false;
+			}
+		}
+	}
+
+	void workerPool::post(strand& target, std::function<void()> job) {
+		{
+			std::lock_guard<std::mutex> strandLock(target.mutex);
+			target.jobs.push_back(std::move(job));
+			if (target.scheduled) { return; }		// Whoever has it will get to this job
+			target.scheduled = true;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			ready.push_back(&target);
+		}
+		wakeWorker.notify_one();
+	}
+
+	void workerPool::run() {
+		while (true) {
+			strand* next = nullptr;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wakeWorker.wait(lock, [this] { return !running || !ready.empty(); });
+				if (!running) { return; }
+				next = ready.front();
+				ready.pop_front();
+			}
+
+			// Only this thread owns the strand until it's rescheduled, so the job runs without any lock held
+			std::function<void()> job;
+			{
+				std::lock_guard<std::mutex> strandLock(next->mutex);
+				job = std::move(next->jobs.front());
+				next->jobs.pop_front();
+			}
+			job();
+
+			bool more = false;
+			{
+				std::lock_guard<std::mutex> strandLock(next->mutex);
+				more = !next->jobs.empty();
+				next->scheduled = more;
+			}
+			if (more) {
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					ready.push_back(next);
+				}
+				wakeWorker.notify_one();
+			}
+		}
+	}
+}
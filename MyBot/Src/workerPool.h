@@ -0,0 +1,60 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//---WORKER POOL---//
+
+namespace trbdrUtils {
+	// A queue of jobs that run one at a time, in order, on whichever pool thread is free.
+	// Everything posted to the same strand is serialised, so state only its jobs touch needs no locking.
+	class strand {
+	public:
+		strand() = default;
+		strand(const strand&) = delete;
+		strand& operator=(const strand&) = delete;
+
+	private:
+		friend class workerPool;
+
+		std::mutex mutex;										// Guards everything below
+		std::deque<std::function<void()>> jobs;
+		bool scheduled = false;									// Waiting in the pool's ready queue, or running
+	};
+
+	// Fixed set of threads shared by many strands. A strand with work sits in the ready queue; a thread takes it,
+	// runs one job, and puts it back on the end if there's more, so one busy strand can't starve the others.
+	class workerPool {
+	public:
+		workerPool() = default;
+		~workerPool();
+
+		workerPool(const workerPool&) = delete;
+		workerPool& operator=(const workerPool&) = delete;
+
+		// Starts "threads" workers, or one per core if 0.
+		void start(unsigned int threads = 0);
+
+		// Lets running jobs finish, then joins every worker. Jobs still queued are dropped, and their strands can be posted to again.
+		void stop();
+
+		// Queues a job on a strand. Safe from any thread, including from inside a job.
+		void post(strand& target, std::function<void()> job);
+
+		unsigned int threadCount() const { return (unsigned int)threads.size(); }
+
+	private:
+		void run();
+
+		std::vector<std::thread> threads;
+
+		std::mutex mutex;										// Guards everything below
+		std::condition_variable wakeWorker;
+		std::deque<strand*> ready;
+		bool running = false;
+	};
+}